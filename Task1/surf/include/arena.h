@@ -0,0 +1,112 @@
+/******************************************************************
+ * Module:	arena.h
+ *
+ * Purpose:	One aligned block of memory carved into the arrays of
+ *		a profile, grown as longer profiles arrive.
+ *
+ * Contents:	Definitions
+ *			alignment
+ *			surf_arena structure
+ *
+ *		Declarations
+ *			arena_reserve()	- make room, discarding the arrays
+ *			arena_take()	- an aligned piece of the block
+ *			arena_free()	- release the block
+ *			arena_size()	- room taken by a piece
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+/*
+ * make sure of only one inclusion
+ */
+#ifndef ArenaDummy
+#define ArenaDummy
+
+#include <stddef.h>
+
+/*
+ * every piece starts on a cache line, which is also the widest
+ * vector register
+ */
+#define ARENA_ALIGN 64
+
+
+/*
+ * Structure:	surf_arena
+ *
+ * Description:	A block of "size" bytes, of which the first "used"
+ *		have been handed out since it was last reserved.
+ */
+struct surf_arena {
+   char *base;
+   size_t size;
+   size_t used;
+};
+
+
+/*
+ * Routine:	arena_reserve
+ *
+ * Description:	Make sure that the block holds at least "size" bytes
+ *		and hand all of it out again from the start. A block
+ *		that is too small is replaced by one at least twice as
+ *		big, so that a run of growing profiles needs few
+ *		allocations. Anything taken before is lost.
+ *
+ * Parameters:	arena	<> the arena
+ *		size	< bytes needed, each piece rounded up to
+ *			  ARENA_ALIGN (see arena_size())
+ *
+ * Returns:	TRUE	- the block is ready
+ *		ER_MEM	- no memory; the arena is empty
+ *
+ * Date:	17/10/26
+ */
+int arena_reserve(struct surf_arena *arena, size_t size);
+
+
+/*
+ * Routine:	arena_take
+ *
+ * Description:	The next "size" bytes of the block, starting on an
+ *		ARENA_ALIGN boundary.
+ *
+ * Parameters:	arena	<> the arena
+ *		size	< bytes wanted
+ *
+ * Returns:	the piece, or NULL if the block is used up
+ *
+ * Example:	data = (double *) arena_take(&arena,n*sizeof(double));
+ *
+ * Date:	17/10/26
+ */
+void *arena_take(struct surf_arena *arena, size_t size);
+
+
+/*
+ * Routine:	arena_free
+ *
+ * Description:	Release the block.
+ *
+ * Parameters:	arena	<> the arena
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void arena_free(struct surf_arena *arena);
+
+
+/*
+ * Routine:	arena_size
+ *
+ * Description:	Room taken in a block by a piece of "size" bytes.
+ *
+ * Example:	arena_size(8);
+ *		return(64);
+ */
+#define arena_size(size) \
+   (((size) + ARENA_ALIGN - 1)/ARENA_ALIGN*ARENA_ALIGN)
+
+#endif
@@ -0,0 +1,77 @@
+/******************************************************************
+ * Module:	batch.h
+ *
+ * Purpose:	Non-interactive analysis of many Talysurf files.
+ *
+ * Contents:	batch_run()	- analyse the files named on the command line
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+/*
+ * make sure of only one inclusion
+ */
+#ifndef BatchDummy
+#define BatchDummy
+
+/*
+ * file name extension of Talysurf text data files searched for in
+ * directories (binary files, SURFB_EXTENSION, are searched for too)
+ */
+#define BATCH_EXTENSION ".txt"
+
+
+/*
+ * Routine:	batch_run
+ *
+ * Description:	Load, transform and calculate the parameters of every
+ *		file named on the command line, and of every
+ *		text or binary data file in any directory named, writing one
+ *		comma-separated row per profile. The files are shared
+ *		out among "--threads" workers (default one per
+ *		processor), and the rows are written as each window of
+ *		files is finished. "--cutoff" analyses the roughness left by
+ *		the Gaussian filter of that cutoff (see
+ *		gauss_filter()). "--welch" averages the spectrum over
+ *		segments of that length (see welch_spectrum()).
+ *		"--bands" or "--log-bands" adds the SMOOTH_MAX_DATA
+ *		smoothed bands of each spectrum (see smooth_spectrum()).
+ *		"--form" takes an arc or a polynomial off each profile
+ *		instead of its line (see form_remove()).
+ *		"--precision float" finds the transform, spectrum and
+ *		parameters in float, for quick screening. "--cache"
+ *		keeps the results in a directory, within
+ *		"--cache-size" megabytes (see rcache.h).
+ *		"--format jsonl" writes a JSON object per profile
+ *		instead, and "--format binary" the parameters and whole
+ *		spectrum of each in the binary format of writer.h.
+ *		"--stats" (see main()) reports on stderr the time each
+ *		stage took.
+ *
+ *		surf --batch [--exact] [--threads n] [--out results.csv]
+ *			[--format csv|jsonl|binary]
+ *			[--cache dir [--cache-size mb]]
+ *			[--form line|arc|2|3|4|5]
+ *			[--precision float|double] [--cutoff wavelength]
+ *			[--welch length [--overlap n]
+ *			 [--window hann|hamming|blackman]]
+ *			[--bands | --log-bands] [--stats[=text|json]]
+ *			path ...
+ *
+ * Parameters:	argc	< number of command line arguments
+ *		argv	< the command line arguments
+ *
+ * Returns:	TRUE	- every file analysed
+ *		ER_FIL	- a file, the output or the cache could not be
+ *			  opened, or a file could not be analysed, or
+ *			  the window, form, format or precision is not
+ *			  known, or the results could not be written
+ *		ER_MEM	- no memory for the workers
+ *
+ * Example:	surf --batch data --threads 8 --out results.csv
+ *
+ * Date:	17/10/26
+ */
+int batch_run(int argc, char *argv[]);
+
+#endif
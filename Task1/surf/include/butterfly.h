@@ -0,0 +1,69 @@
+/******************************************************************
+ * Module:	butterfly.h
+ *
+ * Purpose:	Radix-2 butterfly stages on split real/imaginary
+ *		arrays, with SIMD versions where the processor has them.
+ *
+ * Contents:	butterfly_stage_fn	- type of a stage routine
+ *		butterfly_stage_fn_float	- the same for floats
+ *		butterfly_stage_select()	- choose the fastest stage
+ *		butterfly_stage_select_float()	- the same for floats
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+/*
+ * make sure of only one inclusion
+ */
+#ifndef ButterflyDummy
+#define ButterflyDummy
+
+
+/*
+ * Routine type:	butterfly_stage_fn
+ *
+ * Description:	Combine the pairs of transforms of "half" points in
+ *		re[0..n-1], im[0..n-1] into transforms of 2*half points.
+ *		The twiddle factors exp(-pi*j*k/half), k < half, are
+ *		w_re[0..half-1], w_im[0..half-1]. A stage on floats
+ *		(butterfly_stage_fn_float) is the same with floats.
+ *
+ * Parameters:	re, im	<> real and imaginary parts of the values
+ *		n	< number of values
+ *		half	< number of points in the transforms combined
+ *		w_re, w_im	< twiddle factors for this stage
+ */
+typedef void (*butterfly_stage_fn)(double *re, double *im, int n, int half,
+   const double *w_re, const double *w_im);
+typedef void (*butterfly_stage_fn_float)(float *re, float *im, int n,
+   int half, const float *w_re, const float *w_im);
+
+
+/*
+ * Routine:	butterfly_stage_select
+ *
+ * Description:	Return the widest stage routine the processor can
+ *		run: AVX-512 (8 butterflies per instruction), AVX2 with
+ *		FMA (4 butterflies) or plain C. Stages of fewer points
+ *		than the vector width fall back to the plain C loop.
+ *
+ * Parameters:	none
+ *
+ * Returns:	the stage routine
+ *
+ * Date:	17/10/26
+ */
+butterfly_stage_fn butterfly_stage_select();
+
+
+/*
+ * Routine:	butterfly_stage_select_float
+ *
+ * Description:	As butterfly_stage_select(), for stages on floats,
+ *		which fit twice as many butterflies in a vector.
+ *
+ * Date:	17/10/26
+ */
+butterfly_stage_fn_float butterfly_stage_select_float();
+
+#endif
@@ -0,0 +1,214 @@
+/******************************************************************
+ * Module:	butterflyt.h
+ *
+ * Purpose:	Template of the radix-2 butterfly stages, included by
+ *		butterfly.c once for each precision (see scalar.h).
+ *
+ * Contents:	stage_scalar()	- plain C stage
+ *		stage_avx2()	- a 256 bit vector of butterflies
+ *		stage_avx512()	- a 512 bit vector of butterflies
+ *		butterfly_stage_select()	- choose the fastest stage
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+/*
+ * the vector types and instructions of this precision; a vector
+ * holds twice as many floats as doubles
+ */
+#undef V256
+#undef V256_WIDTH
+#undef v256_load
+#undef v256_store
+#undef v256_add
+#undef v256_sub
+#undef v256_mul
+#undef v256_fmadd
+#undef v256_fmsub
+#undef V512
+#undef V512_WIDTH
+#undef v512_load
+#undef v512_store
+#undef v512_add
+#undef v512_sub
+#undef v512_mul
+#undef v512_fmadd
+#undef v512_fmsub
+
+#ifdef SCALAR_FLOAT
+#define V256 __m256
+#define V256_WIDTH 8
+#define v256_load _mm256_loadu_ps
+#define v256_store _mm256_storeu_ps
+#define v256_add _mm256_add_ps
+#define v256_sub _mm256_sub_ps
+#define v256_mul _mm256_mul_ps
+#define v256_fmadd _mm256_fmadd_ps
+#define v256_fmsub _mm256_fmsub_ps
+#define V512 __m512
+#define V512_WIDTH 16
+#define v512_load _mm512_loadu_ps
+#define v512_store _mm512_storeu_ps
+#define v512_add _mm512_add_ps
+#define v512_sub _mm512_sub_ps
+#define v512_mul _mm512_mul_ps
+#define v512_fmadd _mm512_fmadd_ps
+#define v512_fmsub _mm512_fmsub_ps
+#else
+#define V256 __m256d
+#define V256_WIDTH 4
+#define v256_load _mm256_loadu_pd
+#define v256_store _mm256_storeu_pd
+#define v256_add _mm256_add_pd
+#define v256_sub _mm256_sub_pd
+#define v256_mul _mm256_mul_pd
+#define v256_fmadd _mm256_fmadd_pd
+#define v256_fmsub _mm256_fmsub_pd
+#define V512 __m512d
+#define V512_WIDTH 8
+#define v512_load _mm512_loadu_pd
+#define v512_store _mm512_storeu_pd
+#define v512_add _mm512_add_pd
+#define v512_sub _mm512_sub_pd
+#define v512_mul _mm512_mul_pd
+#define v512_fmadd _mm512_fmadd_pd
+#define v512_fmsub _mm512_fmsub_pd
+#endif
+
+
+/*
+ * Routine:	stage_scalar
+ *
+ * Description:	Plain C butterfly stage, used when no SIMD stage is
+ *		available and for stages narrower than a vector.
+ *
+ * Date:	17/10/26
+ */
+static void SCALAR_NAME(stage_scalar)(scalar *re, scalar *im, int n,
+   int half, const scalar *w_re, const scalar *w_im)
+{
+   scalar t_re,t_im;
+   int i,j;
+
+   for(i=0;i<n;i+=2*half) {
+      for(j=i;j<i+half;j++) {
+         t_re = re[j+half]*w_re[j-i] - im[j+half]*w_im[j-i];
+         t_im = re[j+half]*w_im[j-i] + im[j+half]*w_re[j-i];
+         re[j+half] = re[j] - t_re;
+         im[j+half] = im[j] - t_im;
+         re[j] = re[j] + t_re;
+         im[j] = im[j] + t_im;
+      }
+   }
+}
+
+
+#ifdef BUTTERFLY_X86
+
+/*
+ * Routine:	stage_avx2
+ *
+ * Description:	Butterfly stage on V256_WIDTH pairs at a time.
+ *
+ * Date:	17/10/26
+ */
+__attribute__((target("avx2,fma")))
+static void SCALAR_NAME(stage_avx2)(scalar *re, scalar *im, int n,
+   int half, const scalar *w_re, const scalar *w_im)
+{
+   V256 a_re,a_im,b_re,b_im,wr,wi,t_re,t_im;
+   int i,j;
+
+   if (half < V256_WIDTH) {
+      SCALAR_NAME(stage_scalar)(re,im,n,half,w_re,w_im);
+      return;
+   }
+
+   for(i=0;i<n;i+=2*half) {
+      for(j=0;j<half;j+=V256_WIDTH) {
+         a_re = v256_load(re+i+j);
+         a_im = v256_load(im+i+j);
+         b_re = v256_load(re+i+j+half);
+         b_im = v256_load(im+i+j+half);
+         wr = v256_load(w_re+j);
+         wi = v256_load(w_im+j);
+
+         t_re = v256_fmsub(b_re,wr,v256_mul(b_im,wi));
+         t_im = v256_fmadd(b_re,wi,v256_mul(b_im,wr));
+
+         v256_store(re+i+j+half,v256_sub(a_re,t_re));
+         v256_store(im+i+j+half,v256_sub(a_im,t_im));
+         v256_store(re+i+j,v256_add(a_re,t_re));
+         v256_store(im+i+j,v256_add(a_im,t_im));
+      }
+   }
+}
+
+
+/*
+ * Routine:	stage_avx512
+ *
+ * Description:	Butterfly stage on V512_WIDTH pairs at a time.
+ *
+ * Date:	17/10/26
+ */
+__attribute__((target("avx512f")))
+static void SCALAR_NAME(stage_avx512)(scalar *re, scalar *im, int n,
+   int half, const scalar *w_re, const scalar *w_im)
+{
+   V512 a_re,a_im,b_re,b_im,wr,wi,t_re,t_im;
+   int i,j;
+
+   if (half < V512_WIDTH) {
+      SCALAR_NAME(stage_scalar)(re,im,n,half,w_re,w_im);
+      return;
+   }
+
+   for(i=0;i<n;i+=2*half) {
+      for(j=0;j<half;j+=V512_WIDTH) {
+         a_re = v512_load(re+i+j);
+         a_im = v512_load(im+i+j);
+         b_re = v512_load(re+i+j+half);
+         b_im = v512_load(im+i+j+half);
+         wr = v512_load(w_re+j);
+         wi = v512_load(w_im+j);
+
+         t_re = v512_fmsub(b_re,wr,v512_mul(b_im,wi));
+         t_im = v512_fmadd(b_re,wi,v512_mul(b_im,wr));
+
+         v512_store(re+i+j+half,v512_sub(a_re,t_re));
+         v512_store(im+i+j+half,v512_sub(a_im,t_im));
+         v512_store(re+i+j,v512_add(a_re,t_re));
+         v512_store(im+i+j,v512_add(a_im,t_im));
+      }
+   }
+}
+
+#endif
+
+
+/*
+ * Routine:	butterfly_stage_select
+ *
+ * Description:	Return the widest stage routine the processor can
+ *		run: AVX-512, AVX2 with FMA or plain C. Stages of
+ *		fewer points than the vector width fall back to the
+ *		plain C loop.
+ *
+ * Parameters:	none
+ *
+ * Returns:	the stage routine
+ *
+ * Date:	17/10/26
+ */
+SCALAR_NAME(butterfly_stage_fn) SCALAR_NAME(butterfly_stage_select)()
+{
+#ifdef BUTTERFLY_X86
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("avx512f"))
+      return(SCALAR_NAME(stage_avx512));
+   if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+      return(SCALAR_NAME(stage_avx2));
+#endif
+   return(SCALAR_NAME(stage_scalar));
+}
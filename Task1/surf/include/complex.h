@@ -13,6 +13,12 @@
  *
  *****************************************************************/
 
+/*
+ * make sure of only one inclusion
+ */
+#ifndef ComplexDummy
+#define ComplexDummy
+
 /*
  * complex structure
  */
@@ -110,3 +116,5 @@ struct complex com_div(struct complex com1, struct complex com2);
  * Date:	23/4/91
  */
 struct complex com_pow(struct complex com, double expon);
+
+#endif
@@ -0,0 +1,219 @@
+/******************************************************************
+ * Module:	context.h
+ *
+ * Purpose:	The state of one profile analysis, so that several
+ *		profiles can be analysed at once.
+ *
+ * Contents:	surf_params	- the calculated parameters
+ *		surf_context	- data, transform and spectral arrays
+ *		context_create()	- allocate an analysis context
+ *		context_reserve()	- arrays for a number of data
+ *		context_destroy()	- release an analysis context
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+/*
+ * make sure of only one inclusion
+ */
+#ifndef ContextDummy
+#define ContextDummy
+
+#include <stdint.h>
+#include "global.h"
+#include "fft.h"
+#include "online.h"
+#include "welch.h"
+#include "arena.h"
+
+struct surf_pool;
+struct rcache;
+
+
+/*
+ * Structure:	surf_params
+ *
+ * Description:	Parameters calculated from the data by calc_params().
+ */
+struct surf_params {
+   double mean;  /* mean of the data, microns */
+   double var;  /* variance of the data, square microns */
+   double ra;  /* Ra value, mean absolute height, microns */
+   double rq;  /* Rq value, root mean square height, microns */
+   double rsk;  /* Rsk value, skewness */
+   double rku;  /* Rku value, kurtosis */
+   double rp;  /* maximum peak, microns */
+   double rv;  /* maximum valley, microns */
+   double rt;  /* maximum peak to valley, microns */
+   double rz;  /* Rz value, mean peak to valley of the sampling
+                  lengths, microns */
+   double rsm;  /* RSm value, mean spacing of profile elements,
+                   microns */
+   double rdq;  /* Rdq value, root mean square slope, no units */
+   double gamma0;  /* first autocorrelation value, square microns */
+   double gamma1;  /* second autocorrelation value, square microns */
+   double c_lambda;  /* correlation length, microns */
+};
+
+
+/*
+ * Structure:	surf_context
+ *
+ * Description:	Everything belonging to the analysis of one profile:
+ *		the data read from the Talysurf file, the transform and
+ *		spectral arrays, the parameters and the transform plans.
+ *		A context is used by one thread at a time, which may
+ *		share out the parts of an analysis among the workers of
+ *		"pool"; its arrays and plans are reused from one
+ *		profile to the next.
+ */
+struct surf_context {
+   /* Talysurf settings and scaling factors per unit */
+   int mag_set;  /* magnification setting of Talysurf */
+   int filter_set;  /* filter setting of Talysurf */
+   double x_division;  /* x scaling factor */
+   double y_division;  /* y scaling factor */
+
+   /* Talysurf data; this and the transform, spectral and
+      autocorrelation arrays are pieces of "arena", sized for
+      "num_data" by context_reserve() */
+   int num_data;
+   double *data;
+   int data_valid;
+
+   /* Gaussian profile filter (see gauss.h): cutoff wavelength in
+      the units of "x_division", 0 for none; once filtered "data"
+      holds the roughness and "smooth_data" the waviness */
+   double cutoff;
+   double *smooth_data;
+
+   /* statistics gathered as the data are read */
+   struct surf_online online;
+
+   /* form taken off the data as they are levelled (see form.h) */
+   int form;
+
+   /* arithmetic of the kernels, PRECISION_DOUBLE or PRECISION_FLOAT;
+      in float the transform and autocorrelation work arrays hold
+      floats, packed into the first half of each (the Welch spectrum
+      and the Gaussian filter are always found in double) */
+   int precision;
+
+   /* transform data, real and imaginary parts */
+   int trans_mode;  /* TRANS_PADDED or TRANS_EXACT */
+   int trans_num_data;
+   double *trans_re;
+   double *trans_im;
+   int tfm_valid;
+
+   /* spectral data */
+   int spec_num_data;
+   double *spec_data;
+
+   /* Welch spectrum: segment length (0 for a single periodogram of
+      the whole trace), overlap in samples (half a segment if
+      negative) and window (see welch.h), the window table and the
+      periodograms of the segments */
+   int welch_length;
+   int welch_overlap;
+   int welch_window;
+   struct welch_table window;
+   int welch_max_size;
+   double *welch_work;
+
+   /* smoothed spectral data: bands spaced as "smooth_mode" (see
+      smooth.h) over the values below "cut_num_data" (0 for all) */
+   int smooth_num_data;
+   int cut_num_data;
+   int smooth_mode;
+   struct smoothed *smooth;
+
+   /* saved smoothed spectral data, the average of "num_combinations"
+      profiles */
+   int num_combinations;
+   int saved_num_data;
+   struct smoothed *saved_smooth;
+
+   /* autocorrelation function, lags 0..acf_num_data-1, and the
+      padded transform it is found from */
+   int acf_num_data;
+   double *acf;
+   double *acf_re;
+   double *acf_im;
+
+   /* parameters */
+   struct surf_params params;
+
+   /* memory of the arrays that depend on the number of data */
+   struct surf_arena arena;
+
+   /* transform plans used by this context */
+   struct fft_cache plans;
+
+   /* workers for the parts of one analysis, or NULL */
+   struct surf_pool *pool;
+
+   /* results kept on disk (see rcache.h), or NULL; "cached" is TRUE
+      once the results of the data are in the cache or came from it,
+      and "cache_key" is their key; the cache is not the context's
+      and is not closed with it */
+   struct rcache *cache;
+   int cached;
+   uint64_t cache_key[2];
+
+   /* number of the last error, see error.h */
+   int error_number;
+};
+
+
+/*
+ * Routine:	context_create
+ *
+ * Description:	Allocate a context. The arrays of a profile are found
+ *		when its number of data is known (see
+ *		context_reserve()).
+ *
+ * Parameters:	none
+ *
+ * Returns:	the context, or NULL if memory is not available
+ *
+ * Date:	17/10/26
+ */
+struct surf_context *context_create();
+
+
+/*
+ * Routine:	context_reserve
+ *
+ * Description:	Find memory space for the arrays of a profile of
+ *		"num_data" samples, all in the context's arena and each
+ *		starting on an ARENA_ALIGN boundary. The arena is only
+ *		reallocated when the profile is longer than any before.
+ *
+ * Parameters:	ctx		<> the analysis context
+ *		num_data	< number of samples
+ *
+ * Returns:	TRUE	- the arrays are ready, their contents undefined
+ *		ER_MEM	- memory is not available
+ *
+ * Example:	context_reserve(ctx,7500);
+ *
+ * Date:	17/10/26
+ */
+int context_reserve(struct surf_context *ctx, int num_data);
+
+
+/*
+ * Routine:	context_destroy
+ *
+ * Description:	Release a context, its arrays and its transform plans.
+ *
+ * Parameters:	ctx	< the context made by context_create()
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void context_destroy(struct surf_context *ctx);
+
+#endif
@@ -7,12 +7,13 @@
  *		Definitions:
  *			error numbers
  *		Declarations:
+ *			error_string()	- the message for an error number
  *			print_error()	- prints the error number
  *
  * Date:	25/4/91
  *****************************************************************/
 
-#define MAX_ERRORS 11
+#define MAX_ERRORS 12
 
 #define ER_FIL 1
 #define ER_MAG 2
@@ -23,22 +24,42 @@
 #define ER_DIV0 7
 #define ER_COMPAT 8
 #define ER_FONT 9
+#define ER_COUNT 10
+#define ER_BANDS 11
                    
                                                      
+/*
+ * Routine:	error_string
+ *
+ * Description: Return the message for a given error number. The
+ *		messages are constant, so it is safe from any thread.
+ *
+ * Parameters:  number	< the error number
+ *
+ * Returns:	the message
+ *
+ * Example:     error_string(ER_FIL);
+ *		return("File not found");
+ *
+ * Date:	17/10/26
+ */
+const char *error_string(int number);
+
+
 /*
  * Routine:	print_error
  *
  * Description: Print error messages in response to a given error
  *     		number
  *
- * Parameters:  none
+ * Parameters:  number	< the error number
  *
  * Returns:	nothing
  *
- * Example:     error_number=10;
- *		printf("Magnification number out of range\n");
+ * Example:     print_error(ER_MAG);
+ *		printf("Magnification out of range - invalid file\n");
  *
  * Date:	22/5/91
  */
-void print_error();
+void print_error(int number);
                                                      
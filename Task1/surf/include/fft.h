@@ -5,27 +5,327 @@
  *			Definitions
  *				constants
  *				confidence interval lengths.
+ *				fft_plan structure
  *
  *			Declarations
  *				fft()	- the fast Fourier transform
+ *				fft_plan_create()	- build a transform plan
+ *				fft_plan_destroy()	- release a transform plan
+ *				fft_plan_get()	- fetch a cached transform plan
+ *				fft_cache_free()	- release cached plans
+ *				fft_plan_float()	- float tables of a plan
+ *				fft_plan_get_float()	- fetch a plan with float
+ *					  tables
+ *				fft_plan_run()	- in-place transform using a plan
+ *				fft_plan_run_real()	- transform of real values
+ *				fft_plan_run_real_inverse()	- real values from their
+ *					  coefficients
+ *				fft_float(), fft_plan_run_float(),
+ *				fft_plan_run_real_float(),
+ *				fft_plan_run_real_inverse_float()	- the same
+ *					  in float
  *
  *
  * Date:	23/4/91
  *****************************************************************/
 
+/*
+ * make sure of only one inclusion
+ */
+#ifndef FftDummy
+#define FftDummy
+
+#include "butterfly.h"
+
 /*
  * Constants
  */
 #define MINUS_TWO_PI -6.2831853
 #define FOUR_PI 12.5663706
 #define PI 3.141592654
+#define TWO_PI 6.283185307179586
+
+/*
+ * number of transform plans kept by fft_plan_get()
+ */
+#define FFT_PLAN_CACHE 4
+
+/*
+ * the algorithm used by a plan, chosen from the transform length
+ */
+#define FFT_RADIX_TWO 1  /* integral power of 2 */
+#define FFT_MIXED_RADIX 2  /* product of 2, 3, 4, 5 and small primes */
+#define FFT_BLUESTEIN 3  /* anything else, by chirp-z convolution */
+#define FFT_FIXED 4  /* FFT_CONST_MIN to FFT_CONST_MAX, a power of 2 */
+
+/*
+ * The transforms of the Talysurf filters (see load.h) are of 1024,
+ * 2048 and 4096 points. Those are compiled for their lengths, with
+ * twiddle factors made by twgen (fftconst.h) rather than calculated
+ * by the plan.
+ */
+#define FFT_CONST_MIN 1024
+#define FFT_CONST_MAX 4096
+
+/*
+ * largest prime factor handled by the mixed-radix transform, and the
+ * most factors a length can have
+ */
+#define FFT_MAX_RADIX 13
+#define FFT_MAX_FACTORS 32
+
+
+/*
+ * Structure:	fft_plan
+ *
+ * Description:	Everything about a transform of "n" points that does
+ *		not depend on the data: the twiddle factors
+ *		exp(-2*pi*j*k/n) and, for an integral power of 2, the
+ *		bit-reversal permutation of the indices. A plan of "n"
+ *		points also serves a transform of 2n real values, for
+ *		which the factors exp(-pi*j*k/n), k <= n/2, are kept
+ *		as well. Complex values are held as separate arrays of
+ *		real and imaginary parts. The transforms in float use
+ *		the same tables rounded to floats, which are only made
+ *		when first asked for (see fft_plan_float()). An
+ *		FFT_FIXED plan is an FFT_RADIX_TWO plan whose
+ *		"real_*" and "stage_*" tables are those built in.
+ */
+struct fft_plan {
+   int n;  /* number of points */
+   int kind;  /* FFT_RADIX_TWO, FFT_FIXED, FFT_MIXED_RADIX, FFT_BLUESTEIN */
+   double *real_re, *real_im;  /* n/2+1 factors for real values */
+
+   /* FFT_RADIX_TWO and FFT_FIXED */
+   int log_two_n;  /* number of butterfly stages */
+   int *bit_rev;  /* bit-reversed index of each point */
+   double *stage_re, *stage_im;  /* twiddles of the stage combining
+                                    transforms of h points at [h,2h) */
+   butterfly_stage_fn stage;  /* the butterfly stage routine */
+
+   /* FFT_MIXED_RADIX */
+   int factors[2*FFT_MAX_FACTORS];  /* pairs of radix, remaining length */
+   double *twiddle_re, *twiddle_im;  /* n twiddle factors */
+   double *scratch_re, *scratch_im;  /* input to out-of-place stages */
+
+   /* FFT_BLUESTEIN (which also uses the scratch arrays) */
+   struct fft_plan *sub_plan;  /* integral power of 2, at least 2n-1 */
+   double *chirp_re, *chirp_im;  /* n factors exp(-pi*j*k*k/n) */
+   double *chirp_tfm_re, *chirp_tfm_im;  /* transform of conjugate chirp */
+
+   /* the tables above in float, NULL until fft_plan_float() */
+   float *real_re_float, *real_im_float;
+   float *stage_re_float, *stage_im_float;
+   butterfly_stage_fn_float stage_float;
+   float *twiddle_re_float, *twiddle_im_float;
+   float *scratch_re_float, *scratch_im_float;
+   float *chirp_re_float, *chirp_im_float;
+   float *chirp_tfm_re_float, *chirp_tfm_im_float;
+};
+
+
+/*
+ * Structure:	fft_cache
+ *
+ * Description:	The FFT_PLAN_CACHE most recently used plans, so that
+ *		plans are built once per length and reused. Each
+ *		analysis context has its own cache.
+ */
+struct fft_cache {
+   struct fft_plan *plan[FFT_PLAN_CACHE];
+   int next;  /* next slot to be replaced */
+};
+
+struct surf_context;
 
 
 /*
  * Routine:	fft
  *
  * Description:	The Fourier transform of the data items is calculated.
+ *		The "trans_num_data" real items are held two to a
+ *		complex value in "trans_re" and "trans_im" (see
+ *		fft_plan_run_real()), which are left holding the first
+ *		trans_num_data/2+1 Fourier coefficients.
  *
  * Date:	22/4/91
  */
-void fft();
+int fft(struct surf_context *ctx);
+
+
+/*
+ * Routine:	fft_plan_create
+ *
+ * Description:	Allocate a plan, choose the algorithm for "n" points
+ *		and calculate the tables it needs.
+ *
+ * Parameters:	n	< number of points
+ *
+ * Returns:	the plan, or NULL if memory is not available
+ *
+ * Date:	17/10/26
+ */
+struct fft_plan *fft_plan_create(int n);
+
+
+/*
+ * Routine:	fft_plan_destroy
+ *
+ * Description:	Release the memory held by a plan.
+ *
+ * Parameters:	plan	< the plan made by fft_plan_create()
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void fft_plan_destroy(struct fft_plan *plan);
+
+
+/*
+ * Routine:	fft_plan_get
+ *
+ * Description:	Return a plan for "n" points, building it only if it is
+ *		not already among the FFT_PLAN_CACHE most recent plans.
+ *		The plan remains owned by the cache.
+ *
+ * Parameters:	cache	<> the plan cache
+ *		n	< number of points
+ *
+ * Returns:	the plan, or NULL if memory is not available
+ *
+ * Date:	17/10/26
+ */
+struct fft_plan *fft_plan_get(struct fft_cache *cache, int n);
+
+
+/*
+ * Routine:	fft_cache_free
+ *
+ * Description:	Release every plan held by a cache.
+ *
+ * Parameters:	cache	<> the plan cache
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void fft_cache_free(struct fft_cache *cache);
+
+
+/*
+ * Routine:	fft_plan_float
+ *
+ * Description:	Give a plan the tables of the float transforms, each
+ *		the double table rounded, the first time they are
+ *		needed. A Bluestein plan's power of 2 plan is given
+ *		them too.
+ *
+ * Parameters:	plan	<> the plan
+ *
+ * Returns:	TRUE	- the float tables are ready
+ *		ER_MEM	- memory is not available
+ *
+ * Date:	17/10/26
+ */
+int fft_plan_float(struct fft_plan *plan);
+
+
+/*
+ * Routine:	fft_plan_get_float
+ *
+ * Description:	As fft_plan_get(), for a plan that will be run in
+ *		float.
+ *
+ * Parameters:	cache	<> the plan cache
+ *		n	< number of points
+ *
+ * Returns:	the plan, or NULL if memory is not available
+ *
+ * Date:	17/10/26
+ */
+struct fft_plan *fft_plan_get_float(struct fft_cache *cache, int n);
+
+
+/*
+ * Routine:	fft_plan_run
+ *
+ * Description:	Transform "plan->n" complex values in place, using
+ *		whichever algorithm the plan was built for.
+ *
+ * Parameters:	plan	< the plan for the transform length
+ *		re, im	<> real and imaginary parts of the values to be
+ *			   transformed
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void fft_plan_run(const struct fft_plan *plan, double *re, double *im);
+
+
+/*
+ * Routine:	fft_plan_run_real
+ *
+ * Description:	Transform 2*plan->n real values in place. On entry
+ *		re[k] holds real value 2k and im[k] holds real value
+ *		2k+1. A transform of "plan->n" points is
+ *		followed by a split into the coefficients of the real
+ *		sequence, of which the first plan->n+1 are returned
+ *		(the rest are their complex conjugates).
+ *
+ * Parameters:	plan	< the plan for half the number of real values
+ *		re, im	<> plan->n packed real values on entry, room
+ *			   for plan->n+1 coefficients
+ *
+ * Returns:	nothing
+ *
+ * Example:	real values [1,2,3,4], so re = [1,3], im = [2,4];
+ *		following transformation, re = [10,-2,-2], im = [0,2,0]
+ *
+ * Date:	17/10/26
+ */
+void fft_plan_run_real(const struct fft_plan *plan, double *re, double *im);
+
+
+/*
+ * Routine:	fft_plan_run_real_inverse
+ *
+ * Description:	Undo fft_plan_run_real(): from the first plan->n+1
+ *		coefficients of a real sequence (the rest being their
+ *		complex conjugates) find its 2*plan->n values, packed
+ *		as on entry to fft_plan_run_real().
+ *
+ * Parameters:	plan	< the plan for half the number of real values
+ *		re, im	<> plan->n+1 coefficients on entry, plan->n
+ *			   packed real values on exit
+ *
+ * Returns:	nothing
+ *
+ * Example:	re = [10,-2,-2], im = [0,2,0];
+ *		following transformation, re = [1,3], im = [2,4]
+ *
+ * Date:	17/10/26
+ */
+void fft_plan_run_real_inverse(const struct fft_plan *plan, double *re,
+   double *im);
+
+
+/*
+ * Routines:	fft_float, fft_plan_run_float, fft_plan_run_real_float,
+ *		fft_plan_run_real_inverse_float
+ *
+ * Description:	The transforms above in float, for a plan with float
+ *		tables (see fft_plan_get_float()). fft_float() finds
+ *		floats in "trans_re" and "trans_im" (see context.h).
+ *
+ * Date:	17/10/26
+ */
+int fft_float(struct surf_context *ctx);
+void fft_plan_run_float(const struct fft_plan *plan, float *re, float *im);
+void fft_plan_run_real_float(const struct fft_plan *plan, float *re,
+   float *im);
+void fft_plan_run_real_inverse_float(const struct fft_plan *plan,
+   float *re, float *im);
+
+#endif
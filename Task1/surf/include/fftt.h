@@ -0,0 +1,419 @@
+/******************************************************************
+ * Module:	fftt.h
+ *
+ * Purpose:	Template of the transforms, included by fft.c once for
+ *		each precision (see scalar.h). The float routines
+ *		need the float tables of the plan (see
+ *		fft_plan_float()).
+ *
+ * Contents:	fft()			- transform "trans_re", "trans_im"
+ *		fft_plan_run()		- in-place transform using a plan
+ *		fft_fixed()		- transform of an FFT_FIXED length
+ *		fft_fixed_1024(), fft_fixed_2048(), fft_fixed_4096()
+ *					- fft_fixed() for each length
+ *		fft_leaf()		- the first three stages at once
+ *		fft_plan_run_real()	- transform of real values
+ *		fft_plan_run_real_inverse()	- real values from their
+ *				  coefficients
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+/*
+ * Routine:	fft_leaf
+ *
+ * Description:	The first three butterfly stages of a radix-2
+ *		transform, as one unrolled transform of 8 points on
+ *		each 8 values in bit-reversed order. Its twiddle
+ *		factors are 1, -j and (+-1-j)/sqrt(2), so most of the
+ *		multiplications of those stages are not needed.
+ *
+ * Parameters:	re, im	<> the values, in bit-reversed order
+ *		n	< number of values, a multiple of 8
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+static void SCALAR_NAME(fft_leaf)(scalar *re, scalar *im, int n)
+{
+   const scalar r = (scalar) 0.70710678118654752440;  /* sqrt(1/2) */
+   scalar a_re[8],a_im[8],b_re[8],b_im[8],t_re,t_im;
+   scalar *x_re,*x_im;
+   int i;
+
+   for(i=0;i<n;i+=8) {
+      x_re = re+i;
+      x_im = im+i;
+
+      /*
+       * transforms of 2 points
+       */
+      a_re[0] = x_re[0] + x_re[1];  a_im[0] = x_im[0] + x_im[1];
+      a_re[1] = x_re[0] - x_re[1];  a_im[1] = x_im[0] - x_im[1];
+      a_re[2] = x_re[2] + x_re[3];  a_im[2] = x_im[2] + x_im[3];
+      a_re[3] = x_re[2] - x_re[3];  a_im[3] = x_im[2] - x_im[3];
+      a_re[4] = x_re[4] + x_re[5];  a_im[4] = x_im[4] + x_im[5];
+      a_re[5] = x_re[4] - x_re[5];  a_im[5] = x_im[4] - x_im[5];
+      a_re[6] = x_re[6] + x_re[7];  a_im[6] = x_im[6] + x_im[7];
+      a_re[7] = x_re[6] - x_re[7];  a_im[7] = x_im[6] - x_im[7];
+
+      /*
+       * transforms of 4 points; the second factor is -j
+       */
+      b_re[0] = a_re[0] + a_re[2];  b_im[0] = a_im[0] + a_im[2];
+      b_re[2] = a_re[0] - a_re[2];  b_im[2] = a_im[0] - a_im[2];
+      b_re[1] = a_re[1] + a_im[3];  b_im[1] = a_im[1] - a_re[3];
+      b_re[3] = a_re[1] - a_im[3];  b_im[3] = a_im[1] + a_re[3];
+      b_re[4] = a_re[4] + a_re[6];  b_im[4] = a_im[4] + a_im[6];
+      b_re[6] = a_re[4] - a_re[6];  b_im[6] = a_im[4] - a_im[6];
+      b_re[5] = a_re[5] + a_im[7];  b_im[5] = a_im[5] - a_re[7];
+      b_re[7] = a_re[5] - a_im[7];  b_im[7] = a_im[5] + a_re[7];
+
+      /*
+       * the transform of 8 points; the factors are 1, (1-j)/sqrt(2),
+       * -j and (-1-j)/sqrt(2)
+       */
+      x_re[0] = b_re[0] + b_re[4];  x_im[0] = b_im[0] + b_im[4];
+      x_re[4] = b_re[0] - b_re[4];  x_im[4] = b_im[0] - b_im[4];
+
+      t_re = r*(b_re[5] + b_im[5]);
+      t_im = r*(b_im[5] - b_re[5]);
+      x_re[1] = b_re[1] + t_re;  x_im[1] = b_im[1] + t_im;
+      x_re[5] = b_re[1] - t_re;  x_im[5] = b_im[1] - t_im;
+
+      x_re[2] = b_re[2] + b_im[6];  x_im[2] = b_im[2] - b_re[6];
+      x_re[6] = b_re[2] - b_im[6];  x_im[6] = b_im[2] + b_re[6];
+
+      t_re = r*(b_im[7] - b_re[7]);
+      t_im = -r*(b_re[7] + b_im[7]);
+      x_re[3] = b_re[3] + t_re;  x_im[3] = b_im[3] + t_im;
+      x_re[7] = b_re[3] - t_re;  x_im[7] = b_im[3] - t_im;
+   }
+}
+
+
+/*
+ * Routine:	fft_fixed
+ *
+ * Description:	Transform an FFT_FIXED length of values in place: the
+ *		bit-reversal permutation, fft_leaf() and the remaining
+ *		stages on the built-in twiddle factors. It is compiled
+ *		into each of fft_fixed_1024(), fft_fixed_2048() and
+ *		fft_fixed_4096(), so that "n" and "log_two_n" are
+ *		constants and its loops can be unrolled.
+ *
+ * Parameters:	plan		< the plan for the transform length
+ *		re, im		<> the values to be transformed
+ *		n		< number of points, plan->n
+ *		log_two_n	< its logarithm to base 2
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+__attribute__((always_inline))
+static inline void SCALAR_NAME(fft_fixed)(const struct fft_plan *plan,
+   scalar *re, scalar *im, const int n, const int log_two_n)
+{
+   scalar temp;
+   int half,stage,i,j;
+
+   for(i=0;i<n;i++) {
+      j = plan->bit_rev[i];
+      if (i < j) {
+         temp = re[i]; re[i] = re[j]; re[j] = temp;
+         temp = im[i]; im[i] = im[j]; im[j] = temp;
+      }
+   }
+
+   SCALAR_NAME(fft_leaf)(re,im,n);
+
+   for(stage=3;stage<log_two_n;stage++) {
+      half = 1 << stage;
+      plan->SCALAR_NAME(stage)(re,im,n,half,
+         plan->SCALAR_NAME(stage_re)+half,plan->SCALAR_NAME(stage_im)+half);
+   }
+}
+
+
+/*
+ * Routines:	fft_fixed_1024, fft_fixed_2048, fft_fixed_4096
+ *
+ * Description:	fft_fixed() for each length of a Talysurf filter.
+ *
+ * Date:	17/10/26
+ */
+#undef FFT_FIXED_RUN
+#define FFT_FIXED_RUN(n,log_two_n) \
+static void SCALAR_NAME(fft_fixed_##n)(const struct fft_plan *plan, \
+   scalar *re, scalar *im) \
+{ \
+   SCALAR_NAME(fft_fixed)(plan,re,im,n,log_two_n); \
+}
+
+FFT_FIXED_RUN(1024,10)
+FFT_FIXED_RUN(2048,11)
+FFT_FIXED_RUN(4096,12)
+
+
+/*
+ * Routine:	fft
+ *
+ * Description:	The Fourier transform of the data items is calculated.
+ *		The "trans_num_data" real items are held two to a
+ *		complex value in "trans_re" and "trans_im" (see
+ *		fft_plan_run_real()), which are left holding the first
+ *		trans_num_data/2+1 Fourier coefficients. fft_float()
+ *		does the same in floats, which it finds in the same
+ *		arrays (see context.h).
+ *
+ * Parameters:	ctx	<> the analysis context
+ *
+ * Returns:	TRUE	- successful calculation
+ *		ER_MEM	- no memory for the transform plan
+ *
+ * Example:	trans_re = [1,3], trans_im = [2,4], trans_num_data = 4;
+ *		following transformation, trans_re = [10,-2,-2],
+ *		trans_im = [0,2,0]
+ *
+ * Date:	22/4/91
+ */
+int SCALAR_NAME(fft)(struct surf_context *ctx)
+{
+   struct fft_plan *plan;
+
+   plan = SCALAR_NAME(fft_plan_get)(&ctx->plans,ctx->trans_num_data/2);
+   if (plan == NULL) {
+      ctx->error_number = ER_MEM;
+      return(ER_MEM);
+   }
+
+   SCALAR_NAME(fft_plan_run_real)(plan,(scalar *) ctx->trans_re,
+      (scalar *) ctx->trans_im);
+
+   return(TRUE);
+}
+
+
+/*
+ * Routine:	fft_plan_run
+ *
+ * Description:	Transform "plan->n" complex values in place, using
+ *		whichever algorithm the plan was built for. The lengths
+ *		of FFT_FIXED plans have routines of their own.
+ *
+ * Parameters:	plan	< the plan for the transform length
+ *		re, im	<> real and imaginary parts of the values to be
+ *			   transformed
+ *
+ * Returns:	nothing
+ *
+ * Example:	re = [1,2,3,4], im = [0,0,0,0], plan->n = 4;
+ *		following transformation, re = [10,-2,-2,-2],
+ *		im = [0,2,0,-2]
+ *
+ * Date:	17/10/26
+ */
+void SCALAR_NAME(fft_plan_run)(const struct fft_plan *plan, scalar *re,
+   scalar *im)
+{
+   scalar temp;
+   int n,half,i,j;
+
+   n = plan->n;
+
+   if (plan->kind == FFT_FIXED) {
+      switch (n) {
+         case 1024:
+            SCALAR_NAME(fft_fixed_1024)(plan,re,im);
+            return;
+         case 2048:
+            SCALAR_NAME(fft_fixed_2048)(plan,re,im);
+            return;
+         case 4096:
+            SCALAR_NAME(fft_fixed_4096)(plan,re,im);
+            return;
+      }
+   }
+   if (plan->kind == FFT_MIXED_RADIX) {
+      SCALAR_NAME(mixfft_run)(plan,re,im);
+      return;
+   }
+   if (plan->kind == FFT_BLUESTEIN) {
+      SCALAR_NAME(bluestein_run)(plan,re,im);
+      return;
+   }
+
+   /*
+    * put the values into bit-reversed order, swapping each pair once
+    */
+   for(i=0;i<n;i++) {
+      j = plan->bit_rev[i];
+      if (i < j) {
+         temp = re[i]; re[i] = re[j]; re[j] = temp;
+         temp = im[i]; im[i] = im[j]; im[j] = temp;
+      }
+   }
+
+   /*
+    * decimation in time: combine pairs of transforms of "half"
+    * points into transforms of "2*half" points
+    */
+   for(half=1;half<n;half*=2)
+      plan->SCALAR_NAME(stage)(re,im,n,half,
+         plan->SCALAR_NAME(stage_re)+half,plan->SCALAR_NAME(stage_im)+half);
+}
+
+
+/*
+ * Routine:	fft_plan_run_real
+ *
+ * Description:	Transform 2*plan->n real values in place. On entry
+ *		re[k] holds real value 2k and im[k] holds real value
+ *		2k+1. A transform of "plan->n" points is
+ *		followed by a split into the coefficients of the real
+ *		sequence, of which the first plan->n+1 are returned
+ *		(the rest are their complex conjugates).
+ *
+ * Parameters:	plan	< the plan for half the number of real values
+ *		re, im	<> plan->n packed real values on entry, room
+ *			   for plan->n+1 coefficients
+ *
+ * Returns:	nothing
+ *
+ * Example:	real values [1,2,3,4], so re = [1,3], im = [2,4];
+ *		following transformation, re = [10,-2,-2], im = [0,2,0]
+ *
+ * Date:	17/10/26
+ */
+void SCALAR_NAME(fft_plan_run_real)(const struct fft_plan *plan, scalar *re,
+   scalar *im)
+{
+   scalar a_re,a_im,b_re,b_im;
+   scalar even_re,even_im,odd_re,odd_im,t_re,t_im;
+   const scalar *w_re,*w_im;
+   int n,k;
+
+   n = plan->n;
+   w_re = plan->SCALAR_NAME(real_re);
+   w_im = plan->SCALAR_NAME(real_im);
+
+   /*
+    * transform of the even values + j times the odd values
+    */
+   SCALAR_NAME(fft_plan_run)(plan,re,im);
+
+   /*
+    * The transform Z of the packed values gives the transforms of the
+    * even and odd values as
+    *  E[k] = (Z[k] + conj(Z[n-k]))/2
+    *  O[k] = -j(Z[k] - conj(Z[n-k]))/2
+    * and the required coefficients are X[k] = E[k] + exp(-pi*j*k/n)O[k]
+    * with X[n-k] = conj(E[k] - exp(-pi*j*k/n)O[k]), so each pair k, n-k
+    * is formed together in place.
+    */
+   a_re = re[0];
+   a_im = im[0];
+   re[0] = a_re + a_im;
+   im[0] = 0.0;
+   re[n] = a_re - a_im;
+   im[n] = 0.0;
+
+   for(k=1;k<=n/2;k++) {
+      a_re = re[k];
+      a_im = im[k];
+      b_re = re[n-k];
+      b_im = -im[n-k];
+
+      even_re = (scalar) 0.5*(a_re + b_re);
+      even_im = (scalar) 0.5*(a_im + b_im);
+      odd_re = (scalar) 0.5*(a_im - b_im);
+      odd_im = -(scalar) 0.5*(a_re - b_re);
+
+      t_re = w_re[k]*odd_re - w_im[k]*odd_im;
+      t_im = w_re[k]*odd_im + w_im[k]*odd_re;
+      re[k] = even_re + t_re;
+      im[k] = even_im + t_im;
+      re[n-k] = even_re - t_re;
+      im[n-k] = -(even_im - t_im);
+   }
+}
+
+
+/*
+ * Routine:	fft_plan_run_real_inverse
+ *
+ * Description:	Undo fft_plan_run_real(): from the first plan->n+1
+ *		coefficients of a real sequence (the rest being their
+ *		complex conjugates) find its 2*plan->n values, packed
+ *		as on entry to fft_plan_run_real(). The split step is
+ *		reversed and the transform of "plan->n" points is run
+ *		backwards by conjugating before and after.
+ *
+ * Parameters:	plan	< the plan for half the number of real values
+ *		re, im	<> plan->n+1 coefficients on entry, plan->n
+ *			   packed real values on exit
+ *
+ * Returns:	nothing
+ *
+ * Example:	re = [10,-2,-2], im = [0,2,0];
+ *		following transformation, re = [1,3], im = [2,4]
+ *
+ * Date:	17/10/26
+ */
+void SCALAR_NAME(fft_plan_run_real_inverse)(const struct fft_plan *plan,
+   scalar *re, scalar *im)
+{
+   scalar a_re,a_im,b_re,b_im;
+   scalar even_re,even_im,odd_re,odd_im,t_re,t_im;
+   const scalar *w_re,*w_im;
+   scalar scale;
+   int n,k;
+
+   n = plan->n;
+   w_re = plan->SCALAR_NAME(real_re);
+   w_im = plan->SCALAR_NAME(real_im);
+
+   /*
+    * With X[k] and conj(X[n-k]) the transforms of the even and odd
+    * values are
+    *  E[k] = (X[k] + conj(X[n-k]))/2
+    *  O[k] = exp(pi*j*k/n)(X[k] - conj(X[n-k]))/2
+    * and the packed values are the inverse transform of E[k] + jO[k].
+    * Those of n-k are conj(E[k]) + j conj(O[k]), so each pair is
+    * formed together in place; the inverse transform is the forward
+    * one of the conjugates, so the imaginary parts are left negated.
+    */
+   a_re = re[0];
+   b_re = re[n];
+   re[0] = (scalar) 0.5*(a_re + b_re);
+   im[0] = -(scalar) 0.5*(a_re - b_re);
+
+   for(k=1;k<=n/2;k++) {
+      a_re = re[k];
+      a_im = im[k];
+      b_re = re[n-k];
+      b_im = -im[n-k];
+
+      even_re = (scalar) 0.5*(a_re + b_re);
+      even_im = (scalar) 0.5*(a_im + b_im);
+      t_re = (scalar) 0.5*(a_re - b_re);
+      t_im = (scalar) 0.5*(a_im - b_im);
+      odd_re = w_re[k]*t_re + w_im[k]*t_im;
+      odd_im = w_re[k]*t_im - w_im[k]*t_re;
+
+      re[k] = even_re - odd_im;
+      im[k] = -(even_im + odd_re);
+      re[n-k] = even_re + odd_im;
+      im[n-k] = -(-even_im + odd_re);
+   }
+
+   SCALAR_NAME(fft_plan_run)(plan,re,im);
+
+   scale = (scalar) 1.0/n;
+   for(k=0;k<n;k++) {
+      re[k] = scale*re[k];
+      im[k] = -scale*im[k];
+   }
+}
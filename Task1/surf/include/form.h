@@ -0,0 +1,90 @@
+/******************************************************************
+ * Module:	form.h
+ *
+ * Purpose:	Removal of the form of a profile: a polynomial of
+ *		order up to FORM_MAX_ORDER, fitted as a sum of discrete
+ *		orthogonal (Gram) polynomials, or the arc of a circle,
+ *		so that curved parts need no separate levelling before
+ *		they are analysed.
+ *
+ * Contents:	Definitions
+ *			forms
+ *
+ *		Declarations
+ *			form_remove()	- take the form off the data
+ *			form_name()	- form from its name
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+/*
+ * make sure of only one inclusion
+ */
+#ifndef FormDummy
+#define FormDummy
+
+/*
+ * The form taken off a profile: the polynomial of that order, from
+ * FORM_LINE (the best-fitting line, the default) to FORM_MAX_ORDER,
+ * or FORM_ARC.
+ */
+#define FORM_LINE 1
+#define FORM_MAX_ORDER 5
+#define FORM_ARC 6
+
+/*
+ * number of independent partial sums kept by the passes over the
+ * data; consecutive samples go to consecutive lanes (see
+ * MOMENTS_LANES)
+ */
+#define FORM_LANES 4
+
+struct surf_context;
+
+
+/*
+ * Routine:	form_remove
+ *
+ * Description:	Take the context's "form" off its data in place.
+ *		A polynomial is fitted in one pass over the data,
+ *		which finds their sums with each Gram polynomial of
+ *		the sample index; the recurrence and norms of those
+ *		polynomials have closed forms, so nothing else is
+ *		summed. An arc is the least-squares circle through the
+ *		samples at their true scale ("x_division" and
+ *		"y_division"), and the profile left is taken about its
+ *		mean; a profile too flat for a circle has its line
+ *		taken off instead. The statistics gathered while the
+ *		data were read (see online.h) no longer describe the
+ *		profile and are cleared.
+ *
+ * Parameters:	ctx	<> the analysis context
+ *
+ * Returns:	nothing
+ *
+ * Example:	ctx->form = 3;
+ *		form_remove(ctx);
+ *
+ * Date:	17/10/26
+ */
+void form_remove(struct surf_context *ctx);
+
+
+/*
+ * Routine:	form_name
+ *
+ * Description:	The form named "line", "arc" or by the order of its
+ *		polynomial, "1" to FORM_MAX_ORDER.
+ *
+ * Parameters:	name	< the name
+ *
+ * Returns:	the form, or FALSE if the name is not known
+ *
+ * Example:	form_name("arc");
+ *		return(FORM_ARC);
+ *
+ * Date:	17/10/26
+ */
+int form_name(const char *name);
+
+#endif
@@ -4,9 +4,11 @@
  * Purpose:	Fast Fourier Transform (FFT) routine.
  *
  * Contents:	calculate_fft()		- controls the FFT routine
- *		copy_data()		- transfer "data" to "trans_data"
+ *		copy_data()		- transfer "data" to "trans_re", "trans_im"
  *		calculate_spectrum()	- compute the spectral data
  *		calc_params()		- calculate my parameters
+ *		autocorrelation_function()	- the whole autocorrelation
+ *				  function, by FFT
  *		print_params()		- print my parameters
  *
  * Date:	22/4/91
@@ -20,33 +22,40 @@
 #ifndef FourierDummy
 #define FourierDummy
 
+#include "context.h"
+
+/*
+ * First two autocorrelation values (held in the context's
+ * "params": gamma0, gamma1)
+ */
+struct surf_moments;
+void autocorrelation_calculate(struct surf_context *ctx,
+   const struct surf_moments *m);
+void autocorrelation_print(struct surf_context *ctx);
+
 /*
- * First two autocorrelation values
+ * The whole autocorrelation function (held in the context's "acf")
+ * and the correlation length ("params": c_lambda), the lag at which
+ * the function falls to CORRELATION_LEVEL of its value at lag 0: 1/e,
+ * or 0.0 for the first zero crossing
  */
-double gamma0;
-double gamma1;
-void autocorrelation_calculate();
-void autocorrelation_print();
+#define CORRELATION_LEVEL 0.36787944117144233
+int autocorrelation_function(struct surf_context *ctx);
 
 /*
- * Parameters
+ * Parameters (held in the context's "params": ra, rp, rv, rt, c_lambda)
  */
-double ra; // Ra value
-double rp; // maximum peak  
-double rv; // maximum valley
-double rt; // maximum peak to valley
-void parameter_calculate();
-void parameter_print();
+void parameter_print(struct surf_context *ctx);
 
 
 /*
  * prototypes
  */
-int calculate_fft();
-void copy_data();
-void calculate_spectrum();
-int calc_params();
-int print_params();
+int calculate_fft(struct surf_context *ctx);
+void copy_data(struct surf_context *ctx);
+void calculate_spectrum(struct surf_context *ctx);
+int calc_params(struct surf_context *ctx);
+int print_params(struct surf_context *ctx);
 
 
 #endif
@@ -0,0 +1,148 @@
+/******************************************************************
+ * Module:	fouriert.h
+ *
+ * Purpose:	Template of the spectrum and autocorrelation kernels,
+ *		included by fourier.c once for each precision (see
+ *		scalar.h). In float the transform arrays of the
+ *		context hold floats (see context.h); the data and
+ *		the results are doubles either way.
+ *
+ * Contents:	pack_data()	- "data" into "trans_re", "trans_im"
+ *		spectrum_values()	- squared magnitudes
+ *		acf_transform()	- the autocorrelation function by FFT
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+
+/*
+ * Routine:	pack_data
+ *
+ * Description:	Pack the data two real values to a complex value,
+ *		even-numbered "data" to the real parts in "trans_re"
+ *		and odd-numbered "data" to the imaginary parts in
+ *		"trans_im", followed by zeros up to "trans_num_data".
+ *
+ * Parameters:	ctx	<> the analysis context
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+static void SCALAR_NAME(pack_data)(struct surf_context *ctx)
+{
+   scalar *re,*im;
+   int i;
+
+   re = (scalar *) ctx->trans_re;
+   im = (scalar *) ctx->trans_im;
+   for(i=0;i<ctx->num_data/2;i++) {
+      re[i] = (scalar) ctx->data[2*i];
+      im[i] = (scalar) ctx->data[2*i+1];
+   }
+   if (ctx->num_data % 2 == 1) {
+      re[i] = (scalar) ctx->data[2*i];
+      im[i] = 0.0;
+      i++;
+   }
+   for(;i<ctx->trans_num_data/2;i++) {
+      re[i] = 0.0;
+      im[i] = 0.0;
+   }
+}
+
+
+/*
+ * Routine:	spectrum_values
+ *
+ * Description:	The sum of the squares of the real and imaginary
+ *		parts of each transform value, into "spec_data".
+ *
+ * Parameters:	ctx	<> the analysis context
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+static void SCALAR_NAME(spectrum_values)(struct surf_context *ctx)
+{
+   const scalar *re,*im;
+   int i;
+
+   re = (const scalar *) ctx->trans_re;
+   im = (const scalar *) ctx->trans_im;
+   for(i=0;i<ctx->spec_num_data;i++)
+      ctx->spec_data[i] = re[i]*re[i] + im[i]*im[i];
+}
+
+
+/*
+ * Routine:	acf_transform
+ *
+ * Description:	The autocorrelation function of the data at every lag
+ *		(see autocorrelation_function()), from transforms of
+ *		"length" real values.
+ *
+ * Parameters:	ctx	<> the analysis context
+ *		length	< an integral power of 2, at least twice
+ *			  "num_data"
+ *
+ * Returns:	TRUE	- successful calculation
+ *		FALSE	- no memory for the transform plan
+ *
+ * Date:	17/10/26
+ */
+static int SCALAR_NAME(acf_transform)(struct surf_context *ctx, int length)
+{
+   struct fft_plan *plan;
+   scalar *re,*im,*power;
+   double scale;
+   int half;
+   int i;
+
+   half = length/2;
+   plan = SCALAR_NAME(fft_plan_get)(&ctx->plans,half);
+   if (plan == NULL) {
+      ctx->error_number = ER_MEM;
+      return(FALSE);
+   }
+   re = (scalar *) ctx->acf_re;
+   im = (scalar *) ctx->acf_im;
+   power = (scalar *) ctx->acf;  /* until the function itself is known */
+
+   /*
+    * transform the data, packed two to a complex value, then zeros
+    */
+   for(i=0;i<half;i++) {
+      re[i] = 2*i < ctx->num_data ? (scalar) ctx->data[2*i] : 0.0;
+      im[i] = 2*i+1 < ctx->num_data ? (scalar) ctx->data[2*i+1] : 0.0;
+   }
+   SCALAR_NAME(fft_plan_run_real)(plan,re,im);
+
+   /*
+    * power spectrum at frequencies 0..half; those above half mirror
+    * them
+    */
+   for(i=0;i<=half;i++)
+      power[i] = re[i]*re[i] + im[i]*im[i];
+
+   /*
+    * The power spectrum is real and even, so its inverse transform is
+    * its forward transform divided by "length". The whole spectrum is
+    * packed two to a complex value and transformed again.
+    */
+   for(i=0;i<half;i++) {
+      re[i] = power[2*i <= half ? 2*i : length-2*i];
+      im[i] = power[2*i+1 <= half ? 2*i+1 : length-2*i-1];
+   }
+   SCALAR_NAME(fft_plan_run_real)(plan,re,im);
+
+   /*
+    * the real parts are the lag products
+    */
+   scale = ctx->y_division*ctx->y_division/((double) length*ctx->num_data);
+   for(i=0;i<ctx->num_data;i++)
+      ctx->acf[i] = scale*re[i];
+
+   return(TRUE);
+}
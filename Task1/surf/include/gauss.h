@@ -0,0 +1,59 @@
+/******************************************************************
+ * Module:	gauss.h
+ *
+ * Purpose:	The Gaussian profile filter (ISO 16610-21), splitting
+ *		a levelled profile into roughness and waviness.
+ *
+ * Contents:	Definitions
+ *			weighting function constant
+ *
+ *		Declarations
+ *			gauss_filter()	- roughness and waviness profiles
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+/*
+ * make sure of only one inclusion
+ */
+#ifndef GaussDummy
+#define GaussDummy
+
+/*
+ * sqrt(ln 2/pi), which makes the waviness transmit half of the
+ * amplitude of a wave of the cutoff wavelength
+ */
+#define GAUSS_ALPHA 0.4697186393498257
+
+struct surf_context;
+
+
+/*
+ * Routine:	gauss_filter
+ *
+ * Description:	Split the levelled "data" into the mean line of the
+ *		Gaussian filter of cutoff wavelength "cutoff" (the
+ *		waviness, left in "smooth_data") and the roughness
+ *		about it (left in "data"), in one forward and one
+ *		inverse transform. The profile is padded with zeros by
+ *		at least a cutoff so that its ends do not wrap round
+ *		onto each other; within half a cutoff of either end the
+ *		mean line is nevertheless bent towards zero, as with
+ *		any filter that is not given samples beyond the
+ *		traverse. Nothing is done if the cutoff is not
+ *		positive. The statistics gathered while reading belong
+ *		to the unfiltered profile, so they are dropped.
+ *
+ * Parameters:	ctx	<> the analysis context
+ *
+ * Returns:	TRUE	- filtered, or no cutoff
+ *		ER_MEM	- no memory for the transform plan
+ *
+ * Example:	ctx->cutoff = 800.0;  * microns *
+ *		gauss_filter(ctx);
+ *
+ * Date:	17/10/26
+ */
+int gauss_filter(struct surf_context *ctx);
+
+#endif
@@ -4,8 +4,10 @@
  * Purpose:	Global definitions.
  *
  * Contents:	Booleans
- *		Maximum number of data values
+ *		Number of smoothed spectral values
  *		File name lengths
+ *		Transform length modes
+ *		Arithmetic precisions
  *		Batch file name
  *		Error numbers
  *
@@ -22,10 +24,9 @@
 #define FALSE -1
 
 /*
- * maximum number of data values
+ * number of smoothed spectral values; the other arrays are sized
+ * for each profile (see context_reserve())
  */
-#define MAX_DATA 8192
-#define SPEC_MAX_DATA MAX_DATA/2+1
 #define SMOOTH_MAX_DATA 20
 
 /*
@@ -34,48 +35,30 @@
 #define MAX_FIL_LEN 40
 
 /*
- * Scaling factors for the x and y axes, expressed as a multiplying
- * factor per unit
+ * transform length: the data padded with zeros to an integral power
+ * of 2, or exactly the number of data
  */
-extern double x_division;  /* x scaling factor */
-extern double y_division;  /* y scaling factor */
-   
-/* Talysurf data */
-extern int num_data;  
-extern double *data;
-extern double *smooth_data;
-extern int data_valid;
-
-/* transform data */
-extern int trans_num_data;
-extern struct complex *trans_data;
-extern struct complex *dummy_data;
-extern int tfm_valid;
-
-/* spectral data */
-extern int spec_num_data;
-extern double *spec_data;
+#define TRANS_PADDED 0
+#define TRANS_EXACT 1
+
+/*
+ * arithmetic of the transform, spectrum and parameter kernels:
+ * double, or float for quick screening (see scalar.h)
+ */
+#define PRECISION_DOUBLE 0
+#define PRECISION_FLOAT 1
 
 /* smoothed spectral data */
 struct smoothed {
    int subscr;
    double data;
 };
-extern int smooth_num_data;
-extern int cut_num_data;
-extern struct smoothed *smooth;
-
-/* saved smoothed spectral data */
-extern int num_combinations;
-extern struct smoothed *saved_smooth;
 
-/* curve fit to spectral data (defined in fft.c) */
-extern double a_guess;
-extern double b_guess;
-
-/* new parameters */
-extern double rms;
-extern double c_lambda;
+/*
+ * The data, transform and spectral arrays, the scaling factors and
+ * the parameters belong to each analysis and are held in a
+ * "struct surf_context" (see context.h).
+ */
 
 
 /*
@@ -89,7 +72,6 @@ extern FILE *curin;
  * error number definitions
  */
 #include "error.h"
-extern int error_number;
 
 /*
  * Routine:	clrscr
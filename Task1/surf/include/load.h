@@ -21,19 +21,21 @@
    #define SAMPLE_INT 1.0
 
    /*
-    * number of samples collected in a traverse - all values must
-    * be less than MAX_DATA defined in "global.h"
+    * number of samples collected in a traverse
     */
    #define FILTER_J_SAMPLES 1750
    #define FILTER_K_SAMPLES 4000
    #define FILTER_L_SAMPLES 7500
 
    /*
-    * the filters available on the Talysurf
+    * the filters available on the Talysurf; FILTER_FREE marks a
+    * traverse of any length, from instruments without the fixed
+    * filters, whose samples are all those in the file
     */
    #define FILTER_J 1
    #define FILTER_K 2
    #define FILTER_L 3
+   #define FILTER_FREE 4
 
 /*
  * definitions for the vertical scale
@@ -56,13 +58,17 @@
     * "mag[1]" is magnification number 1, which, when plotted on
     * Talysurf paper, has a range of +/- 50 microns.
     */
-extern double mag[NUM_MAG_SETTINGS + 1];
+extern const double mag[NUM_MAG_SETTINGS + 1];
 
 /*
  * prototypes
  */
-int load();
-int check_mag();
-int check_filter();
-int put_smoothed();
+struct surf_context;
+int load(struct surf_context *ctx);
+int load_file(struct surf_context *ctx, const char *filename);
+int load_raw(struct surf_context *ctx, const char *filename);
+int load_text(struct surf_context *ctx, const char *text, const char *end);
+int check_mag(struct surf_context *ctx);
+int check_filter(struct surf_context *ctx);
+int put_smoothed(struct surf_context *ctx);
 
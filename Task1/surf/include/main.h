@@ -3,14 +3,12 @@
  *
  * Purpose:	Prototypes for main.
  *
- * Contents:	assign_memory()	- memory for data
- *				invalid_input()	- respond to invalid user input
+ * Contents:	invalid_input()	- respond to invalid user input
  *
  * Date:	25/11/93
  *****************************************************************/
 
 // prototypes
 
-int assign_memory();
 int invalid_input();
 
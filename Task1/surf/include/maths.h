@@ -106,7 +106,7 @@ double fixed(double, int);
  * Description:	Re-calculate data relative to the best-fitting mse
  *		line
  *
- * Parameters:	none
+ * Parameters:	ctx	<> the analysis context
  *
  * Returns:	nothing
  *
@@ -114,7 +114,8 @@ double fixed(double, int);
  *
  * Date:	23/7/91
  */
-void remove_bias();
+struct surf_context;
+void remove_bias(struct surf_context *ctx);
 
 
 #endif
@@ -0,0 +1,107 @@
+/******************************************************************
+ * Module:	mixfft.h
+ *
+ * Purpose:	Transforms of lengths that are not an integral power
+ *		of 2.
+ *
+ * Contents:	mixfft_factor()	- split a length into radices
+ *		mixfft_run()	- mixed-radix transform
+ *		bluestein_init()	- tables for a chirp-z transform
+ *		bluestein_run()	- chirp-z transform
+ *		mixfft_run_float(), bluestein_run_float()	- the same
+ *				  in float
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+/*
+ * make sure of only one inclusion
+ */
+#ifndef MixfftDummy
+#define MixfftDummy
+
+
+/*
+ * Routine:	mixfft_factor
+ *
+ * Description:	Split "n" into the radices used by the mixed-radix
+ *		transform, largest stages first: 4s, then 2s, then odd
+ *		primes. The factors are stored as pairs of radix and
+ *		the length remaining after that radix.
+ *
+ * Parameters:	n	< the transform length
+ *		factors	> 2*FFT_MAX_FACTORS radix, length pairs
+ *
+ * Returns:	TRUE	- every prime factor is at most FFT_MAX_RADIX
+ *		FALSE	- the length needs the Bluestein transform
+ *
+ * Example:	mixfft_factor(1500,factors);
+ *		factors = [4,375, 3,125, 5,25, 5,5, 5,1]
+ *
+ * Date:	17/10/26
+ */
+int mixfft_factor(int n, int *factors);
+
+
+/*
+ * Routine:	mixfft_run
+ *
+ * Description:	Mixed-radix decimation in time transform of
+ *		"plan->n" values in place, with radix 2, 3, 4 and 5
+ *		butterflies and a general butterfly for other primes.
+ *
+ * Parameters:	plan	< a FFT_MIXED_RADIX plan
+ *		re, im	<> real and imaginary parts of the values
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void mixfft_run(const struct fft_plan *plan, double *re, double *im);
+
+
+/*
+ * Routine:	bluestein_init
+ *
+ * Description:	Calculate the chirp and the transform of its conjugate
+ *		for a chirp-z transform of "plan->n" points.
+ *
+ * Parameters:	plan	<> a FFT_BLUESTEIN plan with "n" set
+ *
+ * Returns:	TRUE	- tables calculated
+ *		ER_MEM	- memory not available
+ *
+ * Date:	17/10/26
+ */
+int bluestein_init(struct fft_plan *plan);
+
+
+/*
+ * Routine:	bluestein_run
+ *
+ * Description:	Transform "plan->n" values in place as a convolution
+ *		with a chirp, evaluated by power of 2 transforms of
+ *		at least 2n-1 points.
+ *
+ * Parameters:	plan	< a FFT_BLUESTEIN plan
+ *		re, im	<> real and imaginary parts of the values
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void bluestein_run(const struct fft_plan *plan, double *re, double *im);
+
+
+/*
+ * Routines:	mixfft_run_float, bluestein_run_float
+ *
+ * Description:	The transforms above in float, for a plan with float
+ *		tables (see fft_plan_float()).
+ *
+ * Date:	17/10/26
+ */
+void mixfft_run_float(const struct fft_plan *plan, float *re, float *im);
+void bluestein_run_float(const struct fft_plan *plan, float *re, float *im);
+
+#endif
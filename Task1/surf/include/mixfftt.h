@@ -0,0 +1,371 @@
+/******************************************************************
+ * Module:	mixfftt.h
+ *
+ * Purpose:	Template of the transforms of lengths that are not an
+ *		integral power of 2, included by mixfft.c once for
+ *		each precision (see scalar.h).
+ *
+ * Contents:	mixfft_run()	- mixed-radix transform
+ *		mixfft_work()	- one stage and those below it
+ *		butterfly_2(), butterfly_3(), butterfly_4(),
+ *		butterfly_5(), butterfly_generic()	- the radices
+ *		bluestein_run()	- chirp-z transform
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+static void SCALAR_NAME(mixfft_work)(const struct fft_plan *plan,
+   scalar *out_re, scalar *out_im, const scalar *in_re, const scalar *in_im,
+   int fstride, const int *factors);
+static void SCALAR_NAME(butterfly_2)(const struct fft_plan *plan,
+   scalar *re, scalar *im, int fstride, int m);
+static void SCALAR_NAME(butterfly_3)(const struct fft_plan *plan,
+   scalar *re, scalar *im, int fstride, int m);
+static void SCALAR_NAME(butterfly_4)(const struct fft_plan *plan,
+   scalar *re, scalar *im, int fstride, int m);
+static void SCALAR_NAME(butterfly_5)(const struct fft_plan *plan,
+   scalar *re, scalar *im, int fstride, int m);
+static void SCALAR_NAME(butterfly_generic)(const struct fft_plan *plan,
+   scalar *re, scalar *im, int fstride, int m, int p);
+
+/*
+ * product of (a_re + j*a_im) with twiddle factor "k" of the plan
+ */
+#undef TW_RE
+#undef TW_IM
+#define TW_RE(a_re,a_im,k) ((a_re)*plan->SCALAR_NAME(twiddle_re)[k] \
+   - (a_im)*plan->SCALAR_NAME(twiddle_im)[k])
+#define TW_IM(a_re,a_im,k) ((a_re)*plan->SCALAR_NAME(twiddle_im)[k] \
+   + (a_im)*plan->SCALAR_NAME(twiddle_re)[k])
+
+
+/*
+ * Routine:	mixfft_run
+ *
+ * Description:	Mixed-radix decimation in time transform of
+ *		"plan->n" values in place, with radix 2, 3, 4 and 5
+ *		butterflies and a general butterfly for other primes.
+ *
+ * Parameters:	plan	< a FFT_MIXED_RADIX plan
+ *		re, im	<> real and imaginary parts of the values
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void SCALAR_NAME(mixfft_run)(const struct fft_plan *plan, scalar *re,
+   scalar *im)
+{
+   /*
+    * the stages work from the plan's scratch copy into "re", "im"
+    */
+   (void) memcpy(plan->SCALAR_NAME(scratch_re),re,plan->n*sizeof(scalar));
+   (void) memcpy(plan->SCALAR_NAME(scratch_im),im,plan->n*sizeof(scalar));
+   SCALAR_NAME(mixfft_work)(plan,re,im,plan->SCALAR_NAME(scratch_re),
+      plan->SCALAR_NAME(scratch_im),1,plan->factors);
+}
+
+
+/*
+ * Routine:	mixfft_work
+ *
+ * Description:	Transform the values in[0], in[fstride], ... into
+ *		out[0..p*m-1], where p is the first radix and m the
+ *		length remaining. Each of the p decimated sequences is
+ *		transformed recursively and then combined by a radix p
+ *		butterfly.
+ *
+ * Parameters:	plan	< the plan holding the twiddle factors
+ *		out_re, out_im	> the transformed values
+ *		in_re, in_im	< the values to be transformed
+ *		fstride	< distance between successive input values
+ *		factors	< the remaining radix, length pairs
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+static void SCALAR_NAME(mixfft_work)(const struct fft_plan *plan,
+   scalar *out_re, scalar *out_im, const scalar *in_re, const scalar *in_im,
+   int fstride, const int *factors)
+{
+   int p,m,q;
+
+   p = factors[0];
+   m = factors[1];
+
+   if (m == 1) {
+      for(q=0;q<p;q++) {
+         out_re[q] = in_re[q*fstride];
+         out_im[q] = in_im[q*fstride];
+      }
+   }
+   else {
+      for(q=0;q<p;q++)
+         SCALAR_NAME(mixfft_work)(plan,out_re+q*m,out_im+q*m,in_re+q*fstride,
+            in_im+q*fstride,fstride*p,factors+2);
+   }
+
+   switch (p) {
+      case 2: SCALAR_NAME(butterfly_2)(plan,out_re,out_im,fstride,m); break;
+      case 3: SCALAR_NAME(butterfly_3)(plan,out_re,out_im,fstride,m); break;
+      case 4: SCALAR_NAME(butterfly_4)(plan,out_re,out_im,fstride,m); break;
+      case 5: SCALAR_NAME(butterfly_5)(plan,out_re,out_im,fstride,m); break;
+      default:
+         SCALAR_NAME(butterfly_generic)(plan,out_re,out_im,fstride,m,p);
+         break;
+   }
+}
+
+
+/*
+ * Routines:	butterfly_2, butterfly_3, butterfly_4, butterfly_5
+ *
+ * Description:	Combine p transforms of m points, held one after
+ *		another in "re", "im", into a transform of p*m points.
+ *		Twiddle factors are taken from the plan's table at
+ *		multiples of "fstride".
+ *
+ * Date:	17/10/26
+ */
+static void SCALAR_NAME(butterfly_2)(const struct fft_plan *plan, scalar *re,
+   scalar *im, int fstride, int m)
+{
+   scalar t_re,t_im;
+   int k;
+
+   for(k=0;k<m;k++) {
+      t_re = TW_RE(re[k+m],im[k+m],k*fstride);
+      t_im = TW_IM(re[k+m],im[k+m],k*fstride);
+      re[k+m] = re[k] - t_re;
+      im[k+m] = im[k] - t_im;
+      re[k] = re[k] + t_re;
+      im[k] = im[k] + t_im;
+   }
+}
+
+static void SCALAR_NAME(butterfly_3)(const struct fft_plan *plan, scalar *re,
+   scalar *im, int fstride, int m)
+{
+   scalar s0_re,s0_im,s1_re,s1_im,s2_re,s2_im,s3_re,s3_im;
+   scalar epi3;  /* imaginary part of exp(-2*pi*j/3) */
+   int k;
+
+   epi3 = plan->SCALAR_NAME(twiddle_im)[fstride*m];
+   for(k=0;k<m;k++) {
+      s1_re = TW_RE(re[k+m],im[k+m],k*fstride);
+      s1_im = TW_IM(re[k+m],im[k+m],k*fstride);
+      s2_re = TW_RE(re[k+2*m],im[k+2*m],2*k*fstride);
+      s2_im = TW_IM(re[k+2*m],im[k+2*m],2*k*fstride);
+      s3_re = s1_re + s2_re;
+      s3_im = s1_im + s2_im;
+      s0_re = (s1_re - s2_re)*epi3;
+      s0_im = (s1_im - s2_im)*epi3;
+
+      re[k+m] = re[k] - (scalar) 0.5*s3_re;
+      im[k+m] = im[k] - (scalar) 0.5*s3_im;
+      re[k] = re[k] + s3_re;
+      im[k] = im[k] + s3_im;
+
+      re[k+2*m] = re[k+m] + s0_im;
+      im[k+2*m] = im[k+m] - s0_re;
+      re[k+m] = re[k+m] - s0_im;
+      im[k+m] = im[k+m] + s0_re;
+   }
+}
+
+static void SCALAR_NAME(butterfly_4)(const struct fft_plan *plan, scalar *re,
+   scalar *im, int fstride, int m)
+{
+   scalar s0_re,s0_im,s1_re,s1_im,s2_re,s2_im;
+   scalar s3_re,s3_im,s4_re,s4_im,s5_re,s5_im;
+   int k;
+
+   for(k=0;k<m;k++) {
+      s0_re = TW_RE(re[k+m],im[k+m],k*fstride);
+      s0_im = TW_IM(re[k+m],im[k+m],k*fstride);
+      s1_re = TW_RE(re[k+2*m],im[k+2*m],2*k*fstride);
+      s1_im = TW_IM(re[k+2*m],im[k+2*m],2*k*fstride);
+      s2_re = TW_RE(re[k+3*m],im[k+3*m],3*k*fstride);
+      s2_im = TW_IM(re[k+3*m],im[k+3*m],3*k*fstride);
+
+      s5_re = re[k] - s1_re;
+      s5_im = im[k] - s1_im;
+      re[k] = re[k] + s1_re;
+      im[k] = im[k] + s1_im;
+      s3_re = s0_re + s2_re;
+      s3_im = s0_im + s2_im;
+      s4_re = s0_re - s2_re;
+      s4_im = s0_im - s2_im;
+      re[k+2*m] = re[k] - s3_re;
+      im[k+2*m] = im[k] - s3_im;
+      re[k] = re[k] + s3_re;
+      im[k] = im[k] + s3_im;
+
+      /*
+       * multiplication of s4 by -j and +j
+       */
+      re[k+m] = s5_re + s4_im;
+      im[k+m] = s5_im - s4_re;
+      re[k+3*m] = s5_re - s4_im;
+      im[k+3*m] = s5_im + s4_re;
+   }
+}
+
+static void SCALAR_NAME(butterfly_5)(const struct fft_plan *plan, scalar *re,
+   scalar *im, int fstride, int m)
+{
+   scalar s0_re,s0_im,s1_re,s1_im,s2_re,s2_im,s3_re,s3_im,s4_re,s4_im;
+   scalar s5_re,s5_im,s6_re,s6_im,s7_re,s7_im,s8_re,s8_im;
+   scalar s9_re,s9_im,s10_re,s10_im,s11_re,s11_im,s12_re,s12_im;
+   scalar ya_re,ya_im,yb_re,yb_im;  /* exp(-2*pi*j/5), exp(-4*pi*j/5) */
+   int k;
+
+   ya_re = plan->SCALAR_NAME(twiddle_re)[fstride*m];
+   ya_im = plan->SCALAR_NAME(twiddle_im)[fstride*m];
+   yb_re = plan->SCALAR_NAME(twiddle_re)[2*fstride*m];
+   yb_im = plan->SCALAR_NAME(twiddle_im)[2*fstride*m];
+
+   for(k=0;k<m;k++) {
+      s0_re = re[k];
+      s0_im = im[k];
+      s1_re = TW_RE(re[k+m],im[k+m],k*fstride);
+      s1_im = TW_IM(re[k+m],im[k+m],k*fstride);
+      s2_re = TW_RE(re[k+2*m],im[k+2*m],2*k*fstride);
+      s2_im = TW_IM(re[k+2*m],im[k+2*m],2*k*fstride);
+      s3_re = TW_RE(re[k+3*m],im[k+3*m],3*k*fstride);
+      s3_im = TW_IM(re[k+3*m],im[k+3*m],3*k*fstride);
+      s4_re = TW_RE(re[k+4*m],im[k+4*m],4*k*fstride);
+      s4_im = TW_IM(re[k+4*m],im[k+4*m],4*k*fstride);
+
+      s7_re = s1_re + s4_re;
+      s7_im = s1_im + s4_im;
+      s10_re = s1_re - s4_re;
+      s10_im = s1_im - s4_im;
+      s8_re = s2_re + s3_re;
+      s8_im = s2_im + s3_im;
+      s9_re = s2_re - s3_re;
+      s9_im = s2_im - s3_im;
+
+      re[k] = s0_re + s7_re + s8_re;
+      im[k] = s0_im + s7_im + s8_im;
+
+      s5_re = s0_re + s7_re*ya_re + s8_re*yb_re;
+      s5_im = s0_im + s7_im*ya_re + s8_im*yb_re;
+      s6_re = s10_im*ya_im + s9_im*yb_im;
+      s6_im = -s10_re*ya_im - s9_re*yb_im;
+      re[k+m] = s5_re - s6_re;
+      im[k+m] = s5_im - s6_im;
+      re[k+4*m] = s5_re + s6_re;
+      im[k+4*m] = s5_im + s6_im;
+
+      s11_re = s0_re + s7_re*yb_re + s8_re*ya_re;
+      s11_im = s0_im + s7_im*yb_re + s8_im*ya_re;
+      s12_re = -s10_im*yb_im + s9_im*ya_im;
+      s12_im = s10_re*yb_im - s9_re*ya_im;
+      re[k+2*m] = s11_re + s12_re;
+      im[k+2*m] = s11_im + s12_im;
+      re[k+3*m] = s11_re - s12_re;
+      im[k+3*m] = s11_im - s12_im;
+   }
+}
+
+
+/*
+ * Routine:	butterfly_generic
+ *
+ * Description:	Radix p butterfly for any prime p up to FFT_MAX_RADIX,
+ *		evaluated directly as a p point transform.
+ *
+ * Date:	17/10/26
+ */
+static void SCALAR_NAME(butterfly_generic)(const struct fft_plan *plan,
+   scalar *re, scalar *im, int fstride, int m, int p)
+{
+   scalar scratch_re[FFT_MAX_RADIX],scratch_im[FFT_MAX_RADIX];
+   int u,q,q1,k,twidx;
+
+   for(u=0;u<m;u++) {
+      for(q1=0,k=u;q1<p;q1++,k+=m) {
+         scratch_re[q1] = re[k];
+         scratch_im[q1] = im[k];
+      }
+
+      for(q1=0,k=u;q1<p;q1++,k+=m) {
+         twidx = 0;
+         re[k] = scratch_re[0];
+         im[k] = scratch_im[0];
+         for(q=1;q<p;q++) {
+            twidx += fstride*k;
+            if (twidx >= plan->n)
+               twidx -= plan->n;
+            re[k] += TW_RE(scratch_re[q],scratch_im[q],twidx);
+            im[k] += TW_IM(scratch_re[q],scratch_im[q],twidx);
+         }
+      }
+   }
+}
+
+
+/*
+ * Routine:	bluestein_run
+ *
+ * Description:	Transform "plan->n" values in place as a convolution
+ *		with a chirp, evaluated by power of 2 transforms of
+ *		at least 2n-1 points.
+ *
+ * Parameters:	plan	< a FFT_BLUESTEIN plan
+ *		re, im	<> real and imaginary parts of the values
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void SCALAR_NAME(bluestein_run)(const struct fft_plan *plan, scalar *re,
+   scalar *im)
+{
+   scalar *w_re,*w_im,t_re,t_im;
+   const scalar *c_re,*c_im,*ct_re,*ct_im;
+   int n,m,k;
+
+   n = plan->n;
+   m = plan->sub_plan->n;
+   w_re = plan->SCALAR_NAME(scratch_re);
+   w_im = plan->SCALAR_NAME(scratch_im);
+   c_re = plan->SCALAR_NAME(chirp_re);
+   c_im = plan->SCALAR_NAME(chirp_im);
+   ct_re = plan->SCALAR_NAME(chirp_tfm_re);
+   ct_im = plan->SCALAR_NAME(chirp_tfm_im);
+
+   /*
+    * X[k] = chirp[k] * sum(x[i]*chirp[i] * conj(chirp[k-i]))
+    */
+   for(k=0;k<n;k++) {
+      w_re[k] = re[k]*c_re[k] - im[k]*c_im[k];
+      w_im[k] = re[k]*c_im[k] + im[k]*c_re[k];
+   }
+   for(;k<m;k++) {
+      w_re[k] = 0.0;
+      w_im[k] = 0.0;
+   }
+
+   /*
+    * the inverse transform is the conjugate of the forward transform
+    * of the conjugate, divided by "m"
+    */
+   SCALAR_NAME(fft_plan_run)(plan->sub_plan,w_re,w_im);
+   for(k=0;k<m;k++) {
+      t_re = w_re[k]*ct_re[k] - w_im[k]*ct_im[k];
+      t_im = w_re[k]*ct_im[k] + w_im[k]*ct_re[k];
+      w_re[k] = t_re;
+      w_im[k] = -t_im;
+   }
+   SCALAR_NAME(fft_plan_run)(plan->sub_plan,w_re,w_im);
+
+   for(k=0;k<n;k++) {
+      t_re = w_re[k]/m;
+      t_im = -w_im[k]/m;
+      re[k] = t_re*c_re[k] - t_im*c_im[k];
+      im[k] = t_re*c_im[k] + t_im*c_re[k];
+   }
+}
@@ -0,0 +1,122 @@
+/******************************************************************
+ * Module:	moments.h
+ *
+ * Purpose:	Sums, extremes and lag products of a profile, found in
+ *		one pass over the data.
+ *
+ * Contents:	surf_moments	- the results of the pass
+ *		surf_heights	- the ISO 4287 sums of the pass
+ *		moments_heights()	- every sum of a profile in one pass
+ *		moments_heights_float()	- the same pass over floats
+ *
+ * Date:	17/10/26
+ * Modified:	17/10/26: moments_calculate() is folded into
+ *		moments_heights()
+ *****************************************************************/
+
+/*
+ * make sure of only one inclusion
+ */
+#ifndef MomentsDummy
+#define MomentsDummy
+
+/*
+ * number of independent partial sums kept by moments_heights();
+ * consecutive samples go to consecutive lanes, so the compiler can
+ * keep the lanes in one vector register
+ */
+#define MOMENTS_LANES 4
+
+/*
+ * sampling lengths in the evaluation length, over which Rz is
+ * averaged
+ */
+#define MOMENTS_LENGTHS 5
+
+
+/*
+ * Structure:	surf_moments
+ *
+ * Description:	The sums, extremes and lag products of x[0..n-1].
+ */
+struct surf_moments {
+   int n;  /* number of samples */
+   double sum;  /* sum of x[i] */
+   double sum_sq;  /* sum of x[i]^2 */
+   double sum_dev_sq;  /* sum of (x[i]-mean)^2 */
+   double sum_lag;  /* sum of x[i]*x[i-1], i = 1..n-1 */
+   double min;  /* smallest x[i] */
+   double max;  /* largest x[i] */
+};
+
+
+/*
+ * Structure:	surf_heights
+ *
+ * Description:	What one pass over a profile z[0..n-1], taken about
+ *		its mean line, finds.
+ */
+struct surf_heights {
+   int n;  /* number of samples */
+   double sum_abs;  /* sum of |z[i]| */
+   double sum_sq;  /* sum of z[i]^2 */
+   double sum_cube;  /* sum of z[i]^3 */
+   double sum_quart;  /* sum of z[i]^4 */
+   int num_slopes;  /* samples with a slope, n-6 */
+   double sum_slope_sq;  /* sum of the squared slopes per sample */
+   double sum_range;  /* sum over the sampling lengths of max-min */
+   int num_lengths;  /* sampling lengths, MOMENTS_LENGTHS or 1 */
+   int num_crossings;  /* upward crossings of the mean line */
+   double first;  /* interpolated position of the first */
+   double last;  /* and of the last */
+};
+
+
+/*
+ * Routine:	moments_heights
+ *
+ * Description:	Find in a single pass over a profile z[0..n-1] its
+ *		sums, extremes and lag products, and the sums behind
+ *		the ISO 4287 amplitude, spacing and slope parameters
+ *		about its mean line: the first four absolute moments,
+ *		the range of each of MOMENTS_LENGTHS sampling lengths,
+ *		the upward crossings of the mean line and the squared
+ *		slopes, found by the seven point formula of ISO 4287.
+ *		The sampling lengths are visited in turn and each is
+ *		swept in MOMENTS_LANES Kahan-compensated lanes, with
+ *		no branches or calls in the sweep. The squared
+ *		deviations are summed about z[0], which is close to
+ *		the mean for a levelled profile, and corrected
+ *		afterwards, so there is no cancellation.
+ *
+ * Parameters:	z	< the profile
+ *		n	< number of samples
+ *		m	> the sums, extremes and lag products
+ *		h	> the ISO 4287 sums
+ *
+ * Returns:	nothing
+ *
+ * Example:	moments_heights(ctx->data,ctx->num_data,&m,&h);
+ *		mean = m.sum/m.n;
+ *		ra = h.sum_abs/h.n;
+ *
+ * Date:	17/10/26
+ * Modified:	17/10/26: the sums of moments_calculate(), which it
+ *		replaces
+ */
+void moments_heights(const double *z, int n, struct surf_moments *m,
+   struct surf_heights *h);
+
+
+/*
+ * Routine:	moments_heights_float
+ *
+ * Description:	The pass above over samples held in float, with the
+ *		partial sums kept in float.
+ *
+ * Date:	17/10/26
+ */
+void moments_heights_float(const float *z, int n, struct surf_moments *m,
+   struct surf_heights *h);
+
+#endif
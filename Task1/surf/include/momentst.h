@@ -0,0 +1,314 @@
+/******************************************************************
+ * Module:	momentst.h
+ *
+ * Purpose:	Template of the one-pass sums of a profile, included by
+ *		moments.c once for each precision (see scalar.h). The
+ *		partial sums are kept in the precision of the samples;
+ *		the results are doubles either way.
+ *
+ * Contents:	moments_heights()	- every sum of a profile in one pass
+ *		heights_add()	- add a sample near an end to lane 0
+ *		heights_crossing()	- place a crossing of the mean line
+ *		lanes_total()	- add up the partial sums
+ *
+ * Date:	17/10/26
+ * Modified:	17/10/26: moments_calculate() is folded into
+ *		moments_heights()
+ *****************************************************************/
+
+/*
+ * Structure:	height_lanes
+ *
+ * Description:	The partial sums of moments_heights(), one of each
+ *		per lane. A crossing is kept as the index of the sample
+ *		after it, and placed once the pass is over.
+ */
+struct SCALAR_NAME(height_lanes) {
+   scalar s1[MOMENTS_LANES],c1[MOMENTS_LANES];  /* z */
+   scalar sa[MOMENTS_LANES],ca[MOMENTS_LANES];  /* |z| */
+   scalar s2[MOMENTS_LANES],c2[MOMENTS_LANES];  /* z^2 */
+   scalar s3[MOMENTS_LANES],c3[MOMENTS_LANES];  /* z^3 */
+   scalar s4[MOMENTS_LANES],c4[MOMENTS_LANES];  /* z^4 */
+   scalar sd[MOMENTS_LANES],cd[MOMENTS_LANES];  /* z - shift */
+   scalar sd2[MOMENTS_LANES],cd2[MOMENTS_LANES];  /* (z - shift)^2 */
+   scalar sl[MOMENTS_LANES],cl[MOMENTS_LANES];  /* z[i]*z[i-1] */
+   scalar sq[MOMENTS_LANES],cq[MOMENTS_LANES];  /* slope^2 */
+   scalar lo[MOMENTS_LANES],hi[MOMENTS_LANES];  /* this sampling length */
+   int first[MOMENTS_LANES],last[MOMENTS_LANES];  /* crossings, or -1 */
+   int up[MOMENTS_LANES];
+   scalar shift;  /* z[0] */
+};
+
+static void SCALAR_NAME(heights_add)(struct SCALAR_NAME(height_lanes) *l,
+   const scalar *z, int n, int i);
+static double SCALAR_NAME(heights_crossing)(const scalar *z, int i);
+static scalar SCALAR_NAME(lanes_total)(const scalar *s, const scalar *c);
+
+
+/*
+ * Routine:	moments_heights
+ *
+ * Description:	Find in a single pass over a profile z[0..n-1] its
+ *		sums, extremes and lag products, and the sums behind
+ *		the ISO 4287 amplitude, spacing and slope parameters
+ *		about its mean line: the first four absolute moments,
+ *		the range of each of MOMENTS_LENGTHS sampling lengths,
+ *		the upward crossings of the mean line and the squared
+ *		slopes, found by the seven point formula of ISO 4287.
+ *		The sampling lengths are visited in turn and each is
+ *		swept in MOMENTS_LANES Kahan-compensated lanes, in
+ *		which every sum is added to whatever the sample, so
+ *		that the sweep has neither branches nor calls. The
+ *		squared deviations are summed about z[0], which is
+ *		close to the mean for a levelled profile, and
+ *		corrected afterwards, so there is no cancellation.
+ *
+ * Parameters:	z	< the profile
+ *		n	< number of samples
+ *		m	> the sums, extremes and lag products
+ *		h	> the ISO 4287 sums
+ *
+ * Returns:	nothing
+ *
+ * Example:	moments_heights(ctx->data,ctx->num_data,&m,&h);
+ *		ra = h.sum_abs/h.n;
+ *
+ * Date:	17/10/26
+ * Modified:	17/10/26: the sums of moments_calculate() in the same
+ *		sweep
+ */
+void SCALAR_NAME(moments_heights)(const scalar *z, int n,
+   struct surf_moments *m, struct surf_heights *h)
+{
+   struct SCALAR_NAME(height_lanes) l;
+   scalar lo,hi,comp,zi,z2,d,s,dev;
+   int start,end;  /* the sampling length */
+   int inner_start,inner_end;  /* its samples with a full slope */
+   int first,last,up;
+   int i,j,k;
+
+   h->n = n;
+   h->sum_abs = h->sum_sq = h->sum_cube = h->sum_quart = 0.0;
+   h->num_slopes = n > 6 ? n-6 : 0;
+   h->sum_slope_sq = 0.0;
+   h->sum_range = 0.0;
+   h->num_lengths = n >= MOMENTS_LENGTHS ? MOMENTS_LENGTHS : 1;
+   h->num_crossings = 0;
+   h->first = h->last = 0.0;
+   m->n = n;
+   m->sum = m->sum_sq = m->sum_dev_sq = m->sum_lag = 0.0;
+   m->min = m->max = 0.0;
+   if (n <= 0)
+      return;
+
+   l.shift = z[0];
+   for(k=0;k<MOMENTS_LANES;k++) {
+      l.s1[k] = l.c1[k] = l.sa[k] = l.ca[k] = 0.0;
+      l.s2[k] = l.c2[k] = l.s3[k] = l.c3[k] = 0.0;
+      l.s4[k] = l.c4[k] = l.sd[k] = l.cd[k] = 0.0;
+      l.sd2[k] = l.cd2[k] = l.sl[k] = l.cl[k] = 0.0;
+      l.sq[k] = l.cq[k] = 0.0;
+      l.first[k] = l.last[k] = -1;
+      l.up[k] = 0;
+   }
+   m->min = m->max = z[0];
+
+   comp = 0.0;
+   for(j=0;j<h->num_lengths;j++) {
+      start = (int) ((long) j*n/h->num_lengths);
+      end = (int) ((long) (j+1)*n/h->num_lengths);
+      for(k=0;k<MOMENTS_LANES;k++)
+         l.lo[k] = l.hi[k] = z[start];
+
+      /*
+       * The samples with three neighbours either side go through the
+       * lanes, MOMENTS_LANES at a time, with nothing to test; the
+       * few near the ends of the profile go one at a time.
+       */
+      inner_start = start > 3 ? start : 3;
+      inner_end = end < n-3 ? end : n-3;
+      if (inner_end < inner_start)
+         inner_start = inner_end = end;
+      for(i=start;i<inner_start;i++)
+         SCALAR_NAME(heights_add)(&l,z,n,i);
+      for(;i+MOMENTS_LANES<=inner_end;i+=MOMENTS_LANES) {
+         for(k=0;k<MOMENTS_LANES;k++) {
+            zi = z[i+k];
+            z2 = zi*zi;
+            d = zi - l.shift;
+            s = heights_slope(z,i+k);
+            kahan_add(l.s1[k],l.c1[k],zi);
+            kahan_add(l.sa[k],l.ca[k],zi < 0.0 ? -zi : zi);
+            kahan_add(l.s2[k],l.c2[k],z2);
+            kahan_add(l.s3[k],l.c3[k],z2*zi);
+            kahan_add(l.s4[k],l.c4[k],z2*z2);
+            kahan_add(l.sd[k],l.cd[k],d);
+            kahan_add(l.sd2[k],l.cd2[k],d*d);
+            kahan_add(l.sl[k],l.cl[k],zi*z[i+k-1]);
+            kahan_add(l.sq[k],l.cq[k],s*s);
+            l.lo[k] = zi < l.lo[k] ? zi : l.lo[k];
+            l.hi[k] = zi > l.hi[k] ? zi : l.hi[k];
+            up = (z[i+k-1] < 0.0) & (zi >= 0.0);
+            l.up[k] += up;
+            l.first[k] = (up & (l.first[k] < 0)) ? i+k : l.first[k];
+            l.last[k] = up ? i+k : l.last[k];
+         }
+      }
+      for(;i<end;i++)
+         SCALAR_NAME(heights_add)(&l,z,n,i);
+
+      /*
+       * the peak to valley height of this sampling length, and the
+       * extremes of the profile
+       */
+      lo = l.lo[0];
+      hi = l.hi[0];
+      for(k=1;k<MOMENTS_LANES;k++) {
+         if (l.lo[k] < lo)
+            lo = l.lo[k];
+         if (l.hi[k] > hi)
+            hi = l.hi[k];
+      }
+      kahan_add(h->sum_range,comp,hi-lo);
+      if (lo < m->min)
+         m->min = lo;
+      if (hi > m->max)
+         m->max = hi;
+   }
+
+   /*
+    * combine the lanes
+    */
+   h->sum_abs = SCALAR_NAME(lanes_total)(l.sa,l.ca);
+   h->sum_sq = SCALAR_NAME(lanes_total)(l.s2,l.c2);
+   h->sum_cube = SCALAR_NAME(lanes_total)(l.s3,l.c3);
+   h->sum_quart = SCALAR_NAME(lanes_total)(l.s4,l.c4);
+   h->sum_slope_sq = SCALAR_NAME(lanes_total)(l.sq,l.cq);
+   first = last = -1;
+   for(k=0;k<MOMENTS_LANES;k++) {
+      if (l.up[k] == 0)
+         continue;
+      if (first < 0 || l.first[k] < first)
+         first = l.first[k];
+      if (l.last[k] > last)
+         last = l.last[k];
+      h->num_crossings += l.up[k];
+   }
+   if (h->num_crossings > 0) {
+      h->first = SCALAR_NAME(heights_crossing)(z,first);
+      h->last = SCALAR_NAME(heights_crossing)(z,last);
+   }
+
+   m->sum = SCALAR_NAME(lanes_total)(l.s1,l.c1);
+   m->sum_sq = h->sum_sq;
+   m->sum_lag = SCALAR_NAME(lanes_total)(l.sl,l.cl);
+   dev = SCALAR_NAME(lanes_total)(l.sd,l.cd);
+   m->sum_dev_sq = SCALAR_NAME(lanes_total)(l.sd2,l.cd2) - dev*dev/n;
+   if (m->sum_dev_sq < 0.0)
+      m->sum_dev_sq = 0.0;
+}
+
+
+/*
+ * Routine:	heights_add
+ *
+ * Description:	Add sample z[i], one of the few near the ends of the
+ *		profile or of a sampling length, to lane 0 of the sums
+ *		of moments_heights(); its lag product, slope and
+ *		crossing are added only if the samples they need
+ *		exist.
+ *
+ * Parameters:	l	<> the partial sums
+ *		z	< the profile
+ *		n	< number of samples
+ *		i	< the sample
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ * Modified:	17/10/26: the sums of moments_calculate(); the tests
+ *		are made here
+ */
+static void SCALAR_NAME(heights_add)(struct SCALAR_NAME(height_lanes) *l,
+   const scalar *z, int n, int i)
+{
+   scalar zi,z2,d,s;
+
+   zi = z[i];
+   z2 = zi*zi;
+   d = zi - l->shift;
+   kahan_add(l->s1[0],l->c1[0],zi);
+   kahan_add(l->sa[0],l->ca[0],zi < 0.0 ? -zi : zi);
+   kahan_add(l->s2[0],l->c2[0],z2);
+   kahan_add(l->s3[0],l->c3[0],z2*zi);
+   kahan_add(l->s4[0],l->c4[0],z2*z2);
+   kahan_add(l->sd[0],l->cd[0],d);
+   kahan_add(l->sd2[0],l->cd2[0],d*d);
+   l->lo[0] = zi < l->lo[0] ? zi : l->lo[0];
+   l->hi[0] = zi > l->hi[0] ? zi : l->hi[0];
+
+   if (i >= 3 && i < n-3) {
+      s = heights_slope(z,i);
+      kahan_add(l->sq[0],l->cq[0],s*s);
+   }
+
+   if (i > 0) {
+      kahan_add(l->sl[0],l->cl[0],zi*z[i-1]);
+      if (z[i-1] < 0.0 && zi >= 0.0) {
+         if (l->first[0] < 0 || i < l->first[0])
+            l->first[0] = i;
+         if (i > l->last[0])
+            l->last[0] = i;
+         l->up[0]++;
+      }
+   }
+}
+
+
+/*
+ * Routine:	heights_crossing
+ *
+ * Description:	Place the upward crossing of the mean line between
+ *		z[i-1] and z[i] by interpolation.
+ *
+ * Parameters:	z	< the profile
+ *		i	< the sample after the crossing
+ *
+ * Returns:	the position, in samples
+ *
+ * Date:	17/10/26
+ */
+static double SCALAR_NAME(heights_crossing)(const scalar *z, int i)
+{
+   scalar pos;
+
+   pos = i-1 + z[i-1]/(z[i-1] - z[i]);
+   return(pos);
+}
+
+
+/*
+ * Routine:	lanes_total
+ *
+ * Description:	Add up the compensated partial sums of the lanes.
+ *
+ * Parameters:	s	< the partial sums
+ *		c	< their compensations
+ *
+ * Returns:	the total
+ *
+ * Date:	17/10/26
+ */
+static scalar SCALAR_NAME(lanes_total)(const scalar *s, const scalar *c)
+{
+   scalar total,comp;
+   int k;
+
+   total = 0.0;
+   comp = 0.0;
+   for(k=0;k<MOMENTS_LANES;k++) {
+      kahan_add(total,comp,s[k]);
+      kahan_add(total,comp,-c[k]);
+   }
+   return(total - comp);
+}
@@ -0,0 +1,178 @@
+/******************************************************************
+ * Module:	online.h
+ *
+ * Purpose:	Profile statistics gathered sample by sample as the
+ *		data arrive, so that the parameters are known as soon
+ *		as the last sample is read.
+ *
+ * Contents:	online_hull	- upper or lower convex hull of the samples
+ *		surf_online	- the accumulator
+ *		online_reset()	- start a new profile
+ *		online_add()	- add one sample
+ *		online_add_block()	- add a block of samples
+ *		online_fit()	- the best-fitting (mse) line
+ *		online_params()	- parameters of the levelled profile
+ *		online_free()	- release the hulls
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+/*
+ * make sure of only one inclusion
+ */
+#ifndef OnlineDummy
+#define OnlineDummy
+
+/*
+ * number of hull points allocated at first
+ */
+#define ONLINE_HULL_START 256
+
+
+/*
+ * Structure:	online_hull
+ *
+ * Description:	The samples (i, y[i]) on the upper or lower convex hull
+ *		of those read so far. The largest (smallest) deviation
+ *		from any straight line is at one of these points.
+ */
+struct online_hull {
+   int size;
+   int max_size;
+   int *x;
+   double *y;
+};
+
+
+/*
+ * Structure:	surf_online
+ *
+ * Description:	Running statistics of the samples y[0..n-1], taken
+ *		at x = 0..n-1. The mean, variance and covariance with x
+ *		are Welford running sums; the lag-1 products are taken
+ *		about the first sample.
+ */
+struct surf_online {
+   int n;  /* samples so far */
+   int status;  /* TRUE, or ER_MEM if a hull is incomplete */
+   double mean_x;  /* running mean of x */
+   double mean_y;  /* running mean of y */
+   double m2_x;  /* sum of (x-mean_x)^2 */
+   double m2_y;  /* sum of (y-mean_y)^2 */
+   double c_xy;  /* sum of (x-mean_x)(y-mean_y) */
+   double first;  /* y[0] */
+   double last;  /* y[n-1] - y[0] */
+   double lag;  /* sum of (y[i]-y[0])(y[i-1]-y[0]), i = 1..n-1 */
+   double min;  /* smallest sample as read */
+   double max;  /* largest sample as read */
+   struct online_hull upper;
+   struct online_hull lower;
+};
+
+struct surf_params;
+
+
+/*
+ * Routine:	online_reset
+ *
+ * Description:	Start a new profile, keeping the hull memory.
+ *
+ * Parameters:	acc	<> the accumulator
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void online_reset(struct surf_online *acc);
+
+
+/*
+ * Routine:	online_add
+ *
+ * Description:	Add the next sample.
+ *
+ * Parameters:	acc	<> the accumulator
+ *		y	< the sample
+ *
+ * Returns:	TRUE	- added
+ *		ER_MEM	- no memory to extend a hull; the sums are
+ *			  still kept, but not Rp and Rv
+ *
+ * Example:	online_add(&ctx->online,ctx->data[i]);
+ *
+ * Date:	17/10/26
+ */
+int online_add(struct surf_online *acc, double y);
+
+
+/*
+ * Routine:	online_add_block
+ *
+ * Description:	Add the next "n" samples.
+ *
+ * Parameters:	acc	<> the accumulator
+ *		y	< the samples
+ *		n	< number of samples
+ *
+ * Returns:	TRUE	- added
+ *		ER_MEM	- no memory to extend a hull
+ *
+ * Date:	17/10/26
+ */
+int online_add_block(struct surf_online *acc, const double *y, int n);
+
+
+/*
+ * Routine:	online_fit
+ *
+ * Description:	The best-fitting (mean-squared error) line
+ *		y = a + b*x through the samples so far.
+ *
+ * Parameters:	acc	< the accumulator
+ *		a	> the intercept
+ *		b	> the slope
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void online_fit(const struct surf_online *acc, double *a, double *b);
+
+
+/*
+ * Routine:	online_params
+ *
+ * Description:	The parameters calc_params() would find for the
+ *		samples so far once the best-fitting line is taken off
+ *		(see remove_bias()), worked out from the running sums
+ *		and hulls alone. The residuals of the fit have zero
+ *		mean, so Rp and Rv are the largest deviations above and
+ *		below the line.
+ *
+ * Parameters:	acc	< the accumulator
+ *		y_division	< y scaling factor
+ *		params	> mean, var, rp, rv, rt, gamma0 and gamma1;
+ *			  all cleared when there are no samples
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void online_params(const struct surf_online *acc, double y_division,
+   struct surf_params *params);
+
+
+/*
+ * Routine:	online_free
+ *
+ * Description:	Release the hull memory.
+ *
+ * Parameters:	acc	<> the accumulator
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void online_free(struct surf_online *acc);
+
+#endif
@@ -0,0 +1,109 @@
+/******************************************************************
+ * Module:	parse.h
+ *
+ * Purpose:	Read numbers straight from text held in memory (a
+ *		mapped file), without copying or allocating.
+ *
+ * Contents:	parse_space()	- skip white space
+ *		parse_count()	- count the items
+ *		parse_int()	- read a decimal integer
+ *		parse_double()	- read a floating point number
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+/*
+ * make sure of only one inclusion
+ */
+#ifndef ParseDummy
+#define ParseDummy
+
+/*
+ * longest number handed on to strtod() when it cannot be read
+ * exactly by parse_double() itself
+ */
+#define PARSE_MAX_TOKEN 127
+
+
+/*
+ * Routine:	parse_space
+ *
+ * Description:	Skip the white space (as isspace() in the "C" locale)
+ *		at the start of text[0..end-1].
+ *
+ * Parameters:	text	< the text
+ *		end	< one past the last character
+ *
+ * Returns:	the first character that is not white space, or end
+ *
+ * Date:	17/10/26
+ */
+const char *parse_space(const char *text, const char *end);
+
+
+/*
+ * Routine:	parse_count
+ *
+ * Description:	Count the items, separated by white space, in
+ *		text[0..end-1].
+ *
+ * Parameters:	text	< the text
+ *		end	< one past the last character
+ *
+ * Returns:	the number of items
+ *
+ * Example:	parse_count(" 1.5 -2\n3 ",end);
+ *		return(3);
+ *
+ * Date:	17/10/26
+ */
+int parse_count(const char *text, const char *end);
+
+
+/*
+ * Routine:	parse_int
+ *
+ * Description:	Read a decimal integer, with an optional sign, that
+ *		runs up to white space or the end of the text.
+ *
+ * Parameters:	text	< the first character of the number
+ *		end	< one past the last character of the text
+ *		value	> the number
+ *
+ * Returns:	the character after the number, or NULL if the text
+ *		is not an integer or is out of range
+ *
+ * Example:	parse_int("12 3",end,&value);
+ *		value = 12, returns a pointer to " 3"
+ *
+ * Date:	17/10/26
+ */
+const char *parse_int(const char *text, const char *end, int *value);
+
+
+/*
+ * Routine:	parse_double
+ *
+ * Description:	Read a floating point number that runs up to white
+ *		space or the end of the text, rounded exactly as
+ *		strtod() rounds it. Numbers of up to 19 significant
+ *		digits whose value and power of ten are both exact
+ *		doubles are worked out directly (one correctly rounded
+ *		multiplication or division); anything else is copied
+ *		to a buffer and given to strtod().
+ *
+ * Parameters:	text	< the first character of the number
+ *		end	< one past the last character of the text
+ *		value	> the number
+ *
+ * Returns:	the character after the number, or NULL if the text
+ *		is not a number or is longer than PARSE_MAX_TOKEN
+ *
+ * Example:	parse_double("-7.719728\n",end,&value);
+ *		value = -7.719728, returns a pointer to "\n"
+ *
+ * Date:	17/10/26
+ */
+const char *parse_double(const char *text, const char *end, double *value);
+
+#endif
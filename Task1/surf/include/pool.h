@@ -0,0 +1,128 @@
+/******************************************************************
+ * Module:	pool.h
+ *
+ * Purpose:	A pool of worker threads sharing out numbered tasks by
+ *		work stealing.
+ *
+ * Contents:	pool_task_fn		- type of a task routine
+ *		pool_default_workers()	- number of processors online
+ *		pool_create()		- start the worker threads
+ *		pool_num_workers()	- number of workers in a pool
+ *		pool_run()		- run tasks 0..num_tasks-1
+ *		pool_destroy()		- stop the worker threads
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+/*
+ * make sure of only one inclusion
+ */
+#ifndef PoolDummy
+#define PoolDummy
+
+
+/*
+ * Routine type:	pool_task_fn
+ *
+ * Description:	Carry out one task. Each worker runs one task at a
+ *		time, so anything indexed by "worker" (an analysis
+ *		context, say) is used by one thread only.
+ *
+ * Parameters:	shared	< the pointer given to pool_run()
+ *		worker	< the worker running the task, 0..num_workers-1
+ *		task	< the task number, 0..num_tasks-1
+ */
+typedef void (*pool_task_fn)(void *shared, int worker, int task);
+
+
+/*
+ * Structure:	surf_pool (private to pool.c)
+ */
+struct surf_pool;
+
+
+/*
+ * Routine:	pool_default_workers
+ *
+ * Description:	The number of processors online, at least 1.
+ *
+ * Parameters:	none
+ *
+ * Returns:	the number of processors
+ *
+ * Date:	17/10/26
+ */
+int pool_default_workers();
+
+
+/*
+ * Routine:	pool_create
+ *
+ * Description:	Start a pool of "num_workers" workers. The thread
+ *		calling pool_run() is worker 0, so num_workers-1 threads
+ *		are started.
+ *
+ * Parameters:	num_workers	< number of workers, 0 for one per
+ *				  processor
+ *
+ * Returns:	the pool, or NULL if it could not be started
+ *
+ * Example:	pool = pool_create(0);
+ *
+ * Date:	17/10/26
+ */
+struct surf_pool *pool_create(int num_workers);
+
+
+/*
+ * Routine:	pool_num_workers
+ *
+ * Description:	The number of workers in a pool.
+ *
+ * Parameters:	pool	< the pool
+ *
+ * Returns:	the number of workers
+ *
+ * Date:	17/10/26
+ */
+int pool_num_workers(const struct surf_pool *pool);
+
+
+/*
+ * Routine:	pool_run
+ *
+ * Description:	Run fn(shared, worker, task) for every task from 0 to
+ *		num_tasks-1 and wait for them all to finish. Each
+ *		worker starts with an equal run of consecutive tasks;
+ *		a worker that runs out steals the back half of the
+ *		run of another.
+ *
+ * Parameters:	pool		< the pool
+ *		num_tasks	< number of tasks
+ *		fn		< the task routine
+ *		shared		< passed to every task
+ *
+ * Returns:	nothing
+ *
+ * Example:	pool_run(pool,num_files,analyse_file,&job);
+ *
+ * Date:	17/10/26
+ */
+void pool_run(struct surf_pool *pool, int num_tasks, pool_task_fn fn,
+   void *shared);
+
+
+/*
+ * Routine:	pool_destroy
+ *
+ * Description:	Stop the worker threads and release the pool.
+ *
+ * Parameters:	pool	< the pool made by pool_create()
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void pool_destroy(struct surf_pool *pool);
+
+#endif
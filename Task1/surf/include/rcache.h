@@ -0,0 +1,172 @@
+/******************************************************************
+ * Module:	rcache.h
+ *
+ * Purpose:	A cache on disk of the results of analyses, so that a
+ *		profile analysed before in the same way is not
+ *		transformed again. Each entry holds the spectrum, the
+ *		smoothed bands, the autocorrelation function and the
+ *		parameters of one profile, under a hash of its levelled
+ *		data and the settings of the analysis. The least
+ *		recently used entries are removed to keep the cache
+ *		within its size.
+ *
+ * Contents:	rcache_stats	- what the cache has done
+ *		rcache_open()	- open or make a cache directory
+ *		rcache_close()	- release a cache
+ *		rcache_fetch()	- the results of a context's data
+ *		rcache_store()	- keep the results of a context
+ *		rcache_get_stats()	- what the cache has done
+ *		rcache_print_stats()	- print what the cache has done
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+/*
+ * make sure of only one inclusion
+ */
+#ifndef RcacheDummy
+#define RcacheDummy
+
+#include <stdio.h>
+
+/*
+ * size of a cache unless another is asked for, in megabytes
+ */
+#define RCACHE_DEFAULT_MB 256
+
+/*
+ * file name extension of an entry
+ */
+#define RCACHE_EXTENSION ".rc"
+
+struct surf_context;
+
+
+/*
+ * Structure:	rcache (private to rcache.c)
+ */
+struct rcache;
+
+
+/*
+ * Structure:	rcache_stats
+ *
+ * Description:	The lookups and changes made through one rcache since
+ *		it was opened, and the size of the directory.
+ */
+struct rcache_stats {
+   long hits;  /* lookups answered by an entry */
+   long misses;  /* lookups that found none */
+   long stores;  /* entries written */
+   long evictions;  /* entries removed to keep within the size */
+   long bytes;  /* size of the entries in the directory */
+};
+
+
+/*
+ * Routine:	rcache_open
+ *
+ * Description:	Open the cache held in a directory, making the
+ *		directory if there is none. Any number of contexts, in
+ *		any number of threads, may share one cache.
+ *
+ * Parameters:	dir		< the directory
+ *		max_bytes	< the largest size of its entries
+ *
+ * Returns:	the cache, or NULL if the directory cannot be made
+ *		or memory is not available
+ *
+ * Example:	ctx->cache = rcache_open("surf.cache",256L << 20);
+ *
+ * Date:	17/10/26
+ */
+struct rcache *rcache_open(const char *dir, long max_bytes);
+
+
+/*
+ * Routine:	rcache_close
+ *
+ * Description:	Release a cache; its entries stay on disk.
+ *
+ * Parameters:	cache	< the cache, or NULL
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void rcache_close(struct rcache *cache);
+
+
+/*
+ * Routine:	rcache_fetch
+ *
+ * Description:	Look up the data of a context, as levelled (and
+ *		filtered), with its settings in the context's cache.
+ *		If they are there the spectrum, smoothed bands,
+ *		autocorrelation function and parameters are read into
+ *		the context, which is marked "cached" so that
+ *		calc_params() has nothing to do. The transform itself
+ *		is not kept. The key is left in the context for
+ *		rcache_store().
+ *
+ * Parameters:	ctx	<> the analysis context
+ *
+ * Returns:	TRUE	- the results were found
+ *		FALSE	- they were not, or the context has no cache
+ *
+ * Date:	17/10/26
+ */
+int rcache_fetch(struct surf_context *ctx);
+
+
+/*
+ * Routine:	rcache_store
+ *
+ * Description:	Keep the results of a context's data, under the key
+ *		found by rcache_fetch(), removing the least recently
+ *		used entries if the cache has grown beyond its size.
+ *		A result that cannot be written is simply not kept.
+ *
+ * Parameters:	ctx	<> the analysis context
+ *
+ * Returns:	TRUE	- kept
+ *		FALSE	- not kept, or the context has no cache
+ *
+ * Date:	17/10/26
+ */
+int rcache_store(struct surf_context *ctx);
+
+
+/*
+ * Routine:	rcache_get_stats
+ *
+ * Description:	What a cache has done since it was opened.
+ *
+ * Parameters:	cache	< the cache
+ *		stats	> the lookups, entries and size
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void rcache_get_stats(struct rcache *cache, struct rcache_stats *stats);
+
+
+/*
+ * Routine:	rcache_print_stats
+ *
+ * Description:	Print what a cache has done on one line.
+ *
+ * Parameters:	cache	< the cache
+ *		f	< where to print
+ *
+ * Returns:	nothing
+ *
+ * Example:	cache: 4 hits, 1 misses, 1 stored, 0 evicted,
+ *		  409600 bytes in surf.cache
+ *
+ * Date:	17/10/26
+ */
+void rcache_print_stats(struct rcache *cache, FILE *f);
+
+#endif
@@ -0,0 +1,32 @@
+/******************************************************************
+ * Module:	scalar.h
+ *
+ * Purpose:	The scalar type of the kernels written once for both
+ *		precisions. A kernel template (butterflyt.h, fftt.h,
+ *		mixfftt.h, fouriert.h, momentst.h) is included after
+ *		this file once without SCALAR_FLOAT, giving the double
+ *		routines under their usual names, and once with it,
+ *		giving float routines whose names end in "_float".
+ *
+ * Contents:	Definitions
+ *			scalar		- the arithmetic type
+ *			SCALAR_NAME()	- the name of a routine or field
+ *					  of this precision
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+/*
+ * No guard: each inclusion sets the type for the template that
+ * follows it.
+ */
+#undef scalar
+#undef SCALAR_NAME
+
+#ifdef SCALAR_FLOAT
+#define scalar float
+#define SCALAR_NAME(name) name##_float
+#else
+#define scalar double
+#define SCALAR_NAME(name) name
+#endif
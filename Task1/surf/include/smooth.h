@@ -0,0 +1,91 @@
+/******************************************************************
+ * Module:	smooth.h
+ *
+ * Purpose:	Smoothing of the spectral data by averaging them over
+ *		bands of frequency.
+ *
+ * Contents:	Definitions
+ *			band spacings
+ *
+ *		Declarations
+ *			smooth_spectrum()	- average the spectrum over bands
+ *			smooth_combine()	- add the bands to the saved average
+ *			smooth_clear()	- forget the saved average
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+/*
+ * make sure of only one inclusion
+ */
+#ifndef SmoothDummy
+#define SmoothDummy
+
+/*
+ * the spacing of the bands: equal widths, or widths growing in
+ * proportion to frequency
+ */
+#define SMOOTH_LINEAR 0
+#define SMOOTH_LOG 1
+
+struct surf_context;
+
+
+/*
+ * Routine:	smooth_spectrum
+ *
+ * Description:	Average the spectral data over at most SMOOTH_MAX_DATA
+ *		bands, spaced as "smooth_mode", leaving them in
+ *		"smooth". The mean (subscript 0) and any values from
+ *		"cut_num_data" up are left out. Each band holds the
+ *		first subscript it covers and the mean of the values
+ *		up to the next band. One pass over the values finds
+ *		every band.
+ *
+ * Parameters:	ctx	<> the analysis context
+ *
+ * Returns:	nothing
+ *
+ * Example:	20 linear bands of 4097 values cover subscripts 1-204,
+ *		205-409, ... 3892-4096; 20 log bands start at 1, 2, 3,
+ *		4, 5, 8, 12, ... 2702
+ *
+ * Date:	17/10/26
+ */
+void smooth_spectrum(struct surf_context *ctx);
+
+
+/*
+ * Routine:	smooth_combine
+ *
+ * Description:	Add the bands of the current profile to the running
+ *		average of the profiles combined so far in
+ *		"saved_smooth", counted by "num_combinations".
+ *
+ * Parameters:	ctx	<> the analysis context
+ *
+ * Returns:	TRUE		- added
+ *		ER_BANDS	- the bands differ from those saved
+ *
+ * Example:	for each profile: load_file(), calculate_fft(),
+ *		smooth_combine()
+ *
+ * Date:	17/10/26
+ */
+int smooth_combine(struct surf_context *ctx);
+
+
+/*
+ * Routine:	smooth_clear
+ *
+ * Description:	Start a new average of smoothed spectra.
+ *
+ * Parameters:	ctx	<> the analysis context
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void smooth_clear(struct surf_context *ctx);
+
+#endif
@@ -0,0 +1,198 @@
+/******************************************************************
+ * Module:	stats.h
+ *
+ * Purpose:	Timings of the stages of the analyses and counts of
+ *		what they processed, gathered when "--stats" is given
+ *		and printed, as text or JSON, when surf ends. Built
+ *		without SURF_STATS the macros below are empty and
+ *		nothing is gathered or even tested.
+ *
+ * Contents:	Definitions
+ *			stages, counters, formats
+ *			STATS_TIMER, STATS_START, STATS_STOP,
+ *			STATS_COUNT
+ *
+ *		Declarations
+ *			stats_enable()	- start gathering
+ *			stats_clock()	- monotonic clock
+ *			stats_time()	- add the time of a stage
+ *			stats_add()	- add to a counter
+ *			stats_print()	- print what was gathered
+ *			stats_format_name()	- format from its name
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+/*
+ * make sure of only one inclusion
+ */
+#ifndef StatsDummy
+#define StatsDummy
+
+#include <stdio.h>
+#include <stdint.h>
+
+/*
+ * the stages timed
+ */
+#define STATS_LOAD 0  /* reading a file, load_raw() */
+#define STATS_LEVEL 1  /* taking off the line or form */
+#define STATS_FILTER 2  /* the Gaussian filter */
+#define STATS_FFT 3  /* the transform of the profile */
+#define STATS_SPECTRUM 4  /* spectrum and bands from the transform */
+#define STATS_WELCH 5  /* a Welch spectrum and its bands */
+#define STATS_PARAMS 6  /* calc_params() */
+#define STATS_WRITE 7  /* formatting a batch record */
+#define STATS_NUM_STAGES 8
+
+/*
+ * the counters
+ */
+#define STATS_PROFILES 0  /* profiles read */
+#define STATS_SAMPLES 1  /* samples in them */
+#define STATS_BYTES 2  /* bytes of the files read */
+#define STATS_CACHE_HITS 3  /* results found in the cache */
+#define STATS_CACHE_MISSES 4  /* results not found there */
+#define STATS_NUM_COUNTERS 5
+
+/*
+ * formats of stats_print()
+ */
+#define STATS_TEXT 1
+#define STATS_JSON 2
+
+/*
+ * most times kept per stage for the percentiles; the totals count
+ * every call
+ */
+#define STATS_MAX_TIMES (1 << 20)
+
+/*
+ * A stage is timed by
+ *
+ *	STATS_TIMER(t);
+ *	...
+ *	STATS_START(t);
+ *	stage();
+ *	STATS_STOP(STATS_FFT,t);
+ *
+ * and something counted by STATS_COUNT(STATS_SAMPLES,n). Until
+ * stats_enable() is called each costs one test of a flag.
+ */
+#ifdef SURF_STATS
+extern int stats_enabled;
+#define STATS_TIMER(t) uint64_t t = 0
+#define STATS_START(t) ((t) = (stats_enabled == TRUE) ? stats_clock() : 0)
+#define STATS_STOP(stage,t) \
+   do { \
+      if (stats_enabled == TRUE) \
+         stats_time((stage),stats_clock()-(t)); \
+   } while (0)
+#define STATS_COUNT(counter,n) \
+   do { \
+      if (stats_enabled == TRUE) \
+         stats_add((counter),(n)); \
+   } while (0)
+#else
+#define STATS_TIMER(t)
+#define STATS_START(t) ((void) 0)
+#define STATS_STOP(stage,t) ((void) 0)
+#define STATS_COUNT(counter,n) ((void) 0)
+#endif
+
+
+/*
+ * Routine:	stats_enable
+ *
+ * Description:	Start gathering timings and counts. Called before any
+ *		worker threads are started.
+ *
+ * Parameters:	none
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void stats_enable(void);
+
+
+/*
+ * Routine:	stats_clock
+ *
+ * Description:	The monotonic clock, in nanoseconds.
+ *
+ * Parameters:	none
+ *
+ * Returns:	the time
+ *
+ * Date:	17/10/26
+ */
+uint64_t stats_clock(void);
+
+
+/*
+ * Routine:	stats_time
+ *
+ * Description:	Add one call of a stage and the time it took. Safe
+ *		from any thread.
+ *
+ * Parameters:	stage	< the stage
+ *		ns	< the time taken, in nanoseconds
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void stats_time(int stage, uint64_t ns);
+
+
+/*
+ * Routine:	stats_add
+ *
+ * Description:	Add to a counter. Safe from any thread.
+ *
+ * Parameters:	counter	< the counter
+ *		n	< the amount
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void stats_add(int counter, long n);
+
+
+/*
+ * Routine:	stats_print
+ *
+ * Description:	Print the calls, total time, share of the time and
+ *		the median, 90th and 99th percentile and longest call
+ *		of every stage that was called, and the counters, as a
+ *		table or as one JSON object.
+ *
+ * Parameters:	f	< where to print
+ *		format	< STATS_TEXT or STATS_JSON
+ *
+ * Returns:	nothing
+ *
+ * Example:	stage      calls   total ms  share    p50 us    p90 us ...
+ *		load           5     31.224  48.1%  6086.511  6513.072 ...
+ *
+ * Date:	17/10/26
+ */
+void stats_print(FILE *f, int format);
+
+
+/*
+ * Routine:	stats_format_name
+ *
+ * Description:	The format named "text" or "json".
+ *
+ * Parameters:	name	< the name
+ *
+ * Returns:	the format, or FALSE if the name is not known
+ *
+ * Date:	17/10/26
+ */
+int stats_format_name(const char *name);
+
+#endif
@@ -0,0 +1,143 @@
+/******************************************************************
+ * Module:	surf.h
+ *
+ * Purpose:	The analysis of a profile as a library (libsurf), for
+ *		programs that hold the samples in memory rather than
+ *		in a Talysurf file.
+ *
+ * Contents:	Definitions
+ *			surf_settings structure
+ *			surf_result structure
+ *
+ *		Declarations
+ *			surf_settings_default()	- the settings of surf
+ *			surf_analyze()	- analyse samples held in memory
+ *			surf_analyze_file()	- analyse a Talysurf file
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+/*
+ * make sure of only one inclusion
+ */
+#ifndef SurfDummy
+#define SurfDummy
+
+#include "global.h"
+#include "context.h"
+
+
+/*
+ * Structure:	surf_settings
+ *
+ * Description:	How a profile is analysed. The scaling factors are
+ *		only used by surf_analyze(); a Talysurf file has its
+ *		own.
+ */
+struct surf_settings {
+   int trans_mode;  /* TRANS_PADDED or TRANS_EXACT */
+   int precision;  /* PRECISION_DOUBLE or PRECISION_FLOAT */
+   int welch_length;  /* Welch segment length, 0 for one periodogram */
+   int welch_overlap;  /* samples, half a segment if negative */
+   int welch_window;  /* see welch.h */
+   int smooth_mode;  /* see smooth.h */
+   int cut_num_data;  /* spectral values smoothed, 0 for all */
+   int form;  /* form taken off the samples, see form.h */
+   double cutoff;  /* Gaussian filter cutoff, 0 for none */
+   double x_division;  /* x scaling factor */
+   double y_division;  /* y scaling factor */
+};
+
+
+/*
+ * Structure:	surf_result
+ *
+ * Description:	What an analysis found. The arrays are those of the
+ *		context, not copies, and last until it analyses another
+ *		profile or is destroyed.
+ */
+struct surf_result {
+   int num_data;
+   const double *data;  /* levelled profile, or its roughness */
+   const double *waviness;  /* NULL without a cutoff */
+   int trans_num_data;
+   struct surf_params params;
+   int spec_num_data;
+   const double *spec_data;
+   int acf_num_data;
+   const double *acf;
+   int smooth_num_data;
+   const struct smoothed *smooth;
+};
+
+
+/*
+ * Routine:	surf_settings_default
+ *
+ * Description:	The settings surf starts with: a padded transform of
+ *		the whole profile in double, in linear bands, with
+ *		samples in microns taken SAMPLE_INT apart.
+ *
+ * Parameters:	settings	> the settings
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void surf_settings_default(struct surf_settings *settings);
+
+
+/*
+ * Routine:	surf_analyze
+ *
+ * Description:	Level, transform and calculate the parameters of
+ *		"num_data" samples. The samples are read where they
+ *		are and not changed; the levelled profile is written
+ *		straight into the context's arrays and, with a
+ *		"cutoff", split into roughness and waviness (see
+ *		gauss_filter()). A context is used by one thread at a
+ *		time, but any number of contexts may be analysing at
+ *		once.
+ *
+ * Parameters:	ctx		<> the analysis context
+ *		samples		< the samples
+ *		num_data	< number of samples
+ *		settings	< how they are analysed
+ *		result		> what was found
+ *
+ * Returns:	TRUE		- successful analysis
+ *		ER_COUNT	- fewer than 2 samples
+ *		ER_MEM		- no memory
+ *
+ * Example:	surf_settings_default(&settings);
+ *		surf_analyze(ctx,samples,7500,&settings,&result);
+ *
+ * Date:	17/10/26
+ */
+int surf_analyze(struct surf_context *ctx, const double *samples,
+   int num_data, const struct surf_settings *settings,
+   struct surf_result *result);
+
+
+/*
+ * Routine:	surf_analyze_file
+ *
+ * Description:	Load, transform and calculate the parameters of a
+ *		Talysurf file, text or binary (see load_file()).
+ *
+ * Parameters:	ctx		<> the analysis context
+ *		filename	< the file
+ *		settings	< how it is analysed
+ *		result		> what was found
+ *
+ * Returns:	TRUE	- successful analysis
+ *		otherwise the error of load_file(), or ER_MEM
+ *
+ * Example:	surf_analyze_file(ctx,"data/m1g2.txt",&settings,&result);
+ *
+ * Date:	17/10/26
+ */
+int surf_analyze_file(struct surf_context *ctx, const char *filename,
+   const struct surf_settings *settings, struct surf_result *result);
+
+#endif
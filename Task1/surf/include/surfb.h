@@ -0,0 +1,171 @@
+/******************************************************************
+ * Module:	surfb.h
+ *
+ * Purpose:	The binary profile format (".surfb"): a fixed header
+ *		followed by an aligned block of samples that is copied
+ *		out of the mapped file into the data array without
+ *		parsing; int16 counts are scaled on the way.
+ *
+ * Contents:	surfb_header	- layout of the header
+ *		surfb_is_binary()	- test for the binary format
+ *		surfb_read()	- read a binary file held in memory
+ *		surfb_write()	- write a profile in the binary format
+ *		surfb_checksum()	- checksum of a block of memory
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+/*
+ * make sure of only one inclusion
+ */
+#ifndef SurfbDummy
+#define SurfbDummy
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * file name extension and the first 8 bytes of every binary file
+ * (the carriage return, line feed and ^Z show up a file that has
+ * been through a text-mode transfer)
+ */
+#define SURFB_EXTENSION ".surfb"
+#define SURFB_MAGIC "SURFB\r\n\032"
+#define SURFB_MAGIC_LEN 8
+
+#define SURFB_VERSION 1
+
+/*
+ * written in the byte order of the machine that made the file; a
+ * file from a machine of the other order is rejected
+ */
+#define SURFB_BYTE_ORDER 0x01020304
+
+/*
+ * sample types: float64 values, or int16 counts to be multiplied
+ * by "sample_scale"
+ */
+#define SURFB_FLOAT64 1
+#define SURFB_INT16 2
+
+/*
+ * alignment of the sample block within the file, and where a block
+ * written by surfb_write() starts: just after the header
+ */
+#define SURFB_ALIGN 64
+#define SURFB_DATA_OFFSET ((sizeof(struct surfb_header) + SURFB_ALIGN - 1) \
+   / SURFB_ALIGN * SURFB_ALIGN)
+
+
+/*
+ * Structure:	surfb_header
+ *
+ * Description:	The start of a binary file. The checksum is taken over
+ *		the header (with "checksum" zero) and then the sample
+ *		block.
+ */
+struct surfb_header {
+   char magic[SURFB_MAGIC_LEN];  /* SURFB_MAGIC */
+   uint32_t version;  /* SURFB_VERSION */
+   uint32_t byte_order;  /* SURFB_BYTE_ORDER */
+   int32_t mag_set;  /* magnification setting of Talysurf */
+   int32_t filter_set;  /* filter setting of Talysurf */
+   uint32_t sample_type;  /* SURFB_FLOAT64 or SURFB_INT16 */
+   uint32_t num_data;  /* number of samples */
+   uint32_t data_offset;  /* start of the samples, a multiple of
+			     SURFB_ALIGN */
+   uint32_t reserved;  /* zero */
+   double x_division;  /* x scaling factor */
+   double y_division;  /* y scaling factor */
+   double sample_scale;  /* value of one count (SURFB_INT16) */
+   uint64_t checksum;
+};
+
+struct surf_context;
+
+
+/*
+ * Routine:	surfb_is_binary
+ *
+ * Description:	Test whether a file held in memory starts with
+ *		SURFB_MAGIC.
+ *
+ * Parameters:	text	< the contents of the file
+ *		size	< its size in bytes
+ *
+ * Returns:	TRUE	- a binary file
+ *		FALSE	- anything else
+ *
+ * Date:	17/10/26
+ */
+int surfb_is_binary(const char *text, size_t size);
+
+
+/*
+ * Routine:	surfb_read
+ *
+ * Description:	Check the header and checksum of a binary file held in
+ *		memory and copy its settings, scaling factors and
+ *		samples into the context, adding the samples to its
+ *		statistics.
+ *
+ * Parameters:	ctx	<> the analysis context
+ *		text	< the contents of the file
+ *		size	< its size in bytes
+ *
+ * Returns:	TRUE	- no errors
+ *		ER_MAG	- magnification number invalid
+ *		ER_FILT	- filter setting invalid
+ *		ER_COMPAT	- not a binary file this version can read,
+ *			  or the checksum is wrong
+ *		ER_COUNT	- too few or too many samples
+ *		ER_MEM	- no memory for the samples
+ *
+ * Date:	17/10/26
+ */
+int surfb_read(struct surf_context *ctx, const char *text, size_t size);
+
+
+/*
+ * Routine:	surfb_write
+ *
+ * Description:	Write the profile held in a context (as read, before
+ *		remove_bias()) in the binary format. Int16 samples are
+ *		scaled so that the largest sample is 32767 counts; this
+ *		loses precision, float64 does not.
+ *
+ * Parameters:	ctx		< the analysis context
+ *		filename	< the file to be written
+ *		sample_type	< SURFB_FLOAT64 or SURFB_INT16
+ *
+ * Returns:	TRUE	- file written
+ *		ER_FIL	- the file could not be written
+ *		ER_MEM	- no memory for the sample block
+ *
+ * Example:	surfb_write(ctx,"data/m1g2.surfb",SURFB_FLOAT64);
+ *
+ * Date:	17/10/26
+ */
+int surfb_write(const struct surf_context *ctx, const char *filename,
+   int sample_type);
+
+
+/*
+ * Routine:	surfb_checksum
+ *
+ * Description:	Continue a 64 bit FNV-1a style checksum over a block
+ *		of memory, eight bytes at a time.
+ *
+ * Parameters:	block	< the memory
+ *		size	< its size in bytes
+ *		sum	< the checksum so far (SURFB_CHECKSUM_START to
+ *			  begin)
+ *
+ * Returns:	the checksum
+ *
+ * Date:	17/10/26
+ */
+#define SURFB_CHECKSUM_START 0xcbf29ce484222325ULL
+uint64_t surfb_checksum(const void *block, size_t size, uint64_t sum);
+
+#endif
@@ -0,0 +1,134 @@
+/******************************************************************
+ * Module:	welch.h
+ *
+ * Purpose:	Power spectrum averaged over overlapping, windowed
+ *		segments of the profile (Welch's method).
+ *
+ * Contents:	Definitions
+ *			window kinds
+ *			welch_table structure
+ *
+ *		Declarations
+ *			welch_spectrum()	- the averaged spectrum
+ *			welch_table_get()	- window table of a length
+ *			welch_table_free()	- release a window table
+ *			welch_window_name()	- window kind from its name
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+/*
+ * make sure of only one inclusion
+ */
+#ifndef WelchDummy
+#define WelchDummy
+
+/*
+ * the windows applied to each segment
+ */
+#define WELCH_HANN 0
+#define WELCH_HAMMING 1
+#define WELCH_BLACKMAN 2
+
+/*
+ * shortest segment
+ */
+#define WELCH_MIN_LENGTH 4
+
+
+/*
+ * Structure:	welch_table
+ *
+ * Description:	The values of a window over a segment of "length"
+ *		samples, and the sum of their squares. A context keeps
+ *		the table it last used, so that it is calculated once
+ *		for any number of profiles.
+ */
+struct welch_table {
+   int kind;  /* WELCH_HANN, WELCH_HAMMING or WELCH_BLACKMAN */
+   int length;  /* number of values, 0 if none yet */
+   double *w;  /* the window */
+   double sum_sq;  /* sum of w[i]^2 */
+};
+
+struct surf_context;
+
+
+/*
+ * Routine:	welch_spectrum
+ *
+ * Description:	Calculate the spectral data as the average of the
+ *		periodograms of segments of "welch_length" samples
+ *		(rounded down to an integral power of 2, and to no more
+ *		than the number of data) that overlap by
+ *		"welch_overlap" samples (half a segment if negative),
+ *		each multiplied by the window "welch_window". The
+ *		segments are transformed by the context's pool of
+ *		workers, if it has one. The values are scaled like
+ *		those of a single periodogram, so that on average they
+ *		have the same sum.
+ *
+ * Parameters:	ctx	<> the analysis context
+ *
+ * Returns:	TRUE	- successful calculation
+ *		FALSE	- no memory for the window, plan or segments
+ *
+ * Example:	ctx->welch_length = 512;
+ *		ctx->welch_overlap = 256;
+ *		welch_spectrum(ctx);
+ *
+ * Date:	17/10/26
+ */
+int welch_spectrum(struct surf_context *ctx);
+
+
+/*
+ * Routine:	welch_table_get
+ *
+ * Description:	Make sure that a table holds the window "kind" of
+ *		"length" values, calculating it only if it does not
+ *		already.
+ *
+ * Parameters:	table	<> the table
+ *		kind	< WELCH_HANN, WELCH_HAMMING or WELCH_BLACKMAN
+ *		length	< number of values
+ *
+ * Returns:	TRUE	- the table is ready
+ *		ER_MEM	- no memory for the values
+ *
+ * Date:	17/10/26
+ */
+int welch_table_get(struct welch_table *table, int kind, int length);
+
+
+/*
+ * Routine:	welch_table_free
+ *
+ * Description:	Release the values of a table.
+ *
+ * Parameters:	table	<> the table
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void welch_table_free(struct welch_table *table);
+
+
+/*
+ * Routine:	welch_window_name
+ *
+ * Description:	The window kind named "hann", "hamming" or "blackman".
+ *
+ * Parameters:	name	< the name
+ *
+ * Returns:	the kind, or FALSE if the name is not known
+ *
+ * Example:	welch_window_name("blackman");
+ *		return(WELCH_BLACKMAN);
+ *
+ * Date:	17/10/26
+ */
+int welch_window_name(const char *name);
+
+#endif
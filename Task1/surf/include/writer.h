@@ -0,0 +1,216 @@
+/******************************************************************
+ * Module:	writer.h
+ *
+ * Purpose:	Writing the results of many profiles: comma-separated
+ *		rows, JSON Lines, or a binary file of the spectra that
+ *		can be mapped into memory. Each record is formatted
+ *		into one large buffer, which is written out whole when
+ *		the next record would not fit. Numbers are written
+ *		with the fewest digits that read back exactly.
+ *
+ * Contents:	Definitions
+ *			formats, binary layout
+ *			writer_row structure
+ *
+ *		Declarations
+ *			writer_open()	- start writing results
+ *			writer_row()	- write the record of a profile
+ *			writer_sync()	- write out what is buffered
+ *			writer_close()	- finish writing results
+ *			writer_format_name()	- format from its name
+ *			writer_double()	- shortest exact text of a double
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+/*
+ * make sure of only one inclusion
+ */
+#ifndef WriterDummy
+#define WriterDummy
+
+#include <stdio.h>
+#include "global.h"
+#include "context.h"
+
+/*
+ * formats
+ */
+#define WRITER_CSV 1
+#define WRITER_JSONL 2
+#define WRITER_BINARY 3
+
+/*
+ * size of the buffer, which grows if one record needs more
+ */
+#define WRITER_BUFFER (1 << 20)
+
+/*
+ * longest text of a double from writer_double(), with its NUL
+ */
+#define WRITER_DOUBLE_LEN 32
+
+/*
+ * The binary format. Every field is little-endian whatever the
+ * machine, and every record starts on an 8-byte boundary, so that
+ * the file can be mapped and its doubles read in place.
+ *
+ * file header, WRITER_HEADER_SIZE bytes:
+ *	char magic[8]		WRITER_MAGIC
+ *	uint32 version		WRITER_VERSION
+ *	uint32 record_header	WRITER_RECORD_SIZE
+ *	uint64 reserved		zero
+ *
+ * then a record per profile, WRITER_RECORD_SIZE bytes of header:
+ *	uint32 record_size	bytes of the whole record, a multiple of 8
+ *	uint32 name_size	bytes of the name, with a NUL and padding
+ *				to a multiple of 8
+ *	int32 mag_set, filter_set, num_data, trans_num_data,
+ *	      spec_num_data, smooth_num_data
+ *	double mean, var, ra, rq, rsk, rku, rp, rv, rt, rz, rsm,
+ *	       rdq, gamma0, gamma1, c_lambda	(as surf_params)
+ *
+ * followed by the name, spec_num_data doubles of the spectrum and
+ * smooth_num_data doubles of the band means.
+ */
+#define WRITER_MAGIC "SURFSPEC"
+#define WRITER_VERSION 1
+#define WRITER_HEADER_SIZE 24
+#define WRITER_NUM_PARAMS 15
+#define WRITER_RECORD_SIZE (8 + 6*4 + WRITER_NUM_PARAMS*8)
+
+
+/*
+ * Structure:	writer (private to writer.c)
+ */
+struct writer;
+
+
+/*
+ * Structure:	writer_row
+ *
+ * Description:	What the record of one profile holds. The bands are
+ *		only written if the writer was opened for them, and
+ *		the spectrum only in the binary format.
+ */
+struct writer_row {
+   const char *filename;
+   int mag_set;
+   int filter_set;
+   int num_data;
+   int trans_num_data;
+   const struct surf_params *params;
+   int smooth_num_data;
+   const struct smoothed *smooth;
+   int spec_num_data;
+   const double *spec_data;
+};
+
+
+/*
+ * Routine:	writer_open
+ *
+ * Description:	Start writing results to a file, writing the column
+ *		names of a comma-separated file or the header of a
+ *		binary one.
+ *
+ * Parameters:	f	< the file, open for writing
+ *		format	< WRITER_CSV, WRITER_JSONL or WRITER_BINARY
+ *		bands	< TRUE to write SMOOTH_MAX_DATA bands per row
+ *
+ * Returns:	the writer, or NULL if memory is not available
+ *
+ * Example:	w = writer_open(stdout,WRITER_CSV,FALSE);
+ *
+ * Date:	17/10/26
+ */
+struct writer *writer_open(FILE *f, int format, int bands);
+
+
+/*
+ * Routine:	writer_row
+ *
+ * Description:	Add the record of one profile.
+ *
+ * Parameters:	w	<> the writer
+ *		row	< the record
+ *
+ * Returns:	TRUE	- added
+ *		ER_FIL	- the file could not be written
+ *		ER_MEM	- no memory for the record
+ *
+ * Date:	17/10/26
+ */
+int writer_row(struct writer *w, const struct writer_row *row);
+
+
+/*
+ * Routine:	writer_sync
+ *
+ * Description:	Write out the buffer and flush the file, so that the
+ *		records added so far are in it even if the program
+ *		goes no further.
+ *
+ * Parameters:	w	<> the writer
+ *
+ * Returns:	TRUE	- everything so far was written
+ *		ER_FIL	- some of it could not be
+ *
+ * Date:	17/10/26
+ */
+int writer_sync(struct writer *w);
+
+
+/*
+ * Routine:	writer_close
+ *
+ * Description:	Write out what is left in the buffer and release the
+ *		writer; the file stays open.
+ *
+ * Parameters:	w	< the writer, or NULL
+ *
+ * Returns:	TRUE	- everything was written
+ *		ER_FIL	- some of it could not be
+ *
+ * Date:	17/10/26
+ */
+int writer_close(struct writer *w);
+
+
+/*
+ * Routine:	writer_format_name
+ *
+ * Description:	The format named "csv", "jsonl" or "binary".
+ *
+ * Parameters:	name	< the name
+ *
+ * Returns:	the format, or FALSE if the name is not known
+ *
+ * Example:	writer_format_name("jsonl");
+ *		return(WRITER_JSONL);
+ *
+ * Date:	17/10/26
+ */
+int writer_format_name(const char *name);
+
+
+/*
+ * Routine:	writer_double
+ *
+ * Description:	The text of a double with the fewest significant
+ *		digits (15 to 17) that strtod() reads back as the same
+ *		double; "nan", "inf" or "-inf" if it is not finite.
+ *
+ * Parameters:	dest	> at least WRITER_DOUBLE_LEN characters
+ *		x	< the double
+ *
+ * Returns:	the number of characters written, without the NUL
+ *
+ * Example:	writer_double(dest,0.1);
+ *		dest = "0.1"
+ *
+ * Date:	17/10/26
+ */
+int writer_double(char *dest, double x);
+
+#endif
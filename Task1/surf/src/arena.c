@@ -0,0 +1,113 @@
+/******************************************************************
+ * Module:	arena.c
+ *
+ * Purpose:	One aligned block of memory carved into the arrays of
+ *		a profile, grown as longer profiles arrive.
+ *
+ * Contents:	arena_reserve()	- make room, discarding the arrays
+ *		arena_take()	- an aligned piece of the block
+ *		arena_free()	- release the block
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+#include <stdlib.h>
+
+/*
+ * global definitions
+ */
+#include "global.h"
+#include "arena.h"
+
+
+/*
+ * Routine:	arena_reserve
+ *
+ * Description:	Make sure that the block holds at least "size" bytes
+ *		and hand all of it out again from the start. A block
+ *		that is too small is replaced by one at least twice as
+ *		big, so that a run of growing profiles needs few
+ *		allocations. Anything taken before is lost.
+ *
+ * Parameters:	arena	<> the arena
+ *		size	< bytes needed, each piece rounded up to
+ *			  ARENA_ALIGN (see arena_size())
+ *
+ * Returns:	TRUE	- the block is ready
+ *		ER_MEM	- no memory; the arena is empty
+ *
+ * Date:	17/10/26
+ */
+int arena_reserve(struct surf_arena *arena, size_t size)
+{
+   void *base;
+   size_t new_size;
+
+   arena->used = 0;
+   if (size <= arena->size)
+      return(TRUE);
+
+   /*
+    * the old contents are not wanted, so the block is replaced
+    * rather than reallocated
+    */
+   new_size = 2*arena->size;
+   if (new_size < size)
+      new_size = arena_size(size);
+   arena_free(arena);
+   if (posix_memalign(&base,ARENA_ALIGN,new_size) != 0)
+      return(ER_MEM);
+   arena->base = (char *) base;
+   arena->size = new_size;
+
+   return(TRUE);
+}
+
+
+/*
+ * Routine:	arena_take
+ *
+ * Description:	The next "size" bytes of the block, starting on an
+ *		ARENA_ALIGN boundary.
+ *
+ * Parameters:	arena	<> the arena
+ *		size	< bytes wanted
+ *
+ * Returns:	the piece, or NULL if the block is used up
+ *
+ * Example:	data = (double *) arena_take(&arena,n*sizeof(double));
+ *
+ * Date:	17/10/26
+ */
+void *arena_take(struct surf_arena *arena, size_t size)
+{
+   char *piece;
+
+   size = arena_size(size);
+   if (size > arena->size - arena->used)
+      return(NULL);
+   piece = arena->base + arena->used;
+   arena->used += size;
+
+   return(piece);
+}
+
+
+/*
+ * Routine:	arena_free
+ *
+ * Description:	Release the block.
+ *
+ * Parameters:	arena	<> the arena
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void arena_free(struct surf_arena *arena)
+{
+   free(arena->base);
+   arena->base = NULL;
+   arena->size = 0;
+   arena->used = 0;
+}
@@ -0,0 +1,690 @@
+/******************************************************************
+ * Module:	batch.c
+ *
+ * Purpose:	Non-interactive analysis of many Talysurf files.
+ *
+ * Contents:	batch_run()	- analyse the files named on the command line
+ *		batch_path()	- add a file or directory to the list
+ *		batch_wanted()	- test for a data file name
+ *		batch_add()	- add a file name to the list
+ *		batch_file()	- analyse a single file
+ *		batch_write()	- write the record of one file
+ *		batch_precision()	- the precision of a name
+ *
+ * Date:	17/10/26
+ * Modified:	17/10/26: the files are analysed by a pool of worker
+ *		threads, each with its own analysis context; the rows
+ *		are still written in the order the files are named.
+ *		17/10/26: each file is analysed through the library
+ *		(see surf.h).
+ *		17/10/26: "--precision"
+ *		17/10/26: "--cache", results kept on disk
+ *		17/10/26: "--form"
+ *		17/10/26: "--format", the rows written through writer.h
+ *		17/10/26: the writing of each record is timed
+ *		17/10/26: the files are analysed a window at a time,
+ *		and the rows of each window written before the next
+ *****************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+/*
+ * global definitions
+ */
+#include "global.h"
+#include "context.h"
+
+/*
+ * declarations
+ */
+#include "batch.h"
+#include "surf.h"
+#include "pool.h"
+#include "surfb.h"
+#include "welch.h"
+#include "smooth.h"
+#include "rcache.h"
+#include "form.h"
+#include "writer.h"
+#include "stats.h"
+
+/*
+ * files per worker analysed before their rows are written, so that
+ * the results held at once do not grow with the number of files
+ */
+#define BATCH_WINDOW 16
+
+/*
+ * the files to be analysed
+ */
+struct batch_list {
+   char **name;
+   int num_names;
+   int max_names;
+};
+
+/*
+ * what the analysis of one file leaves for its row
+ */
+struct batch_result {
+   int status;  /* TRUE or the error number */
+   int mag_set;
+   int filter_set;
+   int num_data;
+   int trans_num_data;
+   struct surf_params params;
+   int smooth_num_data;
+   struct smoothed smooth[SMOOTH_MAX_DATA];
+   int spec_num_data;
+   double *spec_data;  /* a copy, kept only for the binary format */
+};
+
+/*
+ * everything shared by the workers: the files, how they are
+ * analysed, a context per worker and a result per file of the
+ * window being analysed
+ */
+struct batch_job {
+   struct batch_list *list;
+   struct surf_settings settings;
+   int format;  /* WRITER_CSV, WRITER_JSONL or WRITER_BINARY */
+   struct surf_context **ctx;
+   struct batch_result *result;
+   int first;  /* the file of the window's first task */
+};
+
+static int batch_path(struct batch_list *list, const char *path);
+static int batch_wanted(const char *name);
+static int batch_add(struct batch_list *list, const char *path,
+   const char *name);
+static void batch_file(void *shared, int worker, int task);
+static int batch_write(struct writer *w, const char *filename,
+   const struct batch_result *result);
+static int compare_names(const void *a, const void *b);
+static int batch_precision(const char *name);
+
+
+/*
+ * Routine:	batch_run
+ *
+ * Description:	Load, transform and calculate the parameters of every
+ *		file named on the command line, and of every
+ *		text or binary data file in any directory named, writing one
+ *		comma-separated row per profile. The files are shared
+ *		out among "--threads" workers (default one per
+ *		processor), BATCH_WINDOW per worker at a time, and the
+ *		rows of each such window are written out before the
+ *		next is analysed. "--cutoff" analyses the roughness left by
+ *		the Gaussian filter of that cutoff (see
+ *		gauss_filter()). "--welch" averages the spectrum over
+ *		segments of that length (see welch_spectrum()).
+ *		"--bands" or "--log-bands" adds the SMOOTH_MAX_DATA
+ *		smoothed bands of each spectrum (see smooth_spectrum()).
+ *		"--form" takes an arc or a polynomial off each profile
+ *		instead of its line (see form_remove()).
+ *		"--precision float" finds the transform, spectrum and
+ *		parameters in float, for quick screening. "--cache"
+ *		keeps the results in a directory, so that a profile
+ *		analysed before in the same way is not transformed
+ *		again; the cache is kept within "--cache-size"
+ *		megabytes (default RCACHE_DEFAULT_MB) and what it did
+ *		is reported on stderr (see rcache.h). "--format jsonl"
+ *		writes a JSON object per profile instead, and "--format
+ *		binary" the parameters and whole spectrum of each in
+ *		the binary format of writer.h. "--stats" (see main())
+ *		reports on stderr the time each stage took.
+ *
+ *		surf --batch [--exact] [--threads n] [--out results.csv]
+ *			[--format csv|jsonl|binary]
+ *			[--cache dir [--cache-size mb]]
+ *			[--form line|arc|2|3|4|5]
+ *			[--precision float|double] [--cutoff wavelength]
+ *			[--welch length [--overlap n]
+ *			 [--window hann|hamming|blackman]]
+ *			[--bands | --log-bands] [--stats[=text|json]]
+ *			path ...
+ *
+ * Parameters:	argc	< number of command line arguments
+ *		argv	< the command line arguments
+ *
+ * Returns:	TRUE	- every file analysed
+ *		ER_FIL	- no file or directory was named, or a file,
+ *			  the output or the cache could not be
+ *			  opened, or a file could not be analysed, or
+ *			  the window, form, format or precision is not
+ *			  known, or the results could not be written
+ *		ER_MEM	- no memory for the workers
+ *
+ * Example:	surf --batch data --threads 8 --out results.csv
+ *
+ * Date:	17/10/26
+ * Modified:	17/10/26: a window of files at a time
+ *		17/10/26: a path must be named
+ */
+int batch_run(int argc, char *argv[])
+{
+   FILE *out;  /* the results file */
+   struct writer *w;  /* the rows written to it */
+   char *out_name;  /* its name, NULL for the standard output */
+   char *cache_name;  /* the results cache, NULL for none */
+   long cache_mb;  /* its size in megabytes */
+   struct rcache *cache;
+   int num_threads;  /* workers asked for, 0 for one per processor */
+   int bands;  /* TRUE to write the smoothed bands */
+   struct batch_list list;
+   struct batch_job job;
+   struct surf_pool *pool;
+   const char *name;
+   int num_workers;
+   int window;  /* files analysed before their rows are written */
+   int count;  /* files in this window */
+   int num_paths;  /* files and directories named */
+   int result;
+   int i;
+
+   /*
+    * options first, so that the results file is open before any
+    * profile is analysed
+    */
+   out_name = NULL;
+   cache_name = NULL;
+   cache_mb = RCACHE_DEFAULT_MB;
+   num_threads = 0;
+   bands = FALSE;
+   surf_settings_default(&job.settings);
+   job.format = WRITER_CSV;
+   num_paths = 0;
+   for(i=1;i<argc;i++) {
+      if (strcmp(argv[i],"--out") == 0 && i+1 < argc)
+         out_name = argv[++i];
+      else if (strcmp(argv[i],"--threads") == 0 && i+1 < argc)
+         num_threads = atoi(argv[++i]);
+      else if (strcmp(argv[i],"--cache") == 0 && i+1 < argc)
+         cache_name = argv[++i];
+      else if (strcmp(argv[i],"--cache-size") == 0 && i+1 < argc)
+         cache_mb = atol(argv[++i]);
+      else if (strcmp(argv[i],"--exact") == 0)
+         job.settings.trans_mode = TRANS_EXACT;
+      else if (strcmp(argv[i],"--bands") == 0)
+         bands = TRUE;
+      else if (strcmp(argv[i],"--log-bands") == 0) {
+         bands = TRUE;
+         job.settings.smooth_mode = SMOOTH_LOG;
+      }
+      else if (strcmp(argv[i],"--cutoff") == 0 && i+1 < argc)
+         job.settings.cutoff = atof(argv[++i]);
+      else if (strcmp(argv[i],"--welch") == 0 && i+1 < argc)
+         job.settings.welch_length = atoi(argv[++i]);
+      else if (strcmp(argv[i],"--overlap") == 0 && i+1 < argc)
+         job.settings.welch_overlap = atoi(argv[++i]);
+      else if (strcmp(argv[i],"--window") == 0 && i+1 < argc) {
+         job.settings.welch_window = welch_window_name(argv[++i]);
+         if (job.settings.welch_window == FALSE) {
+            (void) fprintf(stderr,"%s: unknown window\n",argv[i]);
+            return(ER_FIL);
+         }
+      }
+      else if (strcmp(argv[i],"--format") == 0 && i+1 < argc) {
+         job.format = writer_format_name(argv[++i]);
+         if (job.format == FALSE) {
+            (void) fprintf(stderr,"%s: unknown format\n",argv[i]);
+            return(ER_FIL);
+         }
+      }
+      else if (strcmp(argv[i],"--form") == 0 && i+1 < argc) {
+         job.settings.form = form_name(argv[++i]);
+         if (job.settings.form == FALSE) {
+            (void) fprintf(stderr,"%s: unknown form\n",argv[i]);
+            return(ER_FIL);
+         }
+      }
+      else if ((strcmp(argv[i],"--precision") == 0 && i+1 < argc)
+         || strncmp(argv[i],"--precision=",12) == 0) {
+         name = argv[i][11] == '=' ? argv[i]+12 : argv[++i];
+         job.settings.precision = batch_precision(name);
+         if (job.settings.precision == FALSE) {
+            (void) fprintf(stderr,"%s: unknown precision\n",name);
+            return(ER_FIL);
+         }
+      }
+      else if (strncmp(argv[i],"--",2) != 0)
+         num_paths++;
+   }
+   if (num_paths == 0) {
+      (void) fprintf(stderr,"usage: surf --batch [options] path ...\n");
+      return(ER_FIL);
+   }
+
+   cache = NULL;
+   if (cache_name != NULL) {
+      cache = rcache_open(cache_name,cache_mb << 20);
+      if (cache == NULL) {
+         (void) fprintf(stderr,"%s: %s\n",cache_name,error_string(ER_FIL));
+         return(ER_FIL);
+      }
+   }
+
+   if (out_name == NULL)
+      out = stdout;
+   else {
+      out = fopen(out_name,job.format == WRITER_BINARY ? "wb" : "w");
+      if (out == NULL) {
+         (void) fprintf(stderr,"%s: %s\n",out_name,error_string(ER_FIL));
+         rcache_close(cache);
+         return(ER_FIL);
+      }
+   }
+
+   w = writer_open(out,job.format,bands);
+   if (w == NULL) {
+      (void) fprintf(stderr,"%s\n",error_string(ER_MEM));
+      if (out != stdout)
+         fclose(out);
+      rcache_close(cache);
+      return(ER_MEM);
+   }
+
+   /*
+    * everything that is not an option is a file or directory
+    */
+   result = TRUE;
+   list.name = NULL;
+   list.num_names = 0;
+   list.max_names = 0;
+   for(i=1;i<argc;i++) {
+      if (strcmp(argv[i],"--out") == 0 || strcmp(argv[i],"--threads") == 0
+         || strcmp(argv[i],"--cutoff") == 0
+         || strcmp(argv[i],"--welch") == 0
+         || strcmp(argv[i],"--overlap") == 0
+         || strcmp(argv[i],"--window") == 0
+         || strcmp(argv[i],"--form") == 0
+         || strcmp(argv[i],"--format") == 0
+         || strcmp(argv[i],"--precision") == 0
+         || strcmp(argv[i],"--cache") == 0
+         || strcmp(argv[i],"--cache-size") == 0)
+         i++;
+      else if (strncmp(argv[i],"--",2) != 0) {
+         if (batch_path(&list,argv[i]) != TRUE)
+            result = ER_FIL;
+      }
+   }
+
+   /*
+    * a context for each worker, and no more workers than files
+    */
+   if (num_threads < 1)
+      num_threads = pool_default_workers();
+   if (num_threads > list.num_names)
+      num_threads = list.num_names;
+   pool = NULL;
+   job.list = &list;
+   job.ctx = NULL;
+   job.result = NULL;
+   window = 0;
+   if (list.num_names > 0) {
+      pool = pool_create(num_threads);
+      if (pool != NULL) {
+         window = BATCH_WINDOW*pool_num_workers(pool);
+         if (window > list.num_names)
+            window = list.num_names;
+         job.result = (struct batch_result *)
+            calloc(window,sizeof(struct batch_result));
+         job.ctx = (struct surf_context **)
+            calloc(pool_num_workers(pool),sizeof(struct surf_context *));
+      }
+      if (job.ctx == NULL || job.result == NULL)
+         result = ER_MEM;
+      else {
+         num_workers = pool_num_workers(pool);
+         for(i=0;i<num_workers;i++) {
+            job.ctx[i] = context_create();
+            if (job.ctx[i] == NULL) {
+               result = ER_MEM;
+               break;
+            }
+            job.ctx[i]->cache = cache;
+         }
+      }
+   }
+
+   if (result == ER_MEM)
+      (void) fprintf(stderr,"%s\n",error_string(ER_MEM));
+   else {
+      /*
+       * the rows of each window, in the order the files were named,
+       * are written before the next window is analysed
+       */
+      for(job.first=0;job.first<list.num_names;job.first+=window) {
+         count = list.num_names - job.first;
+         if (count > window)
+            count = window;
+         pool_run(pool,count,batch_file,&job);
+         for(i=0;i<count;i++) {
+            if (batch_write(w,list.name[job.first+i],&job.result[i])
+               != TRUE)
+               result = ER_FIL;
+            free(job.result[i].spec_data);
+            job.result[i].spec_data = NULL;
+         }
+         if (writer_sync(w) != TRUE)
+            break;
+      }
+   }
+   if (writer_close(w) != TRUE) {
+      (void) fprintf(stderr,"%s\n",error_string(ER_FIL));
+      result = ER_FIL;
+   }
+
+   if (job.ctx != NULL) {
+      for(i=0;i<pool_num_workers(pool);i++)
+         context_destroy(job.ctx[i]);
+      free(job.ctx);
+   }
+   pool_destroy(pool);
+   free(job.result);
+   for(i=0;i<list.num_names;i++)
+      free(list.name[i]);
+   free(list.name);
+
+   if (out != stdout)
+      fclose(out);
+
+   if (cache != NULL) {
+      rcache_print_stats(cache,stderr);
+      rcache_close(cache);
+   }
+
+   return(result);
+}
+
+
+/*
+ * Routine:	batch_path
+ *
+ * Description:	Add a file, or every data file (see batch_wanted()) in
+ *		a directory in name order, to the list to be analysed.
+ *
+ * Parameters:	list	<> the files to be analysed
+ *		path	< the file or directory
+ *
+ * Returns:	TRUE	- added
+ *		ER_FIL	- the directory could not be read
+ *		ER_MEM	- no memory for the list
+ *
+ * Date:	17/10/26
+ */
+static int batch_path(struct batch_list *list, const char *path)
+{
+   struct stat info;
+   DIR *dir;
+   struct dirent *entry;
+   int first;  /* the first name from this directory */
+   int result;
+
+   if (stat(path,&info) != 0 || !S_ISDIR(info.st_mode))
+      return(batch_add(list,NULL,path));
+
+   dir = opendir(path);
+   if (dir == NULL) {
+      (void) fprintf(stderr,"%s: %s\n",path,error_string(ER_FIL));
+      return(ER_FIL);
+   }
+
+   /*
+    * sort the names, so that the rows come out in a repeatable
+    * order
+    */
+   result = TRUE;
+   first = list->num_names;
+   while ((entry = readdir(dir)) != NULL) {
+      if (batch_wanted(entry->d_name) != TRUE)
+         continue;
+
+      result = batch_add(list,path,entry->d_name);
+      if (result != TRUE)
+         break;
+   }
+   closedir(dir);
+
+   qsort(list->name+first,list->num_names-first,sizeof(char *),
+      compare_names);
+
+   return(result);
+}
+
+
+/*
+ * Routine:	batch_wanted
+ *
+ * Description:	Test whether a name found in a directory is that of a
+ *		text (BATCH_EXTENSION) or binary (SURFB_EXTENSION) data
+ *		file.
+ *
+ * Parameters:	name	< the file name
+ *
+ * Returns:	TRUE	- a data file
+ *		FALSE	- anything else
+ *
+ * Date:	17/10/26
+ */
+static int batch_wanted(const char *name)
+{
+   static const char *extension[] = {BATCH_EXTENSION, SURFB_EXTENSION};
+   size_t len,ext_len;
+   int i;
+
+   len = strlen(name);
+   for(i=0;i<(int) (sizeof(extension)/sizeof(extension[0]));i++) {
+      ext_len = strlen(extension[i]);
+      if (len > ext_len && strcmp(name+len-ext_len,extension[i]) == 0)
+         return(TRUE);
+   }
+   return(FALSE);
+}
+
+
+/*
+ * Routine:	batch_add
+ *
+ * Description:	Add a file name to the list to be analysed. Slashes
+ *		at the end of the directory are dropped, so that there
+ *		is one between it and the name.
+ *
+ * Parameters:	list	<> the files to be analysed
+ *		path	< the directory holding the file, or NULL
+ *		name	< the file name
+ *
+ * Returns:	TRUE	- added
+ *		ER_MEM	- no memory for the list
+ *
+ * Date:	17/10/26
+ *
+ * Modified:	17/10/26: one slash after the directory
+ */
+static int batch_add(struct batch_list *list, const char *path,
+   const char *name)
+{
+   char **names;
+   char *filename;
+   size_t len;
+
+   if (list->num_names == list->max_names) {
+      names = (char **) realloc(list->name,
+         (2*list->max_names + 16)*sizeof(char *));
+      if (names == NULL) {
+         (void) fprintf(stderr,"%s\n",error_string(ER_MEM));
+         return(ER_MEM);
+      }
+      list->name = names;
+      list->max_names = 2*list->max_names + 16;
+   }
+
+   len = 0;
+   if (path != NULL) {
+      len = strlen(path);
+      while (len > 0 && path[len-1] == '/')
+         len--;
+   }
+   filename = (char *) malloc(len + 1 + strlen(name) + 1);
+   if (filename == NULL) {
+      (void) fprintf(stderr,"%s\n",error_string(ER_MEM));
+      return(ER_MEM);
+   }
+   if (path == NULL)
+      (void) strcpy(filename,name);
+   else
+      (void) sprintf(filename,"%.*s/%s",(int) len,path,name);
+   list->name[list->num_names++] = filename;
+
+   return(TRUE);
+}
+
+
+/*
+ * Routine:	batch_file
+ *
+ * Description:	Analyse one file (see surf_analyze_file()), run by a
+ *		pool worker. The worker's context, with its arrays and
+ *		cached transform plans, is reused from one file to the
+ *		next, so what the row needs is copied out of it.
+ *
+ * Parameters:	shared	< the batch_job
+ *		worker	< the worker, selecting the context
+ *		task	< the file, an index into the window
+ *
+ * Returns:	nothing; the result of the file is set
+ *
+ * Date:	17/10/26
+ * Modified:	17/10/26: the tasks are those of a window
+ */
+static void batch_file(void *shared, int worker, int task)
+{
+   struct batch_job *job;
+   struct surf_context *ctx;
+   struct batch_result *result;
+   struct surf_result found;
+   int i;
+
+   job = (struct batch_job *) shared;
+   ctx = job->ctx[worker];
+   result = &job->result[task];
+
+   result->status = surf_analyze_file(ctx,
+      job->list->name[job->first+task],&job->settings,&found);
+   if (result->status != TRUE)
+      return;
+
+   result->mag_set = ctx->mag_set;
+   result->filter_set = ctx->filter_set;
+   result->num_data = found.num_data;
+   result->trans_num_data = found.trans_num_data;
+   result->params = found.params;
+   result->smooth_num_data = found.smooth_num_data;
+   for(i=0;i<found.smooth_num_data;i++)
+      result->smooth[i] = found.smooth[i];
+
+   /*
+    * the spectrum outlives the context only if it is to be written
+    */
+   result->spec_num_data = 0;
+   if (job->format == WRITER_BINARY && found.spec_num_data > 0) {
+      result->spec_data = (double *)
+         malloc(found.spec_num_data*sizeof(double));
+      if (result->spec_data == NULL) {
+         result->status = ER_MEM;
+         return;
+      }
+      memcpy(result->spec_data,found.spec_data,
+         found.spec_num_data*sizeof(double));
+      result->spec_num_data = found.spec_num_data;
+   }
+}
+
+
+/*
+ * Routine:	batch_write
+ *
+ * Description:	Write the record of one file, or report its error on
+ *		stderr. A profile with fewer than SMOOTH_MAX_DATA
+ *		bands leaves the last band columns empty.
+ *
+ * Parameters:	w		<> the results writer
+ *		filename	< the Talysurf file
+ *		result		< what its analysis left
+ *
+ * Returns:	TRUE	- written
+ *		otherwise the error of the analysis or of writer_row()
+ *
+ * Date:	17/10/26
+ * Modified:	17/10/26: through writer_row()
+ *		17/10/26: timed
+ */
+static int batch_write(struct writer *w, const char *filename,
+   const struct batch_result *result)
+{
+   struct writer_row row;
+   int status;
+   STATS_TIMER(start);
+
+   if (result->status != TRUE) {
+      (void) fprintf(stderr,"%s: %s\n",filename,
+         error_string(result->status));
+      return(result->status);
+   }
+
+   row.filename = filename;
+   row.mag_set = result->mag_set;
+   row.filter_set = result->filter_set;
+   row.num_data = result->num_data;
+   row.trans_num_data = result->trans_num_data;
+   row.params = &result->params;
+   row.smooth_num_data = result->smooth_num_data;
+   row.smooth = result->smooth;
+   row.spec_num_data = result->spec_num_data;
+   row.spec_data = result->spec_data;
+   STATS_START(start);
+   status = writer_row(w,&row);
+   STATS_STOP(STATS_WRITE,start);
+   if (status != TRUE)
+      (void) fprintf(stderr,"%s: %s\n",filename,error_string(status));
+   return(status);
+}
+
+
+/*
+ * Routine:	compare_names
+ *
+ * Description:	qsort() comparison of two file names.
+ *
+ * Date:	17/10/26
+ */
+static int compare_names(const void *a, const void *b)
+{
+   return(strcmp(*(char * const *) a,*(char * const *) b));
+}
+
+
+/*
+ * Routine:	batch_precision
+ *
+ * Description:	The precision named on the command line.
+ *
+ * Parameters:	name	< "float" or "double"
+ *
+ * Returns:	PRECISION_FLOAT or PRECISION_DOUBLE
+ *		FALSE	- not a precision
+ *
+ * Date:	17/10/26
+ */
+static int batch_precision(const char *name)
+{
+   if (strcmp(name,"float") == 0)
+      return(PRECISION_FLOAT);
+   if (strcmp(name,"double") == 0)
+      return(PRECISION_DOUBLE);
+   return(FALSE);
+}
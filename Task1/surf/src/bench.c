@@ -0,0 +1,594 @@
+/******************************************************************
+ * Module:	bench.c
+ *
+ * Purpose:	Repeatable timings of the stages of an analysis, for
+ *		following the speed of surf from one release to the
+ *		next.
+ *
+ * Contents:	main		- time every stage at every size
+ *		bench_run	- time one stage at one size
+ *		bench_profile	- the synthetic profile of a size
+ *		bench_write	- write the profile as a Talysurf file
+ *		stage_*		- the stages timed
+ *		clock_ns	- a monotonic clock
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * global definitions
+ */
+#include "global.h"
+#include "context.h"
+
+/*
+ * declarations
+ */
+#include "load.h"
+#include "fft.h"
+#include "fourier.h"
+#include "maths.h"
+#include "online.h"
+#include "surfb.h"
+
+/*
+ * Timings are taken BENCH_REPEAT times (unless "--repeat" is given),
+ * each over enough calls to last at least BENCH_MIN_NS.
+ */
+#define BENCH_REPEAT 10
+#define BENCH_MIN_NS 20000000.0
+
+/*
+ * Rates no stage can reach on any machine: a timing faster than
+ * BENCH_MIN_NS_PER_SAMPLE or BENCH_MAX_GFLOPS means the calls did
+ * not do the work, and the run fails with BENCH_INVALID.
+ */
+#define BENCH_MIN_NS_PER_SAMPLE 0.05
+#define BENCH_MAX_GFLOPS 1000.0
+#define BENCH_INVALID (MAX_ERRORS + 1)
+
+/*
+ * the traverses of the Talysurf filters, then longer synthetic
+ * profiles
+ */
+static const int bench_sizes[] = {FILTER_J_SAMPLES, FILTER_K_SAMPLES,
+   FILTER_L_SAMPLES, 16384, 65536, 262144, 1048576};
+
+/*
+ * Structure:	bench_state
+ *
+ * Description:	Everything a stage works on: the context, the profile
+ *		as generated and as packed for the transform, and the
+ *		files it is loaded from.
+ */
+struct bench_state {
+   struct surf_context *ctx;
+   double *profile;
+   double *packed_re;
+   double *packed_im;
+   char *text_name;
+   char *binary_name;
+};
+
+/*
+ * Structure:	bench_stage
+ *
+ * Description:	A stage to be timed, its nominal number of floating
+ *		point operations for "n" samples transformed at
+ *		length "t", from which GFLOP/s are reported, and, for
+ *		a stage that sets the parameters, a test that a call
+ *		really set them.
+ */
+struct bench_stage {
+   const char *name;
+   int (*run)(struct bench_state *state);
+   double (*flops)(int n, int t);
+   int (*done)(struct bench_state *state);
+};
+
+static int stage_fft(struct bench_state *state);
+static int stage_spectrum(struct bench_state *state);
+static int stage_remove_bias(struct bench_state *state);
+static int stage_calc_params(struct bench_state *state);
+static int stage_load_text(struct bench_state *state);
+static int stage_load_binary(struct bench_state *state);
+static double flops_fft(int n, int t);
+static double flops_spectrum(int n, int t);
+static double flops_remove_bias(int n, int t);
+static double flops_calc_params(int n, int t);
+static double flops_load(int n, int t);
+static int done_calc_params(struct bench_state *state);
+static void bench_poison(struct surf_params *params);
+static int bench_run(FILE *out, const struct bench_stage *stage,
+   struct bench_state *state, int repeat, int first);
+static void bench_profile(double *x, int n);
+static int bench_write(const char *name, const double *x, int n);
+static double clock_ns();
+
+static const struct bench_stage bench_stages[] = {
+   {"fft", stage_fft, flops_fft, NULL},
+   {"copy_data+calculate_spectrum", stage_spectrum, flops_spectrum, NULL},
+   {"remove_bias", stage_remove_bias, flops_remove_bias, NULL},
+   {"calc_params", stage_calc_params, flops_calc_params, done_calc_params},
+   {"load_text", stage_load_text, flops_load, NULL},
+   {"load_binary", stage_load_binary, flops_load, NULL}};
+
+
+/*
+ * Routine:	main
+ *
+ * Description:	Time each stage at each size, writing the results as
+ *		JSON and a summary line per result on stderr. Each
+ *		size is loaded from a Talysurf file of synthetic
+ *		samples first, so that every stage starts from what
+ *		the one before it would leave.
+ *
+ *		bench [--repeat n] [--out results.json]
+ *
+ * Parameters:	argc	< number of command line arguments
+ *		argv	< the command line arguments
+ *
+ * Returns:	TRUE		- every stage timed
+ *		BENCH_INVALID	- a stage did no work, or was timed
+ *				  impossibly fast
+ *		positive integer	- the first error
+ *
+ * Example:	bench --out bench.json
+ *
+ * Date:	17/10/26
+ */
+int main(int argc, char *argv[])
+{
+   struct bench_state state;
+   FILE *out;
+   char *out_name;
+   char text_name[] = "/tmp/surfbenchXXXXXX";
+   char binary_name[sizeof(text_name) + sizeof(SURFB_EXTENSION)];
+   int repeat,n,t,fd;
+   int result,first;
+   int i,s;
+
+   out_name = NULL;
+   repeat = BENCH_REPEAT;
+   for(i=1;i<argc;i++) {
+      if (strcmp(argv[i],"--out") == 0 && i+1 < argc)
+         out_name = argv[++i];
+      else if (strcmp(argv[i],"--repeat") == 0 && i+1 < argc)
+         repeat = atoi(argv[++i]);
+   }
+   if (repeat < 2)
+      repeat = 2;
+
+   fd = mkstemp(text_name);
+   if (fd < 0) {
+      (void) fprintf(stderr,"%s\n",error_string(ER_FIL));
+      return(ER_FIL);
+   }
+   close(fd);
+   (void) sprintf(binary_name,"%s%s",text_name,SURFB_EXTENSION);
+   state.text_name = text_name;
+   state.binary_name = binary_name;
+
+   if (out_name == NULL)
+      out = stdout;
+   else {
+      out = fopen(out_name,"w");
+      if (out == NULL) {
+         (void) fprintf(stderr,"%s: %s\n",out_name,error_string(ER_FIL));
+         remove(text_name);
+         return(ER_FIL);
+      }
+   }
+
+   (void) fprintf(out,"{\n  \"repeat\": %d,\n  \"results\": [",repeat);
+   result = TRUE;
+   first = TRUE;
+   state.ctx = context_create();
+   if (state.ctx == NULL)
+      result = ER_MEM;
+   for(s=0;result == TRUE
+      && s<(int) (sizeof(bench_sizes)/sizeof(bench_sizes[0]));s++) {
+      n = bench_sizes[s];
+      t = 2;
+      while (t < n)
+         t = 2*t;
+      state.profile = (double *) malloc(n*sizeof(double));
+      state.packed_re = (double *) malloc((t/2+1)*sizeof(double));
+      state.packed_im = (double *) malloc((t/2+1)*sizeof(double));
+      if (state.profile == NULL || state.packed_re == NULL
+         || state.packed_im == NULL)
+         result = ER_MEM;
+
+      /*
+       * the files of this size, loaded once to fill the context, and
+       * the packed profile the transform starts from
+       */
+      if (result == TRUE) {
+         bench_profile(state.profile,n);
+         result = bench_write(text_name,state.profile,n);
+      }
+      if (result == TRUE)
+         result = load_raw(state.ctx,text_name);
+      if (result == TRUE)
+         result = surfb_write(state.ctx,binary_name,SURFB_FLOAT64);
+      if (result == TRUE)
+         result = load_file(state.ctx,text_name);
+      if (result == TRUE)
+         result = stage_spectrum(&state);
+
+      for(i=0;result == TRUE
+         && i<(int) (sizeof(bench_stages)/sizeof(bench_stages[0]));i++) {
+         result = bench_run(out,&bench_stages[i],&state,repeat,first);
+         first = FALSE;
+      }
+
+      free(state.profile);
+      free(state.packed_re);
+      free(state.packed_im);
+   }
+   (void) fprintf(out,"\n  ]\n}\n");
+
+   if (result != TRUE && result != BENCH_INVALID)
+      (void) fprintf(stderr,"%s\n",error_string(result));
+   if (state.ctx != NULL)
+      context_destroy(state.ctx);
+   remove(text_name);
+   remove(binary_name);
+   if (out != stdout)
+      fclose(out);
+
+   return(result);
+}
+
+
+/*
+ * Routine:	bench_run
+ *
+ * Description:	Time one stage: once to warm the caches and plans,
+ *		then enough calls to last BENCH_MIN_NS, "repeat"
+ *		times over. The mean and standard deviation of the
+ *		nanoseconds per sample and of the GFLOP/s are written
+ *		as one JSON object. The parameters are poisoned before
+ *		the first call of a stage that sets them, which must
+ *		then have set them, and no timing may be faster than
+ *		BENCH_MIN_NS_PER_SAMPLE or BENCH_MAX_GFLOPS.
+ *
+ * Parameters:	out	< the results file
+ *		stage	< the stage
+ *		state	<> what it works on
+ *		repeat	< number of timings
+ *		first	< TRUE for the first object of the list
+ *
+ * Returns:	TRUE		- timed
+ *		BENCH_INVALID	- no work done, or an impossible rate
+ *		otherwise the error of the stage
+ *
+ * Date:	17/10/26
+ *
+ * Modified:	17/10/26: the work and the rates checked
+ */
+static int bench_run(FILE *out, const struct bench_stage *stage,
+   struct bench_state *state, int repeat, int first)
+{
+   double start,elapsed,flops;
+   double ns,ns_sum,ns_sq,gf,gf_sum,gf_sq;
+   double ns_mean,gf_mean;
+   int calls,n,t;
+   int result;
+   int i,r;
+
+   if (stage->done != NULL)
+      bench_poison(&state->ctx->params);
+   result = stage->run(state);
+   if (result != TRUE)
+      return(result);
+   n = state->ctx->num_data;
+   t = state->ctx->trans_num_data;
+   flops = stage->flops(n,t);
+   if (stage->done != NULL && stage->done(state) != TRUE) {
+      (void) fprintf(stderr,"%s %d: the parameters were not calculated\n",
+         stage->name,n);
+      return(BENCH_INVALID);
+   }
+
+   /*
+    * calls per timing
+    */
+   calls = 1;
+   for(;;) {
+      start = clock_ns();
+      for(i=0;i<calls;i++)
+         (void) stage->run(state);
+      elapsed = clock_ns() - start;
+      if (elapsed >= BENCH_MIN_NS || calls >= 1 << 24)
+         break;
+      calls = elapsed > 0.0 && BENCH_MIN_NS/elapsed < 16.0
+         ? (int) (calls*1.25*BENCH_MIN_NS/elapsed) + 1 : 16*calls;
+   }
+
+   ns_sum = ns_sq = gf_sum = gf_sq = 0.0;
+   for(r=0;r<repeat;r++) {
+      start = clock_ns();
+      for(i=0;i<calls;i++)
+         (void) stage->run(state);
+      elapsed = (clock_ns() - start)/calls;
+      if (elapsed <= 0.0 || elapsed/n < BENCH_MIN_NS_PER_SAMPLE
+         || flops/elapsed > BENCH_MAX_GFLOPS) {
+         (void) fprintf(stderr,"%s %d: %.3g ns per call cannot be right\n",
+            stage->name,n,elapsed);
+         return(BENCH_INVALID);
+      }
+      ns = elapsed/n;
+      gf = flops/elapsed;
+      ns_sum += ns;
+      ns_sq += ns*ns;
+      gf_sum += gf;
+      gf_sq += gf*gf;
+   }
+   ns_mean = ns_sum/repeat;
+   gf_mean = gf_sum/repeat;
+
+   (void) fprintf(out,"%s\n    {\"stage\": \"%s\", \"num_data\": %d, "
+      "\"trans_num_data\": %d, \"calls\": %d, \"flops\": %.0f,\n"
+      "     \"ns_per_sample\": %.6g, \"ns_per_sample_sd\": %.6g, "
+      "\"gflops\": %.6g, \"gflops_sd\": %.6g}",
+      first == TRUE ? "" : ",",stage->name,n,t,calls,flops,
+      ns_mean,sqrt(fmax(ns_sq/repeat - ns_mean*ns_mean,0.0)),
+      gf_mean,sqrt(fmax(gf_sq/repeat - gf_mean*gf_mean,0.0)));
+   (void) fprintf(stderr,"%-30s %8d %10.3f ns/sample %8.3f GFLOP/s\n",
+      stage->name,n,ns_mean,gf_mean);
+
+   return(TRUE);
+}
+
+
+/*
+ * Routines:	stage_*
+ *
+ * Description:	The stages timed. Each leaves the context as it found
+ *		it, so that it can be called over and over: the
+ *		transform starts again from the packed profile, and
+ *		remove_bias() from the profile as read.
+ *
+ * Parameters:	state	<> what the stage works on
+ *
+ * Returns:	TRUE, or the error of the stage
+ *
+ * Date:	17/10/26
+ */
+static int stage_fft(struct bench_state *state)
+{
+   struct surf_context *ctx;
+
+   ctx = state->ctx;
+   (void) memcpy(ctx->trans_re,state->packed_re,
+      (ctx->trans_num_data/2)*sizeof(double));
+   (void) memcpy(ctx->trans_im,state->packed_im,
+      (ctx->trans_num_data/2)*sizeof(double));
+   return(fft(ctx) == TRUE ? TRUE : ctx->error_number);
+}
+
+static int stage_spectrum(struct bench_state *state)
+{
+   struct surf_context *ctx;
+
+   ctx = state->ctx;
+   copy_data(ctx);
+   (void) memcpy(state->packed_re,ctx->trans_re,
+      (ctx->trans_num_data/2)*sizeof(double));
+   (void) memcpy(state->packed_im,ctx->trans_im,
+      (ctx->trans_num_data/2)*sizeof(double));
+   calculate_spectrum(ctx);
+   return(TRUE);
+}
+
+static int stage_remove_bias(struct bench_state *state)
+{
+   struct surf_context *ctx;
+
+   ctx = state->ctx;
+   (void) memcpy(ctx->data,state->profile,ctx->num_data*sizeof(double));
+   online_reset(&ctx->online);
+   remove_bias(ctx);
+   return(TRUE);
+}
+
+static int stage_calc_params(struct bench_state *state)
+{
+   return(calc_params(state->ctx) == TRUE ? TRUE : state->ctx->error_number);
+}
+
+static int stage_load_text(struct bench_state *state)
+{
+   return(load_file(state->ctx,state->text_name));
+}
+
+static int stage_load_binary(struct bench_state *state)
+{
+   return(load_file(state->ctx,state->binary_name));
+}
+
+
+/*
+ * Routines:	flops_*
+ *
+ * Description:	Nominal floating point operations of the stages for
+ *		"n" samples transformed at length "t": 5/2 t log2 t for
+ *		a real transform, 4 per spectral value, about 10 per
+ *		sample for a line fit and its removal, and, for the
+ *		parameters, the autocorrelation transforms at twice the
+ *		length and about 30 per sample for the sums. Loading is
+ *		counted as one operation per sample.
+ *
+ * Date:	17/10/26
+ */
+static double flops_fft(int n, int t)
+{
+   (void) n;
+   return(2.5*t*log2((double) t));
+}
+
+static double flops_spectrum(int n, int t)
+{
+   (void) n;
+   return(4.0*(t/2+1));
+}
+
+static double flops_remove_bias(int n, int t)
+{
+   (void) t;
+   return(10.0*n);
+}
+
+static double flops_calc_params(int n, int t)
+{
+   double length;
+
+   (void) t;
+   length = 2;
+   while (length < 2*n)
+      length = 2*length;
+   return(2*2.5*length*log2(length) + 30.0*n);
+}
+
+static double flops_load(int n, int t)
+{
+   (void) t;
+   return((double) n);
+}
+
+
+/*
+ * Routine:	done_calc_params
+ *
+ * Description:	Whether calc_params() calculated the parameters,
+ *		rather than finding them in the results cache or not
+ *		running at all: they must no longer be the poison of
+ *		bench_poison().
+ *
+ * Parameters:	state	< what the stage worked on
+ *
+ * Returns:	TRUE or FALSE
+ *
+ * Date:	17/10/26
+ */
+static int done_calc_params(struct bench_state *state)
+{
+   struct surf_params *params;
+
+   params = &state->ctx->params;
+   if (state->ctx->cached != FALSE || isnan(params->mean)
+      || isnan(params->rq) || isnan(params->rdq)
+      || isnan(params->gamma0) || isnan(params->c_lambda))
+      return(FALSE);
+   return(TRUE);
+}
+
+
+/*
+ * Routine:	bench_poison
+ *
+ * Description:	Set every parameter to NaN, which no calculation
+ *		leaves there.
+ *
+ * Parameters:	params	> the parameters
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+static void bench_poison(struct surf_params *params)
+{
+   double *p;
+   int i;
+
+   p = (double *) params;
+   for(i=0;i<(int) (sizeof(*params)/sizeof(double));i++)
+      p[i] = NAN;
+}
+
+
+/*
+ * Routine:	bench_profile
+ *
+ * Description:	A repeatable synthetic profile: a tilt, two waves and
+ *		uniform noise from a fixed linear congruential sequence,
+ *		in counts that fit the Talysurf range.
+ *
+ * Parameters:	x	> the samples
+ *		n	< number of samples
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+static void bench_profile(double *x, int n)
+{
+   unsigned long seed;
+   int i;
+
+   seed = 12345;
+   for(i=0;i<n;i++) {
+      seed = (seed*1103515245 + 12345) & 0x7fffffff;
+      x[i] = 1e-3*i + 80.0*sin(TWO_PI*i/800.0) + 20.0*sin(TWO_PI*i/37.0)
+         + 40.0*((double) seed/0x7fffffff - 0.5);
+   }
+}
+
+
+/*
+ * Routine:	bench_write
+ *
+ * Description:	Write a profile as a Talysurf text file of a traverse
+ *		of any length (FILTER_FREE) at magnification 3.
+ *
+ * Parameters:	name	< the file
+ *		x	< the samples
+ *		n	< number of samples
+ *
+ * Returns:	TRUE	- written
+ *		ER_FIL	- the file could not be written
+ *
+ * Date:	17/10/26
+ */
+static int bench_write(const char *name, const double *x, int n)
+{
+   FILE *fp;
+   int i;
+
+   fp = fopen(name,"w");
+   if (fp == NULL)
+      return(ER_FIL);
+   (void) fprintf(fp,"3\n%d\n",FILTER_FREE);
+   for(i=0;i<n;i++)
+      (void) fprintf(fp,"%.6f\n",x[i]);
+   if (fclose(fp) != 0)
+      return(ER_FIL);
+   return(TRUE);
+}
+
+
+/*
+ * Routine:	clock_ns
+ *
+ * Description:	The time in nanoseconds on a clock that is never set
+ *		back.
+ *
+ * Returns:	the time
+ *
+ * Date:	17/10/26
+ */
+static double clock_ns()
+{
+   struct timespec now;
+
+   (void) clock_gettime(CLOCK_MONOTONIC,&now);
+   return(1e9*now.tv_sec + now.tv_nsec);
+}
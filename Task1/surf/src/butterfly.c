@@ -0,0 +1,40 @@
+/******************************************************************
+ * Module:	butterfly.c
+ *
+ * Purpose:	Radix-2 butterfly stages on split real/imaginary
+ *		arrays, with SIMD versions where the processor has them.
+ *
+ * Contents:	butterfly_stage_select()	- choose the fastest stage
+ *		butterfly_stage_select_float()	- the same for floats
+ *		stage_scalar()	- plain C stage
+ *		stage_avx2()	- 4 butterflies per instruction
+ *		stage_avx512()	- 8 butterflies per instruction
+ *		stage_*_float()	- the same, twice as many at once
+ *
+ * Date:	17/10/26
+ * Modified:	17/10/26: the stages are written once for doubles and
+ *		floats (see butterflyt.h).
+ *****************************************************************/
+
+#include "butterfly.h"
+
+/*
+ * The SIMD stages are compiled for their instruction sets with
+ * function attributes, so the rest of the program needs no special
+ * flags, and are only chosen when the processor reports support.
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BUTTERFLY_X86
+#include <immintrin.h>
+#endif
+
+
+/*
+ * the stages of each precision
+ */
+#include "scalar.h"
+#include "butterflyt.h"
+
+#define SCALAR_FLOAT
+#include "scalar.h"
+#include "butterflyt.h"
@@ -0,0 +1,167 @@
+/******************************************************************
+ * Module:	context.c
+ *
+ * Purpose:	The state of one profile analysis, so that several
+ *		profiles can be analysed at once.
+ *
+ * Contents:	context_create()	- allocate an analysis context
+ *		context_reserve()	- arrays for a number of data
+ *		context_destroy()	- release an analysis context
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+/*
+ * memory allocation routines
+ */
+#include <stdlib.h>
+
+/*
+ * global definitions
+ */
+#include "global.h"
+#include "context.h"
+#include "smooth.h"
+#include "form.h"
+
+
+/*
+ * Routine:	context_create
+ *
+ * Description:	Allocate a context. The arrays of a profile are found
+ *		when its number of data is known (see
+ *		context_reserve()).
+ *
+ * Parameters:	none
+ *
+ * Returns:	the context, or NULL if memory is not available
+ *
+ * Date:	17/10/26
+ */
+struct surf_context *context_create()
+{
+   struct surf_context *ctx;
+
+   ctx = (struct surf_context *) calloc(1,sizeof(struct surf_context));
+   if (ctx == NULL)
+      return(NULL);
+
+   /*
+    * smoothed spectral data, which do not depend on the number of data
+    */
+   ctx->smooth = (struct smoothed *)
+      calloc(SMOOTH_MAX_DATA,sizeof(struct smoothed));
+   ctx->saved_smooth = (struct smoothed *)
+      calloc(SMOOTH_MAX_DATA,sizeof(struct smoothed));
+   if (ctx->smooth==NULL || ctx->saved_smooth==NULL) {
+      context_destroy(ctx);
+      return(NULL);
+   }
+
+   ctx->smooth_num_data = 0;
+   ctx->smooth_mode = SMOOTH_LINEAR;
+   ctx->trans_mode = TRANS_PADDED;
+   ctx->form = FORM_LINE;
+   ctx->welch_overlap = -1;
+   ctx->data_valid = FALSE;
+   ctx->tfm_valid = FALSE;
+   ctx->cached = FALSE;
+
+   return(ctx);
+}
+
+
+/*
+ * Routine:	context_reserve
+ *
+ * Description:	Find memory space for the arrays of a profile of
+ *		"num_data" samples, all in the context's arena and each
+ *		starting on an ARENA_ALIGN boundary. The arena is only
+ *		reallocated when the profile is longer than any before.
+ *
+ * Parameters:	ctx		<> the analysis context
+ *		num_data	< number of samples
+ *
+ * Returns:	TRUE	- the arrays are ready, their contents undefined
+ *		ER_MEM	- memory is not available
+ *
+ * Example:	context_reserve(ctx,7500);
+ *
+ * Date:	17/10/26
+ */
+int context_reserve(struct surf_context *ctx, int num_data)
+{
+   size_t data_size,trans_size,acf_size;
+   int power;
+
+   /*
+    * The transform is padded to an integral power of 2 ("power" or
+    * less) and its real data are packed two to a complex value,
+    * leaving room for the extra coefficient at the Nyquist
+    * frequency. The autocorrelation function is transformed at
+    * twice that length.
+    */
+   power = 2;
+   while (power < num_data)
+      power = 2*power;
+   data_size = (num_data > 0 ? num_data : 1)*sizeof(double);
+   trans_size = (power/2+1)*sizeof(double);
+   acf_size = (power+1)*sizeof(double);
+
+   if (arena_reserve(&ctx->arena,2*arena_size(data_size)
+      + 3*arena_size(trans_size) + 3*arena_size(acf_size)) != TRUE) {
+      ctx->data = ctx->smooth_data = NULL;
+      ctx->trans_re = ctx->trans_im = ctx->spec_data = NULL;
+      ctx->acf = ctx->acf_re = ctx->acf_im = NULL;
+      ctx->error_number = ER_MEM;
+      return(ER_MEM);
+   }
+
+   /*
+    * the data acquired by the Talysurf
+    */
+   ctx->data = (double *) arena_take(&ctx->arena,data_size);
+   ctx->smooth_data = (double *) arena_take(&ctx->arena,data_size);
+
+   /*
+    * transform data, real and imaginary parts, and spectral data
+    */
+   ctx->trans_re = (double *) arena_take(&ctx->arena,trans_size);
+   ctx->trans_im = (double *) arena_take(&ctx->arena,trans_size);
+   ctx->spec_data = (double *) arena_take(&ctx->arena,trans_size);
+
+   /*
+    * autocorrelation function and its transform
+    */
+   ctx->acf = (double *) arena_take(&ctx->arena,acf_size);
+   ctx->acf_re = (double *) arena_take(&ctx->arena,acf_size);
+   ctx->acf_im = (double *) arena_take(&ctx->arena,acf_size);
+
+   return(TRUE);
+}
+
+
+/*
+ * Routine:	context_destroy
+ *
+ * Description:	Release a context, its arrays and its transform plans.
+ *
+ * Parameters:	ctx	< the context made by context_create()
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void context_destroy(struct surf_context *ctx)
+{
+   if (ctx == NULL)
+      return;
+   arena_free(&ctx->arena);
+   free(ctx->smooth);
+   free(ctx->saved_smooth);
+   online_free(&ctx->online);
+   welch_table_free(&ctx->window);
+   free(ctx->welch_work);
+   fft_cache_free(&ctx->plans);
+   free(ctx);
+}
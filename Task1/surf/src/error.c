@@ -3,7 +3,8 @@
  *
  * Purpose:	Print error messages.
  *
- * Contents:    print_error	- print error messages
+ * Contents:    error_string	- the message for an error number
+ *		print_error	- print error messages
  *
  * Date:	25/4/91
  *****************************************************************/
@@ -13,7 +14,47 @@
  */
 #include <stdio.h>
 #include "global.h"
-int error_number;
+
+/*
+ * Routine:	error_string
+ *
+ * Description: Return the message for a given error number
+ *
+ * Parameters:  number	< the error number
+ *
+ * Returns:	the message
+ *
+ * Example:     error_string(ER_FIL);
+ *		return("File not found");
+ *
+ * Date:	17/10/26
+ *
+ * Modified:	17/10/26: a constant table, so that any number of
+ *		threads may call it at once
+ */
+const char *error_string(int number)
+{
+   /*
+    * error messages
+    */
+   static const char *const error_message[MAX_ERRORS] = {
+      [ER_FIL] = "File not found",
+      [ER_MAG] = "Magnification out of range - invalid file",
+      [ER_FILT] = "Filter setting out of range - invalid file",
+      [ER_MEM] = "Insufficient memory for data arrays",
+      [ER_GRHW] = "No graphics present",
+      [ER_GRIN] = "Graphics initialization failure",
+      [ER_DIV0] = "Division by zero",
+      [ER_COMPAT] = "Incompatible file format",
+      [ER_FONT] = "Font file not found",
+      [ER_COUNT] = "Wrong number of samples - invalid file",
+      [ER_BANDS] = "Smoothed spectra of different bands"};
+
+   if (number < 1 || number >= MAX_ERRORS || error_message[number] == NULL)
+      return("Unknown error");
+   return(error_message[number]);
+}
+
 
 /*
  * Routine:	print_error
@@ -21,39 +62,21 @@ int error_number;
  * Description: Print error messages in response to a given error
  *     		number
  *
- * Parameters:  none
+ * Parameters:  number	< the error number
  *
  * Returns:	nothing
  *
- * Example:     error_number=10;
- *		printf("Magnification number out of range\n");
+ * Example:     print_error(ER_MAG);
+ *		printf("Magnification out of range - invalid file\n");
  *
  * Date:	22/5/91
  */
-void print_error()
+void print_error(int number)
 {
-   /*
-    * memory area for the error messages
-    */
-   static char *error_message[MAX_ERRORS];
-
-   /*
-    * error messages
-    */
-   error_message[ER_FIL] = "File not found";
-   error_message[ER_MAG] = "Magnification out of range - invalid file";
-   error_message[ER_FILT] = "Filter setting out of range - invalid file";
-   error_message[ER_MEM] = "Insufficient memory for data arrays";
-   error_message[ER_GRHW] = "No graphics present";
-   error_message[ER_GRIN] = "Graphics initialization failure";
-   error_message[ER_DIV0] = "Division by zero";
-   error_message[ER_COMPAT] = "Incompatible file format";
-   error_message[ER_FONT] = "Font file not found";
-
    /*
     * print the error message
     */
-   printf("%s \n",error_message[error_number]);
+   printf("%s \n",error_string(number));
 
    /*
     * wait for user input
@@ -3,88 +3,398 @@
  *
  * Purpose:	Define fft routine.
  *
+ * Contents:	fft()			- transform "trans_re", "trans_im"
+ *		fft_plan_create()	- build a transform plan
+ *		fft_plan_destroy()	- release a transform plan
+ *		fft_plan_get()		- fetch a cached transform plan
+ *		fft_cache_free()	- release cached plans
+ *		fft_plan_float()	- float tables of a plan
+ *		fft_plan_get_float()	- fetch a plan with float tables
+ *		fft_table_float()	- a table rounded to floats
+ *		fft_plan_run()		- in-place transform using a plan
+ *		fft_plan_run_real()	- transform of real values
+ *		fft_plan_run_real_inverse()	- real values from their
+ *				  coefficients
+ *		and the same transforms in float (see fftt.h)
+ *
  * Date:	23/4/91
+ *
+ * Modified:	17/10/26: twiddle factors and the bit-reversal
+ *		permutation are calculated once per length and cached,
+ *		and the transform is performed in place.
+ *		17/10/26: real data are transformed as half as many
+ *		complex values followed by a split step.
+ *		17/10/26: lengths other than integral powers of 2 are
+ *		passed to the mixed-radix or Bluestein transforms.
+ *		17/10/26: complex values are held as separate real and
+ *		imaginary arrays and the butterflies use SIMD stages.
+ *		17/10/26: inverse transform of real values.
+ *		17/10/26: the transforms are written once for doubles
+ *		and floats (see fftt.h).
+ *		17/10/26: the lengths of the Talysurf filters have
+ *		transforms of their own, with built-in twiddle factors.
  *****************************************************************/
                     
 #include <math.h>
+#include <stdlib.h>
 #include "global.h"
-#include "fft.h"                    
-#include "complex.h"
+#include "fft.h"
+#include "mixfft.h"
+#include "context.h"
+#include "fftconst.h"
+
+static int fft_table_float(float **copy, const double *table, int n);
 
 /*
- * Routine:	fft
+ * Routine:	fft_plan_create
  *
- * Description:	The Fourier transform of the data items is calculated.
+ * Description:	Allocate a plan, choose the algorithm for "n" points
+ *		and calculate the tables it needs.
  *
- * Parameters:
+ * Parameters:	n	< number of points
  *
- * Returns:	TRUE	- successful calculation
- *		FALSE	- unsuccessful
+ * Returns:	the plan, or NULL if memory is not available
  *
- * Example:	trans_data = [1,2,3,4], num_data = 4;
- *		following transformation, data = ?
- *
- * Date:	22/4/91
+ * Date:	17/10/26
  */
-void fft()
+struct fft_plan *fft_plan_create(int n)
 {
-   double log_two_trans_num_data;
-   int trans_num_data_2;
-   struct complex com1,com2;  /* general complex variables */
-   long k,j,na,nb,nc,nd,i,np,nr,ns,nq,n;  /* general variables */
+   struct fft_plan *plan;
+   int i,bit,rev,half;
+
+   plan = (struct fft_plan *) calloc(1,sizeof(struct fft_plan));
+   if (plan == NULL)
+      return(NULL);
+
+   plan->n = n;
+   for(plan->log_two_n=0;(1<<plan->log_two_n)<n;plan->log_two_n++)
+      ;
 
    /*
-    * initialize transform constants
+    * choose the algorithm
     */
-   log_two_trans_num_data = log(trans_num_data)/log(2.0);
-   trans_num_data_2 = trans_num_data/2;
-   com1.x = cos(MINUS_TWO_PI/trans_num_data);
-   com1.y = sin(MINUS_TWO_PI/trans_num_data);
-
-/*** testing **
-   printf("log 2 Trans_data: %12.4f\n",log_two_trans_num_data);
-   printf("coms %12.4f %12.4f\n",com1.x,com1.y);
-*/
+   if ((1 << plan->log_two_n) == n)
+      plan->kind = n >= FFT_CONST_MIN && n <= FFT_CONST_MAX ? FFT_FIXED
+         : FFT_RADIX_TWO;
+   else if (mixfft_factor(n,plan->factors) == TRUE)
+      plan->kind = FFT_MIXED_RADIX;
+   else
+      plan->kind = FFT_BLUESTEIN;
+
    /*
-    * the transform (!)
+    * Each twiddle is evaluated directly rather than by repeated
+    * multiplication, so that rounding errors do not accumulate.
+    * First those of the split step for real values. An FFT_FIXED
+    * plan has them built in, the factors of the split step of "n"
+    * points being those of the stage that would combine transforms
+    * of "n" points.
     */
-   for(k=1;k<=log_two_trans_num_data;k++){
-      j=-1;
-      na=(long)pow(2.0,(double)(k-1));
-      nb=2*na;
-      nc=trans_num_data/nb;
-      com2.x=1.0;com2.y=0.0;
-      for(nd=1;nd<=nc;nd++){
-	 i=j+1;
-	 j=j+na;
-	 np=(nd-1)*nb;
-	 for(nr=i;nr<=j;nr++){
-	    ns=nr+trans_num_data_2;
-	    dummy_data[np]=com_sum(trans_data[nr],trans_data[ns]);
-	    nq=np+na;
-	    dummy_data[nq]=com_prod(com2,com_diff(trans_data[nr],trans_data[ns]));
-	    np++;
-/**** testing **
-            printf("dummy_data[1] %10.4f %10.4f",dummy_data[np].x,trans_data[np].x);
-*/
-	 }
-	 com2=com_prod(com2,com_pow(com1,(double)na));
+   if (plan->kind == FFT_FIXED) {
+      plan->real_re = (double *) fft_const_re + n;
+      plan->real_im = (double *) fft_const_im + n;
+   }
+   else {
+      plan->real_re = (double *) calloc(n/2 + 1,sizeof(double));
+      plan->real_im = (double *) calloc(n/2 + 1,sizeof(double));
+      if (plan->real_re == NULL || plan->real_im == NULL) {
+         fft_plan_destroy(plan);
+         return(NULL);
       }
-      for(n=0;n<trans_num_data;n++) {
-	 trans_data[n] = dummy_data[n];
+      for(i=0;i<=n/2;i++) {
+         plan->real_re[i] = cos(TWO_PI*i/(2*n));
+         plan->real_im[i] = -sin(TWO_PI*i/(2*n));
       }
-/**** testing ***
-    printf("\niteration %4d, trans_data[1] %12.2d\n",k,trans_data[1].x);
-    printf("dummy_data[1] %10.4f\n",dummy_data[1].x);
-*/
    }
 
-/*** testing **
-   for(i=0;i<trans_num_data;i++) {
-      trans_data[i].x = i;
-      trans_data[i].y = 0;
+   switch (plan->kind) {
+      case FFT_RADIX_TWO:
+      case FFT_FIXED:
+         /*
+          * the bit-reversed index of each point, and the twiddles of
+          * each stage stored contiguously so that the stage can load
+          * them a vector at a time
+          */
+         plan->bit_rev = (int *) calloc(n,sizeof(int));
+         if (plan->bit_rev == NULL) {
+            fft_plan_destroy(plan);
+            return(NULL);
+         }
+         for(i=0;i<n;i++) {
+            rev = 0;
+            for(bit=0;bit<plan->log_two_n;bit++)
+               rev = (rev << 1) | ((i >> bit) & 1);
+            plan->bit_rev[i] = rev;
+         }
+         plan->stage = butterfly_stage_select();
+         if (plan->kind == FFT_FIXED) {
+            plan->stage_re = (double *) fft_const_re;
+            plan->stage_im = (double *) fft_const_im;
+            break;
+         }
+         plan->stage_re = (double *) calloc(n,sizeof(double));
+         plan->stage_im = (double *) calloc(n,sizeof(double));
+         if (plan->stage_re == NULL || plan->stage_im == NULL) {
+            fft_plan_destroy(plan);
+            return(NULL);
+         }
+         for(half=1;half<n;half*=2) {
+            for(i=0;i<half;i++) {
+               plan->stage_re[half+i] = cos(TWO_PI*i/(2*half));
+               plan->stage_im[half+i] = -sin(TWO_PI*i/(2*half));
+            }
+         }
+         break;
+
+      case FFT_MIXED_RADIX:
+         plan->twiddle_re = (double *) calloc(n,sizeof(double));
+         plan->twiddle_im = (double *) calloc(n,sizeof(double));
+         plan->scratch_re = (double *) calloc(n,sizeof(double));
+         plan->scratch_im = (double *) calloc(n,sizeof(double));
+         if (plan->twiddle_re == NULL || plan->twiddle_im == NULL
+            || plan->scratch_re == NULL || plan->scratch_im == NULL) {
+            fft_plan_destroy(plan);
+            return(NULL);
+         }
+         for(i=0;i<n;i++) {
+            plan->twiddle_re[i] = cos(TWO_PI*i/n);
+            plan->twiddle_im[i] = -sin(TWO_PI*i/n);
+         }
+         break;
+
+      case FFT_BLUESTEIN:
+         if (bluestein_init(plan) != TRUE) {
+            fft_plan_destroy(plan);
+            return(NULL);
+         }
+         break;
    }
-*/
 
+   return(plan);
+}
+
+
+/*
+ * Routine:	fft_plan_destroy
+ *
+ * Description:	Release the memory held by a plan.
+ *
+ * Parameters:	plan	< the plan made by fft_plan_create()
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void fft_plan_destroy(struct fft_plan *plan)
+{
+   if (plan == NULL)
+      return;
+   if (plan->kind != FFT_FIXED) {
+      free(plan->real_re);
+      free(plan->real_im);
+      free(plan->stage_re);
+      free(plan->stage_im);
+   }
+   free(plan->bit_rev);
+   free(plan->twiddle_re);
+   free(plan->twiddle_im);
+   free(plan->scratch_re);
+   free(plan->scratch_im);
+   free(plan->chirp_re);
+   free(plan->chirp_im);
+   free(plan->chirp_tfm_re);
+   free(plan->chirp_tfm_im);
+   free(plan->real_re_float);
+   free(plan->real_im_float);
+   free(plan->stage_re_float);
+   free(plan->stage_im_float);
+   free(plan->twiddle_re_float);
+   free(plan->twiddle_im_float);
+   free(plan->scratch_re_float);
+   free(plan->scratch_im_float);
+   free(plan->chirp_re_float);
+   free(plan->chirp_im_float);
+   free(plan->chirp_tfm_re_float);
+   free(plan->chirp_tfm_im_float);
+   fft_plan_destroy(plan->sub_plan);
+   free(plan);
 }
 
+
+/*
+ * Routine:	fft_plan_get
+ *
+ * Description:	Return a plan for "n" points, building it only if it is
+ *		not already among the FFT_PLAN_CACHE most recent plans.
+ *		The plan remains owned by the cache.
+ *
+ * Parameters:	cache	<> the plan cache
+ *		n	< number of points
+ *
+ * Returns:	the plan, or NULL if memory is not available
+ *
+ * Date:	17/10/26
+ */
+struct fft_plan *fft_plan_get(struct fft_cache *cache, int n)
+{
+   struct fft_plan *plan;
+   int i;
+
+   for(i=0;i<FFT_PLAN_CACHE;i++) {
+      if (cache->plan[i] != NULL && cache->plan[i]->n == n)
+         return(cache->plan[i]);
+   }
+
+   plan = fft_plan_create(n);
+   if (plan == NULL)
+      return(NULL);
+
+   /*
+    * replace the oldest plan
+    */
+   fft_plan_destroy(cache->plan[cache->next]);
+   cache->plan[cache->next] = plan;
+   cache->next = (cache->next + 1) % FFT_PLAN_CACHE;
+
+   return(plan);
+}
+
+
+/*
+ * Routine:	fft_cache_free
+ *
+ * Description:	Release every plan held by a cache.
+ *
+ * Parameters:	cache	<> the plan cache
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void fft_cache_free(struct fft_cache *cache)
+{
+   int i;
+
+   for(i=0;i<FFT_PLAN_CACHE;i++) {
+      fft_plan_destroy(cache->plan[i]);
+      cache->plan[i] = NULL;
+   }
+   cache->next = 0;
+}
+
+
+/*
+ * Routine:	fft_plan_float
+ *
+ * Description:	Give a plan the tables of the float transforms, each
+ *		the double table rounded, the first time they are
+ *		needed. A Bluestein plan's power of 2 plan is given
+ *		them too.
+ *
+ * Parameters:	plan	<> the plan
+ *
+ * Returns:	TRUE	- the float tables are ready
+ *		ER_MEM	- memory is not available
+ *
+ * Date:	17/10/26
+ */
+int fft_plan_float(struct fft_plan *plan)
+{
+   int n,m;
+
+   n = plan->n;
+   m = plan->sub_plan != NULL ? plan->sub_plan->n : n;
+   if (plan->sub_plan != NULL && fft_plan_float(plan->sub_plan) != TRUE)
+      return(ER_MEM);
+
+   /*
+    * the scratch arrays are only copied for their size
+    */
+   if (fft_table_float(&plan->real_re_float,plan->real_re,n/2+1) != TRUE
+      || fft_table_float(&plan->real_im_float,plan->real_im,n/2+1) != TRUE
+      || fft_table_float(&plan->stage_re_float,plan->stage_re,n) != TRUE
+      || fft_table_float(&plan->stage_im_float,plan->stage_im,n) != TRUE
+      || fft_table_float(&plan->twiddle_re_float,plan->twiddle_re,n) != TRUE
+      || fft_table_float(&plan->twiddle_im_float,plan->twiddle_im,n) != TRUE
+      || fft_table_float(&plan->scratch_re_float,plan->scratch_re,m) != TRUE
+      || fft_table_float(&plan->scratch_im_float,plan->scratch_im,m) != TRUE
+      || fft_table_float(&plan->chirp_re_float,plan->chirp_re,n) != TRUE
+      || fft_table_float(&plan->chirp_im_float,plan->chirp_im,n) != TRUE
+      || fft_table_float(&plan->chirp_tfm_re_float,plan->chirp_tfm_re,m)
+         != TRUE
+      || fft_table_float(&plan->chirp_tfm_im_float,plan->chirp_tfm_im,m)
+         != TRUE)
+      return(ER_MEM);
+   if ((plan->kind == FFT_RADIX_TWO || plan->kind == FFT_FIXED)
+      && plan->stage_float == NULL)
+      plan->stage_float = butterfly_stage_select_float();
+
+   return(TRUE);
+}
+
+
+/*
+ * Routine:	fft_plan_get_float
+ *
+ * Description:	As fft_plan_get(), for a plan that will be run in
+ *		float.
+ *
+ * Parameters:	cache	<> the plan cache
+ *		n	< number of points
+ *
+ * Returns:	the plan, or NULL if memory is not available
+ *
+ * Date:	17/10/26
+ */
+struct fft_plan *fft_plan_get_float(struct fft_cache *cache, int n)
+{
+   struct fft_plan *plan;
+
+   plan = fft_plan_get(cache,n);
+   if (plan == NULL || fft_plan_float(plan) != TRUE)
+      return(NULL);
+
+   return(plan);
+}
+
+
+/*
+ * Routine:	fft_table_float
+ *
+ * Description:	Round a table of doubles to a new table of floats,
+ *		unless that has been done already or there is no
+ *		table.
+ *
+ * Parameters:	copy	<> the float table, NULL until it is made
+ *		table	< the double table, or NULL
+ *		n	< its length
+ *
+ * Returns:	TRUE	- done, or nothing to do
+ *		ER_MEM	- memory is not available
+ *
+ * Date:	17/10/26
+ */
+static int fft_table_float(float **copy, const double *table, int n)
+{
+   int i;
+
+   if (table == NULL || *copy != NULL)
+      return(TRUE);
+   *copy = (float *) malloc(n*sizeof(float));
+   if (*copy == NULL)
+      return(ER_MEM);
+   for(i=0;i<n;i++)
+      (*copy)[i] = (float) table[i];
+
+   return(TRUE);
+}
+
+
+/*
+ * the transforms of each precision
+ */
+#include "scalar.h"
+#include "fftt.h"
+
+#define SCALAR_FLOAT
+#include "scalar.h"
+#include "fftt.h"
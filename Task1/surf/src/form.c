@@ -0,0 +1,449 @@
+/******************************************************************
+ * Module:	form.c
+ *
+ * Purpose:	Removal of the form of a profile: a polynomial fitted
+ *		as a sum of discrete orthogonal (Gram) polynomials, or
+ *		the arc of a circle.
+ *
+ * Contents:	form_remove()	- take the form off the data
+ *		form_name()	- form from its name
+ *		form_fit()	- the best-fitting polynomial
+ *		form_poly()	- take a polynomial off the data
+ *		form_arc()	- take an arc off the data
+ *		form_solve()	- solve three linear equations
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+#include <string.h>
+#include <math.h>
+
+/*
+ * global definitions
+ */
+#include "global.h"
+#include "context.h"
+
+/*
+ * declarations
+ */
+#include "form.h"
+#include "stats.h"
+
+/*
+ * Largest radius of an arc, in half profile lengths; a flatter
+ * profile has its line taken off instead. The smallest pivot of the
+ * normal equations, relative to their largest element.
+ */
+#define FORM_MAX_RADIUS 1.0e8
+#define FORM_MIN_PIVOT 1.0e-12
+
+/*
+ * Gauss-Newton steps of an arc: the most taken, the relative fall in
+ * the squared error below which no more are, and the sums of a pass
+ */
+#define FORM_ARC_PASSES 20
+#define FORM_ARC_TOL 1.0e-10
+#define FORM_ARC_SUMS 10
+
+static int form_fit(const double *data, int num_data, int order,
+   double coef[FORM_MAX_ORDER+1], double beta[FORM_MAX_ORDER+1]);
+static void form_poly(double *data, int num_data, int order);
+static int form_arc(double *data, int num_data, double x_division,
+   double y_division);
+static int form_solve(double a[3][3], double b[3], double x[3]);
+
+
+/*
+ * Routine:	form_remove
+ *
+ * Description:	Take the context's "form" off its data in place.
+ *
+ * Parameters:	ctx	<> the analysis context
+ *
+ * Returns:	nothing
+ *
+ * Example:	ctx->form = 3;
+ *		form_remove(ctx);
+ *
+ * Date:	17/10/26
+ */
+void form_remove(struct surf_context *ctx)
+{
+   STATS_TIMER(start);
+
+   STATS_START(start);
+   if (ctx->form == FORM_ARC) {
+      if (form_arc(ctx->data,ctx->num_data,ctx->x_division,
+         ctx->y_division) != TRUE)
+         form_poly(ctx->data,ctx->num_data,FORM_LINE);
+   }
+   else
+      form_poly(ctx->data,ctx->num_data,ctx->form);
+
+   /*
+    * the running statistics were of the data before the form was
+    * taken off, so calc_params() must find the parameters itself
+    */
+   online_reset(&ctx->online);
+   STATS_STOP(STATS_LEVEL,start);
+}
+
+
+/*
+ * Routine:	form_name
+ *
+ * Description:	The form named "line", "arc" or by the order of its
+ *		polynomial, "1" to FORM_MAX_ORDER.
+ *
+ * Parameters:	name	< the name
+ *
+ * Returns:	the form, or FALSE if the name is not known
+ *
+ * Example:	form_name("arc");
+ *		return(FORM_ARC);
+ *
+ * Date:	17/10/26
+ */
+int form_name(const char *name)
+{
+   if (strcmp(name,"line") == 0)
+      return(FORM_LINE);
+   if (strcmp(name,"arc") == 0)
+      return(FORM_ARC);
+   if (strlen(name) == 1 && name[0] >= '1'
+      && name[0] <= '0'+FORM_MAX_ORDER)
+      return(name[0]-'0');
+   return(FALSE);
+}
+
+
+/*
+ * Routine:	form_fit
+ *
+ * Description:	The best-fitting (mse) polynomial of an order through
+ *		the data. The sample index i is mapped onto
+ *		t = (i-c)*u in -1..1, with c = (n-1)/2 and u = 2/(n-1),
+ *		and the fit is a sum of the monic polynomials
+ *		orthogonal over those t,
+ *
+ *		P0 = 1, P1 = t, P(k+1) = t*P(k) - beta(k)*P(k-1),
+ *		beta(k) = u^2 k^2 (n^2-k^2) / (4 (4k^2-1)),
+ *
+ *		whose norms are n, beta(1)*n, beta(2)*beta(1)*n, ...
+ *		Only the sums of the data with each polynomial are
+ *		needed, so one pass finds the coefficients, with the
+ *		consecutive samples summed in FORM_LANES independent
+ *		lanes.
+ *
+ * Parameters:	data		< the data
+ *		num_data	< number of data, at least 1
+ *		order		< order of the polynomial, no more than
+ *				  FORM_MAX_ORDER
+ *		coef		> the coefficient of each P(k)
+ *		beta		> the recurrence, from beta[1]
+ *
+ * Returns:	the order fitted, no more than num_data-1
+ *
+ * Date:	17/10/26
+ */
+static int form_fit(const double *data, int num_data, int order,
+   double coef[FORM_MAX_ORDER+1], double beta[FORM_MAX_ORDER+1])
+{
+   double sum[FORM_MAX_ORDER+1][FORM_LANES];  /* sums of y*P(k) */
+   double norm;
+   double c,u,n,t,p0,p1,p2,y;
+   int i,k,lane;
+
+   if (order > num_data-1)
+      order = num_data-1;
+   n = num_data;
+   c = 0.5*(num_data-1);
+   u = num_data > 1 ? 2.0/(num_data-1) : 0.0;
+   for(k=1;k<=FORM_MAX_ORDER;k++)
+      beta[k] = u*u*k*k*(n*n - (double) k*k)/(4.0*(4.0*k*k - 1.0));
+   memset(sum,0,sizeof(sum));
+
+   /*
+    * the sums, lane by lane; the samples after the last whole set
+    * of lanes go to the first lanes
+    */
+   for(i=0;i<num_data;i+=FORM_LANES) {
+      for(lane=0;lane<FORM_LANES && i+lane<num_data;lane++) {
+         y = data[i+lane];
+         t = (i+lane-c)*u;
+         sum[0][lane] += y;
+         p0 = 1.0;
+         p1 = t;
+         for(k=1;k<=order;k++) {
+            sum[k][lane] += y*p1;
+            p2 = t*p1 - beta[k]*p0;
+            p0 = p1;
+            p1 = p2;
+         }
+      }
+   }
+
+   /*
+    * the coefficients, each sum over its polynomial's norm
+    */
+   norm = n;
+   for(k=0;k<=order;k++) {
+      if (k > 0)
+         norm *= beta[k];
+      coef[k] = 0.0;
+      for(lane=0;lane<FORM_LANES;lane++)
+         coef[k] += sum[k][lane];
+      coef[k] = norm > 0.0 ? coef[k]/norm : 0.0;
+   }
+
+   return(order);
+}
+
+
+/*
+ * Routine:	form_poly
+ *
+ * Description:	Take the best-fitting (mse) polynomial of an order off
+ *		the data (see form_fit()).
+ *
+ * Parameters:	data		<> the data
+ *		num_data	< number of data
+ *		order		< order of the polynomial, no more than
+ *				  FORM_MAX_ORDER
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+static void form_poly(double *data, int num_data, int order)
+{
+   double beta[FORM_MAX_ORDER+1];
+   double coef[FORM_MAX_ORDER+1];
+   double c,u,t,p0,p1,p2,fit;
+   int i,k;
+
+   if (num_data < 1)
+      return;
+   order = form_fit(data,num_data,order,coef,beta);
+   c = 0.5*(num_data-1);
+   u = num_data > 1 ? 2.0/(num_data-1) : 0.0;
+   for(i=0;i<num_data;i++) {
+      t = (i-c)*u;
+      fit = coef[0];
+      p0 = 1.0;
+      p1 = t;
+      for(k=1;k<=order;k++) {
+         fit += coef[k]*p1;
+         p2 = t*p1 - beta[k]*p0;
+         p0 = p1;
+         p1 = p2;
+      }
+      data[i] -= fit;
+   }
+}
+
+
+/*
+ * Routine:	form_arc
+ *
+ * Description:	Take the best-fitting (mse) arc off the data, leaving
+ *		the profile about its mean. The samples are put at
+ *		their true scale, in half profile lengths x = t (see
+ *		form_fit()) and heights y about their mean, and the
+ *		arc is written as the sag of a circle of curvature k
+ *		from its apex (a, h),
+ *
+ *		y = h + k d^2 / (1 + sqrt(1 - k^2 d^2)), d = x-a,
+ *
+ *		which stays well conditioned however flat the arc. It
+ *		starts from the best-fitting parabola and is improved
+ *		by Gauss-Newton steps, each one pass over the data
+ *		summing the normal equations in FORM_LANES lanes. An
+ *		algebraic circle fit is not used: on the shallow arcs
+ *		of a profile it is biased towards small circles.
+ *
+ * Parameters:	data		<> the data
+ *		num_data	< number of data
+ *		x_division	< x scaling factor
+ *		y_division	< y scaling factor
+ *
+ * Returns:	TRUE	- the arc was taken off
+ *		FALSE	- the profile is too short or flat for a
+ *			  circle, or does not lie on one across its
+ *			  length; the data are not changed
+ *
+ * Date:	17/10/26
+ */
+static int form_arc(double *data, int num_data, double x_division,
+   double y_division)
+{
+   double sum[FORM_ARC_SUMS][FORM_LANES];
+   double total[FORM_ARC_SUMS];
+   double beta[FORM_MAX_ORDER+1];
+   double coef[FORM_MAX_ORDER+1];
+   double m[3][3],r[3],step[3];
+   double apex,height,curve;  /* a, h and k */
+   double c,u,scale,y0,t,d,w,g[3],res,fit,mean;
+   double error,last_error;
+   int i,k,j,lane,pass;
+
+   if (num_data < 3 || x_division <= 0.0 || y_division <= 0.0)
+      return(FALSE);
+   c = 0.5*(num_data-1);
+   u = 2.0/(num_data-1);
+   scale = y_division/(c*x_division);
+
+   /*
+    * the parabola y = q0 + q1*x + q2*x^2 gives the apex and the
+    * curvature there
+    */
+   (void) form_fit(data,num_data,2,coef,beta);
+   y0 = coef[0];
+   if (coef[2] == 0.0)
+      return(FALSE);
+   curve = 2.0*scale*coef[2];
+   apex = -coef[1]/(2.0*coef[2]);
+   height = scale*(-coef[2]*beta[1] - coef[1]*coef[1]/(4.0*coef[2]));
+
+   last_error = -1.0;
+   for(pass=0;pass<FORM_ARC_PASSES;pass++) {
+      if (fabs(curve) < 1.0/FORM_MAX_RADIUS
+         || fabs(curve)*(fabs(apex)+1.0) >= 1.0)
+         return(FALSE);
+
+      /*
+       * the normal equations of the step, and the squared error
+       */
+      memset(sum,0,sizeof(sum));
+      for(i=0;i<num_data;i+=FORM_LANES) {
+         for(lane=0;lane<FORM_LANES && i+lane<num_data;lane++) {
+            t = (i+lane-c)*u;
+            d = t - apex;
+            w = sqrt(1.0 - curve*curve*d*d);
+            res = (data[i+lane] - y0)*scale
+               - height - curve*d*d/(1.0+w);
+            g[0] = -curve*d/w;
+            g[1] = 1.0;
+            g[2] = d*d/(1.0+w) + curve*curve*d*d*d*d/(w*(1.0+w)*(1.0+w));
+            sum[0][lane] += g[0]*g[0];
+            sum[1][lane] += g[0]*g[1];
+            sum[2][lane] += g[0]*g[2];
+            sum[3][lane] += g[1]*g[1];
+            sum[4][lane] += g[1]*g[2];
+            sum[5][lane] += g[2]*g[2];
+            sum[6][lane] += g[0]*res;
+            sum[7][lane] += g[1]*res;
+            sum[8][lane] += g[2]*res;
+            sum[9][lane] += res*res;
+         }
+      }
+      for(k=0;k<FORM_ARC_SUMS;k++) {
+         total[k] = 0.0;
+         for(lane=0;lane<FORM_LANES;lane++)
+            total[k] += sum[k][lane];
+      }
+
+      /*
+       * done once a step no longer lessens the error
+       */
+      error = total[9];
+      if (last_error >= 0.0 && last_error - error <= FORM_ARC_TOL*last_error)
+         break;
+      last_error = error;
+
+      m[0][0] = total[0];  m[0][1] = total[1];  m[0][2] = total[2];
+      m[1][0] = total[1];  m[1][1] = total[3];  m[1][2] = total[4];
+      m[2][0] = total[2];  m[2][1] = total[4];  m[2][2] = total[5];
+      for(j=0;j<3;j++)
+         r[j] = total[6+j];
+      if (form_solve(m,r,step) != TRUE)
+         return(FALSE);
+      apex += step[0];
+      height += step[1];
+      curve += step[2];
+   }
+   if (fabs(curve) < 1.0/FORM_MAX_RADIUS
+      || fabs(curve)*(fabs(apex)+1.0) >= 1.0)
+      return(FALSE);
+
+   /*
+    * take the arc off, and then the mean
+    */
+   mean = 0.0;
+   for(i=0;i<num_data;i++) {
+      d = (i-c)*u - apex;
+      fit = height + curve*d*d/(1.0 + sqrt(1.0 - curve*curve*d*d));
+      data[i] -= y0 + fit/scale;
+      mean += data[i];
+   }
+   mean /= num_data;
+   for(i=0;i<num_data;i++)
+      data[i] -= mean;
+
+   return(TRUE);
+}
+
+
+/*
+ * Routine:	form_solve
+ *
+ * Description:	Solve a*x = b by Gaussian elimination with partial
+ *		pivoting.
+ *
+ * Parameters:	a	<> the matrix, destroyed
+ *		b	<> the right-hand side, destroyed
+ *		x	> the solution
+ *
+ * Returns:	TRUE	- solved
+ *		FALSE	- the matrix is (nearly) singular
+ *
+ * Date:	17/10/26
+ */
+static int form_solve(double a[3][3], double b[3], double x[3])
+{
+   double largest,factor,swap;
+   int i,j,k,pivot;
+
+   largest = 0.0;
+   for(i=0;i<3;i++)
+      for(j=0;j<3;j++)
+         if (fabs(a[i][j]) > largest)
+            largest = fabs(a[i][j]);
+   if (largest == 0.0)
+      return(FALSE);
+
+   for(k=0;k<3;k++) {
+      pivot = k;
+      for(i=k+1;i<3;i++)
+         if (fabs(a[i][k]) > fabs(a[pivot][k]))
+            pivot = i;
+      if (fabs(a[pivot][k]) < FORM_MIN_PIVOT*largest)
+         return(FALSE);
+      if (pivot != k) {
+         for(j=0;j<3;j++) {
+            swap = a[k][j];
+            a[k][j] = a[pivot][j];
+            a[pivot][j] = swap;
+         }
+         swap = b[k];
+         b[k] = b[pivot];
+         b[pivot] = swap;
+      }
+      for(i=k+1;i<3;i++) {
+         factor = a[i][k]/a[k][k];
+         for(j=k;j<3;j++)
+            a[i][j] -= factor*a[k][j];
+         b[i] -= factor*b[k];
+      }
+   }
+
+   for(k=2;k>=0;k--) {
+      x[k] = b[k];
+      for(j=k+1;j<3;j++)
+         x[k] -= a[k][j]*x[j];
+      x[k] /= a[k][k];
+   }
+
+   return(TRUE);
+}
@@ -4,14 +4,31 @@
  * Purpose:	Fast Fourier Transform calculations.
  *
  * Contents:	calculate_fft()		- controls the FFT routine
- *		copy_data()		- transfer "data" to "trans_data"
+ *		copy_data()		- transfer "data" to "trans_re", "trans_im"
  *		calculate_spectrum()	- compute the spectral data
  *		calc_params()		- calculate my parameters
+ *		height_params()		- the ISO 4287 parameters
+ *		params_finish()		- autocorrelation, then cache
+ *		autocorrelation_function()	- the whole autocorrelation
+ *				  function, by FFT
+ *		correlation_length()	- where the function falls to
+ *				  CORRELATION_LEVEL
  *		print_params()		- print my parameters
  *
  * Date:	22/4/91
  *
  * Modified:	22/5/91: 
+ *		17/10/26: autocorrelation function and correlation length
+ *		17/10/26: Welch spectrum
+ *		17/10/26: the spectrum is smoothed over bands
+ *		17/10/26: Ra, Rq, Rsk, Rku, Rz, RSm and Rdq
+ *		17/10/26: the transform, spectrum and parameters in
+ *		float or double (see fouriert.h)
+ *		17/10/26: results found before are taken from the
+ *		context's cache (see rcache.h)
+ *		17/10/26: the transform, spectrum and parameters are
+ *		timed (see stats.h)
+ *		17/10/26: Ra, Rq and Rz in microns, Rdq without units
  * 
  *****************************************************************/
 
@@ -31,43 +48,98 @@
  * Global definitions
  */
 #include "global.h"
-int cut_num_data;  /* number of spectral values per smoothed value */
+#include "context.h"
 
 /*
  * FFT declarations
  */
 #include "fft.h"
 #include "fourier.h"
+#include "moments.h"
+#include "welch.h"
+#include "smooth.h"
+#include "rcache.h"
+#include "stats.h"
 
+static double correlation_length(const struct surf_context *ctx);
+static int params_finish(struct surf_context *ctx);
+static void height_params(struct surf_context *ctx,
+   const struct surf_heights *h);
+
+/*
+ * the kernels of each precision
+ */
+#include "scalar.h"
+#include "fouriert.h"
+
+#define SCALAR_FLOAT
+#include "scalar.h"
+#include "fouriert.h"
 
 /*
  * Routine:	calculate_fft
  *
- * Description:	The Fourier transform of the data items is calculated.
+ * Description:	The Fourier transform of the data items is calculated,
+ *		or, if the context has a "welch_length", the spectrum
+ *		is averaged over segments (see welch_spectrum()). If
+ *		the context's cache holds the results of the same data
+ *		and settings they are taken from it instead, and
+ *		calc_params() has nothing left to do.
  *
- * Parameters:
+ * Parameters:	ctx	<> the analysis context
  *
  * Returns:	TRUE	- successful calculation
  *		FALSE	- unsuccessful
  *
  * Date:	3/6/91
+ * Modified:	17/10/26: Welch spectrum
+ *		17/10/26: results cache
+ *		17/10/26: timed
  */
-int calculate_fft()
+int calculate_fft(struct surf_context *ctx)
 {
+   STATS_TIMER(start);
+
+   if (rcache_fetch(ctx) == TRUE)
+      return(TRUE);
+
    /*
-    * copy the data to be transformed from "data" to "trans_data"
+    * the averaged spectrum of windowed segments, if asked for
     */
-   (void) copy_data();
+   if (ctx->welch_length > 0 && ctx->num_data >= WELCH_MIN_LENGTH) {
+      STATS_START(start);
+      if (welch_spectrum(ctx) != TRUE)
+         return(FALSE);
+      smooth_spectrum(ctx);
+      STATS_STOP(STATS_WELCH,start);
+      return(TRUE);
+   }
+
+   /*
+    * copy the data to be transformed from "data" to "trans_re" and
+    * "trans_im"
+    */
+   (void) copy_data(ctx);
 
    /*
     * call the fft routine
     */
-   (void) fft();
+   STATS_START(start);
+   if (ctx->precision == PRECISION_FLOAT) {
+      if (fft_float(ctx) != TRUE)
+         return(FALSE);
+   }
+   else if (fft(ctx) != TRUE)
+      return(FALSE);
+   STATS_STOP(STATS_FFT,start);
 
    /*
     * calculate the spectral values and smooth
     */
-   (void) calculate_spectrum();
+   STATS_START(start);
+   (void) calculate_spectrum(ctx);
+   smooth_spectrum(ctx);
+   STATS_STOP(STATS_SPECTRUM,start);
    
    return(TRUE);
 }
@@ -77,58 +149,60 @@ int calculate_fft()
  * Routine:	copy_data
  *
  * Description:	Copy the data to be transformed from "data" to
- *		"trans_data"
+ *		"trans_re" and "trans_im", two real values to each
+ *		complex value, as floats if the context's "precision"
+ *		is PRECISION_FLOAT.
  *
- * Parameters:	none
+ * Parameters:	ctx	<> the analysis context
  *
  * Returns:	nothing
  *
  * Example:
  *
  * Date:	23/5/91
+ * Modified:	17/10/26: float
  */
-void copy_data()
+void copy_data(struct surf_context *ctx)
 {
-   int i;
 
    /*
-    * copy values one at a time, converting the "data" to
-    * the real part of "trans_data"
-    */
-   for(i=0;i<num_data;i++) {
-      trans_data[i].x = data[i];
-      trans_data[i].y = 0.0;
-   }
-
-/*** testing **
-   (void) printf("num_data trans_num_data: %5d %5d\n",num_data,trans_num_data);
-   for(i=0;i<num_data;i++) {
-      (void) printf("%4d %12.2f %12.2f\n",i,data[i],trans_data[i].x);
-      if(trans_data[i].x < 10 && trans_data[i].x > -10) (void) printf("aaaagh\n");
-   }
-*/
-
-   /*
-    * The fft must be performed on data which number an integral power
-    * of 2. Zeros are added to the data to satisfy this constraint.
+    * The radix-2 fft must be performed on data which number an integral
+    * power of 2. Unless the exact length has been chosen, zeros are
+    * added to the data to satisfy this constraint.
     * This is now performed in 2 stages:
     *  (1) calculate the next integral power of 2 greater than "num_data",
     *      call this "trans_num_data".
-    *  (2) add the zeros.
+    *  (2) copy the data followed by the zeros.
     */
 
     /*
-     * (1) find "trans_num_data"
+     * (1) find "trans_num_data" (at least 2, so that there is a pair).
+     * The exact length is rounded up to an even number, so only an
+     * odd "num_data" gains a zero.
      */
-    trans_num_data = (int) pow(2.0,ceil(log(num_data)/log(2.0)));
+    if (ctx->trans_mode == TRANS_EXACT)
+       ctx->trans_num_data = ctx->num_data + ctx->num_data % 2;
+    else
+       ctx->trans_num_data =
+          (int) pow(2.0,ceil(log(ctx->num_data)/log(2.0)));
+    if (ctx->trans_num_data < 2)
+       ctx->trans_num_data = 2;
 
-    /*
-     * (2) add the zeros
-     */
-   for(i=num_data;i<trans_num_data;i++) {
-      trans_data[i].x = 0.0;
-      trans_data[i].y = 0.0;
+   /*
+    * (2) the data are real, so they are packed two to a complex value
+    * (see pack_data())
+    */
+   if (ctx->precision == PRECISION_FLOAT)
+      pack_data_float(ctx);
+   else
+      pack_data(ctx);
+
+/*** testing **
+   (void) printf("num_data trans_num_data: %5d %5d\n",num_data,trans_num_data);
+   for(i=0;i<num_data/2;i++) {
+      (void) printf("%4d %12.2f %12.2f\n",i,data[2*i],trans_re[i]);
    }
+*/
 }
 
 
@@ -136,17 +210,18 @@ void copy_data()
  * Routine:	calculate_spectrum
  *
  * Description:	Calculate the Fourier spectrum from the transformed
- *		data.
+ *		data, in the context's "precision".
  *
- * Parameters:	none
+ * Parameters:	ctx	<> the analysis context
  *
  * Returns:	nothing
  *
  * Example:
  *
  * Date:	22/5/91
+ * Modified:	17/10/26: float
  */
-void calculate_spectrum()
+void calculate_spectrum(struct surf_context *ctx)
 {
    int i;
 /*** testing *
@@ -157,20 +232,22 @@ void calculate_spectrum()
     * the spectral values are the sum of the squares of the
     * real and complex transform values
     */
-   spec_num_data = trans_num_data/2 + 1;
+   ctx->spec_num_data = ctx->trans_num_data/2 + 1;
 
-   for(i=0;i<spec_num_data;i++)
-      spec_data[i] =  pow(trans_data[i].x,2.0)
-                        + pow(trans_data[i].y,2.0);
+   if (ctx->precision == PRECISION_FLOAT)
+      spectrum_values_float(ctx);
+   else
+      spectrum_values(ctx);
 
    /*
     * scale the values to make their sum equal to that of the mean
     * square of the data
     */
-   spec_data[0] = spec_data[0]/trans_num_data;
-   for(i=1;i<spec_num_data-1;i++)
-      spec_data[i] = 2*spec_data[i]/trans_num_data;
-   spec_data[spec_num_data-1] = spec_data[spec_num_data-1]/trans_num_data;
+   ctx->spec_data[0] = ctx->spec_data[0]/ctx->trans_num_data;
+   for(i=1;i<ctx->spec_num_data-1;i++)
+      ctx->spec_data[i] = 2*ctx->spec_data[i]/ctx->trans_num_data;
+   ctx->spec_data[ctx->spec_num_data-1] =
+      ctx->spec_data[ctx->spec_num_data-1]/ctx->trans_num_data;
 
 /** testing 
    for(i=0;i<10;i++) {
@@ -195,91 +272,289 @@ void calculate_spectrum()
 /*
  * Routine:	calc_params()
  *
- * Description:	Calculate parameters
+ * Description:	Calculate parameters. One pass over the data
+ *		(moments_heights()) finds the sums of the ISO 4287
+ *		parameters (see height_params()) and those of the
+ *		mean, variance, extremes and correlation, which are
+ *		used unless the data were read by load_file() and the
+ *		statistics gathered then hold them (see
+ *		online_params()). In float the pass reads a float
+ *		copy of the data, kept
+ *		in "acf_re" until the autocorrelation function needs
+ *		it. Results taken from the context's cache are not
+ *		calculated again; new ones are kept in it.
  *
- * Parameters:	none
+ * Parameters:	ctx	<> the analysis context
  *
  * Returns:	TRUE	- successful calculation
+ *		FALSE	- no memory for the autocorrelation transform
  *
  * Example:     
  *
  * Date:	10/6/91
+ * Modified:	17/10/26: one pass; the mean is divided by the number of
+ *		data and the variance is kept for parameter_print()
+ *		17/10/26: the correlation length
+ *		17/10/26: Ra, Rq, Rsk, Rku, Rz, RSm and Rdq
+ *		17/10/26: float
+ *		17/10/26: results cache
+ *		17/10/26: timed
+ *		17/10/26: the moments and heights in the same pass
+ *		17/10/26: the running statistics in double only
+ *		17/10/26: mean, variance, Rp, Rv and Rt in microns
  */
-double mean;
-double var;
-double ra, rp, rv, rt;
-int calc_params()
+int calc_params(struct surf_context *ctx)
 {
-/*
- * find new parameters
- */
-
-   double var,mean;
-   double adjfac;
-   int i;
+   struct surf_moments m;
+   struct surf_heights h;
+   float *z_float;
+   int i,status;
+   STATS_TIMER(start);
+
+   if (ctx->cached == TRUE)
+      return(TRUE);
+   STATS_START(start);
+
+   if (ctx->precision == PRECISION_FLOAT) {
+      z_float = (float *) ctx->acf_re;
+      for(i=0;i<ctx->num_data;i++)
+         z_float[i] = (float) ctx->data[i];
+      moments_heights_float(z_float,ctx->num_data,&m,&h);
+   }
+   else
+      moments_heights(ctx->data,ctx->num_data,&m,&h);
 
    /*
-    * find mean and variance
+    * the statistics gathered while the data were read already hold
+    * the parameters of the levelled data, in double; in float they
+    * come from the float moments like the rest
     */
-   mean = 0.0;
-   var = 0.0;
-   for(i=0;i<num_data;i++) {
-      mean = mean + data[i];
-      var = var +  pow(data[i],2.0);
+   if (ctx->precision == PRECISION_DOUBLE
+      && ctx->online.n == ctx->num_data && ctx->online.status == TRUE) {
+      online_params(&ctx->online,ctx->y_division,&ctx->params);
+      height_params(ctx,&h);
+      status = params_finish(ctx);
+      STATS_STOP(STATS_PARAMS,start);
+      return(status);
    }
-   
+
+   /*
+    * find mean and variance, in microns like every height below
+    */
+   ctx->params.mean = ctx->y_division*m.sum/ctx->num_data;
+   ctx->params.var = ctx->y_division*ctx->y_division*m.sum_dev_sq
+      /ctx->num_data;
+
    /* 
     * find other parameters
     */
  
    // find Rp
-   rp = 0;
-   for(i=0;i<num_data;i++) {
-   	if (rp < (data[i]-mean)) rp = data[i] - mean;
-   }
+   ctx->params.rp = ctx->y_division*(m.max - m.sum/ctx->num_data);
+   if (ctx->params.rp < 0)
+      ctx->params.rp = 0;
    
    // find Rv
-   rv = 0;
-   for(i=0;i<num_data;i++) {
-   	if (rv < (mean-data[i])) rv = mean - data[i];
-   }     
+   ctx->params.rv = ctx->y_division*(m.sum/ctx->num_data - m.min);
+   if (ctx->params.rv < 0)
+      ctx->params.rv = 0;
  
    // find Rt
-   rt = rp + rv; 
+   ctx->params.rt = ctx->params.rp + ctx->params.rv; 
+
+   height_params(ctx,&h);
   
   /*
    * find correlation parameters
    */
-   autocorrelation_calculate();
+   autocorrelation_calculate(ctx,&m);
+
+   /*
+    * the correlation length needs the whole function
+    */
+   status = params_finish(ctx);
+   STATS_STOP(STATS_PARAMS,start);
+   return(status);
+}
+
+
+/*
+ * Routine:	params_finish()
+ *
+ * Description:	The parameters of the whole autocorrelation function,
+ *		after which the results are complete and are kept in
+ *		the context's cache, if it has one.
+ *
+ * Parameters:	ctx	<> the analysis context
+ *
+ * Returns:	TRUE	- successful calculation
+ *		FALSE	- no memory for the autocorrelation transform
+ *
+ * Date:	17/10/26
+ */
+static int params_finish(struct surf_context *ctx)
+{
+   if (autocorrelation_function(ctx) != TRUE)
+      return(FALSE);
+   (void) rcache_store(ctx);
 
    return(TRUE);
 }
 
-void autocorrelation_calculate()
+
+/*
+ * Routine:	height_params()
+ *
+ * Description:	Calculate Ra, Rq, Rsk, Rku, Rz, RSm and Rdq (ISO 4287)
+ *		from the sums of the pass over the levelled data (see
+ *		moments_heights()). Ra, Rq and Rz are in microns,
+ *		scaled by "y_division" like gamma0, while Rp, Rv and
+ *		Rt stay in the units of the data.
+ *		Rz is the mean peak to valley height of MOMENTS_LENGTHS
+ *		sampling lengths; RSm is the mean spacing of the upward
+ *		crossings of the mean line, without the height and
+ *		width discrimination of the standard; Rdq comes from
+ *		the seven point slopes, as heights in microns over
+ *		lengths in microns, so that it has no units. Spacings
+ *		are scaled by "x_division".
+ *
+ * Parameters:	ctx	<> the analysis context
+ *		h	< the sums
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ * Modified:	17/10/26: the sums come from calc_params()
+ */
+static void height_params(struct surf_context *ctx,
+   const struct surf_heights *h)
+{
+   double rq2;
+
+   ctx->params.ra = ctx->params.rq = 0.0;
+   ctx->params.rsk = ctx->params.rku = 0.0;
+   ctx->params.rz = ctx->params.rsm = ctx->params.rdq = 0.0;
+   if (h->n < 1)
+      return;
+
+   rq2 = h->sum_sq/h->n;
+   if (rq2 > 0.0) {
+      ctx->params.rsk = h->sum_cube/h->n/(rq2*sqrt(rq2));
+      ctx->params.rku = h->sum_quart/h->n/(rq2*rq2);
+   }
+   ctx->params.ra = ctx->y_division*h->sum_abs/h->n;
+   ctx->params.rq = ctx->y_division*sqrt(rq2);
+   ctx->params.rz = ctx->y_division*h->sum_range/h->num_lengths;
+   if (h->num_crossings > 1)
+      ctx->params.rsm = ctx->x_division*(h->last - h->first)
+         /(h->num_crossings - 1);
+   if (h->num_slopes > 0)
+      ctx->params.rdq = ctx->y_division*sqrt(h->sum_slope_sq/h->num_slopes)
+         /ctx->x_division;
+}
+
+void autocorrelation_calculate(struct surf_context *ctx,
+   const struct surf_moments *m)
 {     
-   int i;       
-	
+   double scale;
+
+   scale = ctx->y_division*ctx->y_division/ctx->num_data;
+
    // find first correlation coefficient
-   gamma0 = 0.0;
-   for(i=0;i<num_data;i++) {
-      gamma0 = gamma0 +  pow(data[i],2.0);
-   }
-   gamma0 = pow(y_division,2.0)*gamma0/num_data;
+   ctx->params.gamma0 = scale*m->sum_sq;
    
    // find second correlation coefficient
-	gamma1 = 0.0;
-   for(i=1;i<num_data;i++) {
-      gamma1 = gamma1 +  data[i]*data[i-1];
+   ctx->params.gamma1 = scale*m->sum_lag;
+}
+
+/*
+ * Routine:	autocorrelation_function()
+ *
+ * Description:	The autocorrelation function of the data at every lag,
+ *		scaled like gamma0 and gamma1, and the correlation
+ *		length. The function is the inverse transform of the
+ *		power spectrum (Wiener-Khinchin), in the context's
+ *		"precision" (see acf_transform()). The data are padded
+ *		with zeros to an integral power of 2 that is at least
+ *		twice their number, so that the lags of the circular
+ *		correlation do not wrap round onto each other.
+ *
+ * Parameters:	ctx	<> the analysis context
+ *
+ * Returns:	TRUE	- successful calculation
+ *		FALSE	- no memory for the transform plan
+ *
+ * Example:	autocorrelation_function(ctx);
+ *		ctx->acf[0] is gamma0, ctx->acf[1] is gamma1
+ *
+ * Date:	17/10/26
+ */
+int autocorrelation_function(struct surf_context *ctx)
+{
+   int length;
+   int status;
+
+   ctx->acf_num_data = ctx->num_data;
+   ctx->params.c_lambda = 0.0;
+   if (ctx->num_data < 1)
+      return(TRUE);
+
+   length = 2;
+   while (length < 2*ctx->num_data)
+      length = 2*length;
+   if (ctx->precision == PRECISION_FLOAT)
+      status = acf_transform_float(ctx,length);
+   else
+      status = acf_transform(ctx,length);
+   if (status != TRUE)
+      return(FALSE);
+
+   ctx->params.c_lambda = correlation_length(ctx);
+
+   return(TRUE);
+}
+
+
+/*
+ * Routine:	correlation_length()
+ *
+ * Description:	The first lag at which the autocorrelation function
+ *		falls to CORRELATION_LEVEL of its value at lag 0,
+ *		interpolated between samples and scaled by
+ *		"x_division". If it never falls that far, the length
+ *		of the profile is returned.
+ *
+ * Parameters:	ctx	< the analysis context, with the function
+ *
+ * Returns:	the correlation length
+ *
+ * Date:	17/10/26
+ */
+static double correlation_length(const struct surf_context *ctx)
+{
+   double level;
+   int i;
+
+   if (ctx->acf_num_data < 1 || ctx->acf[0] <= 0.0)
+      return(0.0);
+
+   level = CORRELATION_LEVEL*ctx->acf[0];
+   for(i=1;i<ctx->acf_num_data;i++) {
+      if (ctx->acf[i] <= level)
+         return(ctx->x_division*(i - 1 + (ctx->acf[i-1] - level)
+            /(ctx->acf[i-1] - ctx->acf[i])));
    }
-   gamma1 = pow(y_division,2.0)*gamma1/num_data;
+
+   return(ctx->x_division*(ctx->acf_num_data - 1));
 }
 
+
 /*
  * Routine:	print_params()
  *
  * Description:	Print my parameters
  *
- * Parameters:	none
+ * Parameters:	ctx	<> the analysis context
  *
  * Returns:	TRUE	- successful calculation
  *
@@ -287,14 +562,14 @@ void autocorrelation_calculate()
  *
  * Date:	23/7/91
  */
-int print_params()
+int print_params(struct surf_context *ctx)
 {
    // print the new parameters
    (void) printf("Parameters\n");
    (void) printf("--------------\n\n");
                               
-   autocorrelation_print();    
-   parameter_print();                          
+   autocorrelation_print(ctx);    
+   parameter_print(ctx);                          
 
    return(TRUE);
 }
@@ -303,31 +578,46 @@ int print_params()
 /*
  * Routines:	Functions for "autocorrelations"
  *
+ * Parameters:	ctx	<> the analysis context
+ *
  * Example:     
  *
  * Date:	10/5/94
  */
 
 
-void autocorrelation_print()
+void autocorrelation_print(struct surf_context *ctx)
 {  
 	(void) printf("\n");
    (void) printf("Autocorrelation values\n");
    (void) printf("----------------------\n\n");
-   (void) printf("first correlation coefficient: %12.4f microns\n",gamma0);
-   (void) printf("second autocorrelation coefficient: %12.4f microns\n",gamma1);
+   (void) printf("first correlation coefficient: %12.4f square microns\n",
+      ctx->params.gamma0);
+   (void) printf("second autocorrelation coefficient: %12.4f "
+      "square microns\n",ctx->params.gamma1);
 }
    
    
 
-void parameter_print()
+void parameter_print(struct surf_context *ctx)
 {  
    (void) printf("\n");
    (void) printf("Parameter values\n");
    (void) printf("----------------------\n\n");
-   (void) printf("rms value : %12.4f microns\n",sqrt(var));
-   (void) printf("Rp value : %12.4f microns\n",rp);
-   (void) printf("Rv value : %12.4f microns\n",rv);
-   (void) printf("Rt value : %12.4f microns\n",rt);
+   (void) printf("rms value : %12.4f microns\n",sqrt(ctx->params.var));
+   (void) printf("Rp value : %12.4f microns\n",ctx->params.rp);
+   (void) printf("Rv value : %12.4f microns\n",ctx->params.rv);
+   (void) printf("Rt value : %12.4f microns\n",ctx->params.rt);
+   (void) printf("Ra value : %12.4f microns\n",ctx->params.ra);
+   (void) printf("Rq value : %12.4f microns\n",ctx->params.rq);
+   (void) printf("Rsk value : %12.4f\n",ctx->params.rsk);
+   (void) printf("Rku value : %12.4f\n",ctx->params.rku);
+   (void) printf("Rz value : %12.4f microns\n",ctx->params.rz);
+   (void) printf("RSm value : %12.4f microns\n",ctx->params.rsm);
+   (void) printf("Rdq value : %12.4f\n",ctx->params.rdq);
+   (void) printf("correlation length : %12.4f microns\n",
+      ctx->params.c_lambda);
+   if (ctx->cutoff > 0.0)
+      (void) printf("roughness cutoff : %12.4f microns\n",ctx->cutoff);
  
 }
@@ -0,0 +1,124 @@
+/******************************************************************
+ * Module:	gauss.c
+ *
+ * Purpose:	The Gaussian profile filter (ISO 16610-21), splitting
+ *		a levelled profile into roughness and waviness.
+ *
+ * Contents:	gauss_filter()	- roughness and waviness profiles
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+#include <math.h>
+
+/*
+ * global definitions
+ */
+#include "global.h"
+#include "context.h"
+
+/*
+ * declarations
+ */
+#include "fft.h"
+#include "online.h"
+#include "gauss.h"
+#include "stats.h"
+
+
+/*
+ * Routine:	gauss_filter
+ *
+ * Description:	Split the levelled "data" into the mean line of the
+ *		Gaussian filter of cutoff wavelength "cutoff" (the
+ *		waviness, left in "smooth_data") and the roughness
+ *		about it (left in "data"), in one forward and one
+ *		inverse transform. The profile is padded with zeros by
+ *		at least a cutoff so that its ends do not wrap round
+ *		onto each other; within half a cutoff of either end the
+ *		mean line is nevertheless bent towards zero, as with
+ *		any filter that is not given samples beyond the
+ *		traverse. Nothing is done if the cutoff is not
+ *		positive. The statistics gathered while reading belong
+ *		to the unfiltered profile, so they are dropped.
+ *
+ * Parameters:	ctx	<> the analysis context
+ *
+ * Returns:	TRUE	- filtered, or no cutoff
+ *		ER_MEM	- no memory for the transform plan
+ *
+ * Example:	ctx->cutoff = 800.0;  * microns *
+ *		gauss_filter(ctx);
+ *
+ * Date:	17/10/26
+ */
+int gauss_filter(struct surf_context *ctx)
+{
+   struct fft_plan *plan;
+   double *re,*im;
+   double step,t,weight;
+   int reach,length,half;
+   int i;
+   STATS_TIMER(start);
+
+   if (ctx->cutoff <= 0.0 || ctx->num_data < 2)
+      return(TRUE);
+   STATS_START(start);
+
+   /*
+    * The weighting function is negligible beyond a cutoff either
+    * side, so that much padding keeps the ends apart. Padding by the
+    * whole profile keeps them apart whatever the cutoff, which also
+    * fits the autocorrelation arrays used here.
+    */
+   reach = (int) ceil(ctx->cutoff/ctx->x_division);
+   if (reach > ctx->num_data)
+      reach = ctx->num_data;
+   length = 2;
+   while (length < ctx->num_data + reach)
+      length = 2*length;
+   half = length/2;
+   plan = fft_plan_get(&ctx->plans,half);
+   if (plan == NULL) {
+      ctx->error_number = ER_MEM;
+      return(ER_MEM);
+   }
+   re = ctx->acf_re;
+   im = ctx->acf_im;
+
+   for(i=0;i<half;i++) {
+      re[i] = 2*i < ctx->num_data ? ctx->data[2*i] : 0.0;
+      im[i] = 2*i+1 < ctx->num_data ? ctx->data[2*i+1] : 0.0;
+   }
+   fft_plan_run_real(plan,re,im);
+
+   /*
+    * The transmission of the mean line at a wavelength lambda is
+    * exp(-pi*(alpha*cutoff/lambda)^2); coefficient i has wavelength
+    * length*x_division/i.
+    */
+   step = GAUSS_ALPHA*ctx->cutoff/(length*ctx->x_division);
+   for(i=0;i<=half;i++) {
+      t = step*i;
+      weight = exp(-0.5*TWO_PI*t*t);
+      re[i] = weight*re[i];
+      im[i] = weight*im[i];
+   }
+   fft_plan_run_real_inverse(plan,re,im);
+
+   /*
+    * the mean line, and the roughness about it
+    */
+   for(i=0;2*i<ctx->num_data;i++) {
+      ctx->smooth_data[2*i] = re[i];
+      ctx->data[2*i] -= re[i];
+      if (2*i+1 < ctx->num_data) {
+         ctx->smooth_data[2*i+1] = im[i];
+         ctx->data[2*i+1] -= im[i];
+      }
+   }
+   online_reset(&ctx->online);
+   STATS_STOP(STATS_FILTER,start);
+
+   return(TRUE);
+}
@@ -0,0 +1,634 @@
+/******************************************************************
+ * Module:	golden.c
+ *
+ * Purpose:	The accuracy of the transform, spectrum and parameters
+ *		of surf, in double or float, against a reference
+ *		computed the slow way in long double: a naive discrete
+ *		Fourier transform and direct sums. Run after changing
+ *		a numerical kernel.
+ *
+ * Contents:	main		- check every file in both transform modes
+ *		golden_check	- check one file in one mode
+ *		golden_values	- check an array of values
+ *		golden_spectrum	- the reference spectrum
+ *		golden_params	- the reference parameters
+ *		golden_compare	- relative error and ULP distance
+ *		golden_ordered	- a double as an ordered integer
+ *
+ * Date:	17/10/26
+ * Modified:	17/10/26: the autocorrelation function, and float
+ *		results that the double kernels gave
+ *****************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <math.h>
+
+/*
+ * global definitions
+ */
+#include "global.h"
+#include "context.h"
+
+/*
+ * declarations
+ */
+#include "surf.h"
+#include "moments.h"
+
+/*
+ * A value passes if it is within GOLDEN_REL of the reference or
+ * GOLDEN_ULPS units in the last place of it (unless "--rel" or
+ * "--ulps" are given). Spectral values below GOLDEN_FLOOR of the
+ * largest are measured against that, since the transform is only
+ * accurate relative to the whole spectrum. Float has its own
+ * defaults, and its autocorrelation function, found by a transform
+ * of twice the length, is measured against GOLDEN_FLOOR_ACF_FLOAT
+ * of gamma0.
+ */
+#define GOLDEN_REL 1e-9
+#define GOLDEN_ULPS 16
+#define GOLDEN_FLOOR 1e-12
+#define GOLDEN_REL_FLOAT 1e-3
+#define GOLDEN_FLOOR_FLOAT 1e-6
+#define GOLDEN_FLOOR_ACF_FLOAT 1e-3
+
+/*
+ * Structure:	golden_tolerance
+ *
+ * Description:	What a value is allowed to be out by, and what is
+ *		printed about it.
+ */
+struct golden_tolerance {
+   int precision;  /* of the analysis checked */
+   double rel;
+   double ulps;
+   double floor;
+   int bins;  /* TRUE to print every spectral value */
+};
+
+/*
+ * Structure:	golden_error
+ *
+ * Description:	How far a value is from its reference.
+ */
+struct golden_error {
+   double rel;  /* relative error */
+   double ulps;  /* units in the last place */
+   int pass;  /* TRUE if within tolerance */
+};
+
+/*
+ * Structure:	golden_param
+ *
+ * Description:	A parameter checked, and where it is in surf_params.
+ *		golden_params() gives the references in this order.
+ */
+struct golden_param {
+   const char *name;
+   size_t offset;
+};
+
+static const struct golden_param golden_param_list[] = {
+   {"var", offsetof(struct surf_params,var)},
+   {"rp", offsetof(struct surf_params,rp)},
+   {"rv", offsetof(struct surf_params,rv)},
+   {"rt", offsetof(struct surf_params,rt)},
+   {"gamma0", offsetof(struct surf_params,gamma0)},
+   {"gamma1", offsetof(struct surf_params,gamma1)},
+   {"c_lambda", offsetof(struct surf_params,c_lambda)},
+   {"ra", offsetof(struct surf_params,ra)},
+   {"rq", offsetof(struct surf_params,rq)},
+   {"rsk", offsetof(struct surf_params,rsk)},
+   {"rku", offsetof(struct surf_params,rku)},
+   {"rz", offsetof(struct surf_params,rz)},
+   {"rsm", offsetof(struct surf_params,rsm)},
+   {"rdq", offsetof(struct surf_params,rdq)}};
+
+#define GOLDEN_PARAMS \
+   ((int) (sizeof(golden_param_list)/sizeof(golden_param_list[0])))
+
+static int golden_check(struct surf_context *ctx, const char *filename,
+   int trans_mode, const struct golden_tolerance *tol);
+static int golden_values(const char *name, const double *value,
+   const long double *ref, int n, const struct golden_tolerance *tol);
+static int golden_spectrum(const double *z, int n, int t,
+   long double *spec);
+static int golden_params(const double *z, int n, double x_division,
+   double y_division, long double *ref, long double *acf);
+static void golden_compare(double value, long double ref, double scale,
+   const struct golden_tolerance *tol, struct golden_error *e);
+static long long golden_ordered(double x);
+
+
+/*
+ * Routine:	main
+ *
+ * Description:	Check each file named, with a padded and then an
+ *		exact transform, printing the largest error of the
+ *		spectrum and the error of each parameter.
+ *
+ *		golden [--precision float|double] [--rel r] [--ulps u]
+ *			[--floor f] [--bins] file...
+ *
+ * Parameters:	argc	< number of command line arguments
+ *		argv	< the command line arguments
+ *
+ * Returns:	TRUE		- every value within tolerance
+ *		FALSE		- a value out of tolerance
+ *		positive integer	- the first error
+ *
+ * Example:	golden data/m1g2.txt data/m1g3.txt
+ *
+ * Date:	17/10/26
+ */
+int main(int argc, char *argv[])
+{
+   struct golden_tolerance tol;
+   struct surf_context *ctx;
+   int result,status,files;
+   int i;
+
+   tol.precision = PRECISION_DOUBLE;
+   tol.rel = -1.0;
+   tol.ulps = GOLDEN_ULPS;
+   tol.floor = -1.0;
+   tol.bins = FALSE;
+   files = 0;
+   for(i=1;i<argc;i++) {
+      if (strcmp(argv[i],"--precision") == 0 && i+1 < argc)
+         tol.precision = strcmp(argv[++i],"float") == 0
+            ? PRECISION_FLOAT : PRECISION_DOUBLE;
+      else if (strcmp(argv[i],"--rel") == 0 && i+1 < argc)
+         tol.rel = atof(argv[++i]);
+      else if (strcmp(argv[i],"--ulps") == 0 && i+1 < argc)
+         tol.ulps = atof(argv[++i]);
+      else if (strcmp(argv[i],"--floor") == 0 && i+1 < argc)
+         tol.floor = atof(argv[++i]);
+      else if (strcmp(argv[i],"--bins") == 0)
+         tol.bins = TRUE;
+      else if (argv[i][0] == '-') {
+         (void) fprintf(stderr,"usage: golden [--precision float|double] "
+            "[--rel r] [--ulps u] [--floor f] [--bins] file...\n");
+         return(ER_COMPAT);
+      }
+      else
+         files++;
+   }
+   if (files == 0) {
+      (void) fprintf(stderr,"golden: no files\n");
+      return(ER_FIL);
+   }
+   if (tol.rel < 0.0)
+      tol.rel = tol.precision == PRECISION_FLOAT ? GOLDEN_REL_FLOAT
+         : GOLDEN_REL;
+   if (tol.floor < 0.0)
+      tol.floor = tol.precision == PRECISION_FLOAT ? GOLDEN_FLOOR_FLOAT
+         : GOLDEN_FLOOR;
+
+   ctx = context_create();
+   if (ctx == NULL) {
+      (void) fprintf(stderr,"%s\n",error_string(ER_MEM));
+      return(ER_MEM);
+   }
+
+   result = TRUE;
+   for(i=1;i<argc;i++) {
+      if (argv[i][0] == '-') {
+         if (strcmp(argv[i],"--bins") != 0)
+            i++;
+         continue;
+      }
+      status = golden_check(ctx,argv[i],TRANS_PADDED,&tol);
+      if (status == TRUE)
+         status = golden_check(ctx,argv[i],TRANS_EXACT,&tol);
+      if (status != TRUE && (result == TRUE || result == FALSE))
+         result = status;
+   }
+   (void) printf("%s\n",result == TRUE ? "all within tolerance"
+      : "OUT OF TOLERANCE");
+
+   context_destroy(ctx);
+
+   return(result);
+}
+
+
+/*
+ * Routine:	golden_check
+ *
+ * Description:	Analyse a file as surf does and compare its spectrum,
+ *		autocorrelation function and parameters with those of
+ *		the levelled profile found the slow way. In float, a
+ *		parameter exactly equal to the one found in double
+ *		fails too, since it cannot have come from the float
+ *		kernels.
+ *
+ * Parameters:	ctx		<> the analysis context
+ *		filename	< the file
+ *		trans_mode	< TRANS_PADDED or TRANS_EXACT
+ *		tol		< the tolerances
+ *
+ * Returns:	TRUE	- every value within tolerance
+ *		FALSE	- a value out of tolerance
+ *		ER_COUNT	- fewer than two samples
+ *		otherwise the error of the analysis, or ER_MEM
+ *
+ * Date:	17/10/26
+ *
+ * Modified:	17/10/26: the autocorrelation function, and float
+ *		results that the double kernels gave
+ *		17/10/26: fewer than two samples rejected
+ */
+static int golden_check(struct surf_context *ctx, const char *filename,
+   int trans_mode, const struct golden_tolerance *tol)
+{
+   struct surf_settings settings;
+   struct surf_result res;
+   struct surf_params params_double;
+   struct golden_tolerance acf_tol;
+   struct golden_error e;
+   long double ref[GOLDEN_PARAMS];
+   long double *spec,*acf;
+   double value;
+   int same,result;
+   int i;
+
+   surf_settings_default(&settings);
+   settings.trans_mode = trans_mode;
+
+   /*
+    * in float, the parameters found in double, which no float
+    * result should equal exactly
+    */
+   if (tol->precision == PRECISION_FLOAT) {
+      result = surf_analyze_file(ctx,filename,&settings,&res);
+      if (result != TRUE) {
+         (void) fprintf(stderr,"%s: %s\n",filename,error_string(result));
+         return(result);
+      }
+      params_double = res.params;
+   }
+
+   settings.precision = tol->precision;
+   result = surf_analyze_file(ctx,filename,&settings,&res);
+   if (result == TRUE && res.num_data < 2)
+      result = ER_COUNT;
+   if (result != TRUE) {
+      (void) fprintf(stderr,"%s: %s\n",filename,error_string(result));
+      return(result);
+   }
+
+   spec = (long double *) malloc(res.spec_num_data*sizeof(long double));
+   acf = (long double *) malloc(res.num_data*sizeof(long double));
+   if (spec == NULL || acf == NULL
+      || golden_spectrum(res.data,res.num_data,res.trans_num_data,spec)
+         != TRUE
+      || golden_params(res.data,res.num_data,ctx->x_division,
+         ctx->y_division,ref,acf) != TRUE) {
+      free(spec);
+      free(acf);
+      (void) fprintf(stderr,"%s: %s\n",filename,error_string(ER_MEM));
+      return(ER_MEM);
+   }
+
+   (void) printf("%s %s %s, %d samples, transform %d\n",filename,
+      trans_mode == TRANS_EXACT ? "exact" : "padded",
+      tol->precision == PRECISION_FLOAT ? "float" : "double",
+      res.num_data,res.trans_num_data);
+   result = TRUE;
+
+   /*
+    * the spectrum and the autocorrelation function, value by value
+    */
+   if (golden_values("spectrum",res.spec_data,spec,res.spec_num_data,tol)
+      != TRUE)
+      result = FALSE;
+   acf_tol = *tol;
+   if (tol->precision == PRECISION_FLOAT)
+      acf_tol.floor = fmax(tol->floor,GOLDEN_FLOOR_ACF_FLOAT);
+   if (golden_values("acf",res.acf,acf,res.acf_num_data,&acf_tol) != TRUE)
+      result = FALSE;
+
+   /*
+    * the parameters
+    */
+   for(i=0;i<GOLDEN_PARAMS;i++) {
+      value = *(const double *) ((const char *) &res.params
+         + golden_param_list[i].offset);
+      golden_compare(value,ref[i],0.0,tol,&e);
+      same = tol->precision == PRECISION_FLOAT
+         && value == *(const double *) ((const char *) &params_double
+         + golden_param_list[i].offset);
+      (void) printf("   %-9s %22.15e %22.15Le %9.2e %9.0f%s%s\n",
+         golden_param_list[i].name,value,ref[i],e.rel,e.ulps,
+         e.pass == TRUE ? "" : "  FAIL",same ? "  FAIL (as double)" : "");
+      if (e.pass != TRUE || same)
+         result = FALSE;
+   }
+
+   free(spec);
+   free(acf);
+   return(result);
+}
+
+
+/*
+ * Routine:	golden_values
+ *
+ * Description:	Compare an array of values with its references,
+ *		printing the largest errors and, with "--bins", every
+ *		value. Values are measured against the largest
+ *		reference times the floor when they are smaller.
+ *
+ * Parameters:	name	< what the values are
+ *		value	< the values found by surf
+ *		ref	< the references
+ *		n	< number of values
+ *		tol	< the tolerances
+ *
+ * Returns:	TRUE	- every value within tolerance
+ *		FALSE	- a value out of tolerance
+ *
+ * Date:	17/10/26
+ */
+static int golden_values(const char *name, const double *value,
+   const long double *ref, int n, const struct golden_tolerance *tol)
+{
+   struct golden_error e,worst_rel,worst_ulps;
+   double largest;
+   int at_rel,at_ulps,failed;
+   int i;
+
+   largest = 0.0;
+   for(i=0;i<n;i++)
+      largest = fmax(largest,fabs((double) ref[i]));
+   worst_rel.rel = worst_ulps.ulps = 0.0;
+   at_rel = at_ulps = 0;
+   failed = 0;
+   for(i=0;i<n;i++) {
+      golden_compare(value[i],ref[i],largest,tol,&e);
+      if (e.rel > worst_rel.rel) {
+         worst_rel = e;
+         at_rel = i;
+      }
+      if (e.ulps > worst_ulps.ulps) {
+         worst_ulps = e;
+         at_ulps = i;
+      }
+      if (e.pass != TRUE)
+         failed++;
+      if (tol->bins == TRUE)
+         (void) printf("   bin %6d %22.15e %22.15Le %9.2e %9.0f%s\n",i,
+            value[i],ref[i],e.rel,e.ulps,e.pass == TRUE ? "" : " FAIL");
+   }
+   (void) printf("   %-9s %6d bins  max rel %9.2e (bin %d)  "
+      "max ulps %.0f (bin %d)%s\n",name,n,worst_rel.rel,at_rel,
+      worst_ulps.ulps,at_ulps,failed == 0 ? "" : "  FAIL");
+
+   return(failed == 0 ? TRUE : FALSE);
+}
+
+
+/*
+ * Routine:	golden_spectrum
+ *
+ * Description:	The spectrum of a profile padded with zeros to "t"
+ *		samples, from the discrete Fourier transform summed
+ *		term by term, scaled like calculate_spectrum(). The
+ *		angles are reduced exactly, (k*j) mod t, before the
+ *		table of long double cosines and sines is looked up.
+ *
+ * Parameters:	z	< the levelled profile
+ *		n	< number of samples
+ *		t	< transform length, at least n and even
+ *		spec	> t/2+1 spectral values
+ *
+ * Returns:	TRUE	- calculated
+ *		ER_MEM	- no memory for the table
+ *
+ * Date:	17/10/26
+ */
+static int golden_spectrum(const double *z, int n, int t, long double *spec)
+{
+   long double *c,*s;
+   long double re,im;
+   long double pi;
+   long step,angle;
+   int j,k;
+
+   c = (long double *) malloc(t*sizeof(long double));
+   s = (long double *) malloc(t*sizeof(long double));
+   if (c == NULL || s == NULL) {
+      free(c);
+      free(s);
+      return(ER_MEM);
+   }
+   pi = 3.141592653589793238462643383279502884L;
+   for(j=0;j<t;j++) {
+      c[j] = cosl(2*pi*j/t);
+      s[j] = sinl(2*pi*j/t);
+   }
+
+   for(k=0;k<=t/2;k++) {
+      re = im = 0.0L;
+      step = k;
+      angle = 0;
+      for(j=0;j<n;j++) {
+         re += z[j]*c[angle];
+         im -= z[j]*s[angle];
+         angle += step;
+         if (angle >= t)
+            angle -= t;
+      }
+      spec[k] = (re*re + im*im)/t;
+      if (k > 0 && k < t/2)
+         spec[k] = 2*spec[k];
+   }
+
+   free(c);
+   free(s);
+   return(TRUE);
+}
+
+
+/*
+ * Routine:	golden_params
+ *
+ * Description:	The parameters of the levelled profile by their
+ *		definitions, in long double and in the order of
+ *		golden_param_list: the variance and extremes about the
+ *		mean, the autocorrelation at every lag by direct sums
+ *		and the correlation length from it, and the ISO 4287
+ *		parameters as height_params() defines them.
+ *
+ * Parameters:	z		< the levelled profile
+ *		n		< number of samples, at least 2
+ *		x_division	< x scaling factor
+ *		y_division	< y scaling factor
+ *		ref		> the references
+ *		acf		> the autocorrelation function, n values
+ *
+ * Returns:	TRUE	- calculated
+ *
+ * Date:	17/10/26
+ */
+static int golden_params(const double *z, int n, double x_division,
+   double y_division, long double *ref, long double *acf)
+{
+   long double mean,var,lo,hi,sum,level,slope;
+   long double abs1,sq,cube,quart,range,lo_j,hi_j,rq;
+   long double first,last,pos;
+   int lengths,crossings,start,end;
+   int i,j;
+
+   mean = 0.0L;
+   for(i=0;i<n;i++)
+      mean += z[i];
+   mean = mean/n;
+   var = 0.0L;
+   lo = hi = z[0];
+   for(i=0;i<n;i++) {
+      var += (z[i] - mean)*(z[i] - mean);
+      lo = z[i] < lo ? z[i] : lo;
+      hi = z[i] > hi ? z[i] : hi;
+   }
+   ref[0] = (long double) y_division*y_division*var/n;
+   ref[1] = hi - mean > 0.0L ? y_division*(hi - mean) : 0.0L;
+   ref[2] = mean - lo > 0.0L ? y_division*(mean - lo) : 0.0L;
+   ref[3] = ref[1] + ref[2];
+
+   for(i=0;i<n;i++) {
+      sum = 0.0L;
+      for(j=0;j+i<n;j++)
+         sum += (long double) z[j]*z[j+i];
+      acf[i] = (long double) y_division*y_division*sum/n;
+   }
+   ref[4] = acf[0];
+   ref[5] = n > 1 ? acf[1] : 0.0L;
+   ref[6] = x_division*(n - 1.0L);
+   level = acf[0]*0.36787944117144232159552377016146087L;
+   for(i=1;i<n;i++) {
+      if (acf[i] <= level) {
+         ref[6] = x_division*(i - 1 + (acf[i-1] - level)
+            /(acf[i-1] - acf[i]));
+         break;
+      }
+   }
+   if (acf[0] <= 0.0L)
+      ref[6] = 0.0L;
+
+   abs1 = sq = cube = quart = 0.0L;
+   for(i=0;i<n;i++) {
+      abs1 += fabsl(z[i]);
+      sq += (long double) z[i]*z[i];
+      cube += (long double) z[i]*z[i]*z[i];
+      quart += (long double) z[i]*z[i]*z[i]*z[i];
+   }
+   rq = sqrtl(sq/n);
+   ref[7] = y_division*abs1/n;
+   ref[8] = y_division*rq;
+   ref[9] = rq > 0.0L ? cube/n/(rq*rq*rq) : 0.0L;
+   ref[10] = rq > 0.0L ? quart/n/(rq*rq*rq*rq) : 0.0L;
+
+   lengths = n >= MOMENTS_LENGTHS ? MOMENTS_LENGTHS : 1;
+   range = 0.0L;
+   for(j=0;j<lengths;j++) {
+      start = (int) ((long) j*n/lengths);
+      end = (int) ((long) (j+1)*n/lengths);
+      lo_j = hi_j = z[start];
+      for(i=start;i<end;i++) {
+         lo_j = z[i] < lo_j ? z[i] : lo_j;
+         hi_j = z[i] > hi_j ? z[i] : hi_j;
+      }
+      range += hi_j - lo_j;
+   }
+   ref[11] = y_division*range/lengths;
+
+   crossings = 0;
+   first = last = 0.0L;
+   for(i=1;i<n;i++) {
+      if (z[i-1] < 0.0 && z[i] >= 0.0) {
+         pos = i-1 + (long double) z[i-1]/((long double) z[i-1] - z[i]);
+         if (crossings == 0)
+            first = pos;
+         last = pos;
+         crossings++;
+      }
+   }
+   ref[12] = crossings > 1 ? x_division*(last - first)/(crossings - 1)
+      : 0.0L;
+
+   sum = 0.0L;
+   for(i=3;i<n-3;i++) {
+      slope = ((long double) z[i+3] - 9.0L*z[i+2] + 45.0L*z[i+1]
+         - 45.0L*z[i-1] + 9.0L*z[i-2] - z[i-3])/60.0L;
+      sum += slope*slope;
+   }
+   ref[13] = n > 6 ? y_division*sqrtl(sum/(n-6))/x_division : 0.0L;
+
+   return(TRUE);
+}
+
+
+/*
+ * Routine:	golden_compare
+ *
+ * Description:	The relative error of a value and its distance in
+ *		units in the last place from the reference rounded to
+ *		double. The relative error is taken against "scale"
+ *		times the floor if the reference is smaller than that.
+ *
+ * Parameters:	value	< the value found by surf
+ *		ref	< the reference
+ *		scale	< the largest of its kind, or 0
+ *		tol	< the tolerances
+ *		e	> the error
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+static void golden_compare(double value, long double ref, double scale,
+   const struct golden_tolerance *tol, struct golden_error *e)
+{
+   long double size;
+
+   size = fabsl(ref);
+   if (size < tol->floor*scale)
+      size = tol->floor*scale;
+   if (size > 0.0L)
+      e->rel = (double) (fabsl(value - ref)/size);
+   else
+      e->rel = value == 0.0 ? 0.0 : HUGE_VAL;
+   e->ulps = fabs((double) (golden_ordered(value)
+      - golden_ordered((double) ref)));
+   e->pass = e->rel <= tol->rel || e->ulps <= tol->ulps ? TRUE : FALSE;
+}
+
+
+/*
+ * Routine:	golden_ordered
+ *
+ * Description:	A double as an integer that counts the doubles between
+ *		it and zero, negative for negative values, so that the
+ *		difference of two is their distance in units in the
+ *		last place.
+ *
+ * Parameters:	x	< the double
+ *
+ * Returns:	its place among the doubles
+ *
+ * Date:	17/10/26
+ */
+static long long golden_ordered(double x)
+{
+   long long bits;
+
+   (void) memcpy(&bits,&x,sizeof(bits));
+   if (bits < 0)
+      bits = -(bits & 0x7fffffffffffffffLL);
+   return(bits);
+}
@@ -3,12 +3,30 @@
  *
  * Purpose:	Read a file created on the Talysurf.
  *
- * Contents:	load()		- read the file
+ * Contents:	load()		- read the file named by the user
+ *		load_file()	- read a named file
+ *		load_raw()	- read a named file, text or binary
+ *		load_text()	- read a file held in memory
  *		check_mag()	- check number read is within range
  *		check_filter()	- check value read is within range
  *		put_smoothed()	- save smoothed data
  *
  * Date:	22/5/91
+ * Modified:	17/10/26: files are mapped into memory and read with
+ *		parse_int() and parse_double() rather than fscanf(), and
+ *		the number of samples is checked.
+ *		17/10/26: binary (".surfb") files are recognised and
+ *		read by surfb_read().
+ *		17/10/26: the statistics of the profile (online.h) are
+ *		gathered as the samples are read.
+ *		17/10/26: put_smoothed() saves the smoothed bands.
+ *		17/10/26: the arrays are sized for each file, which may
+ *		hold a traverse of any length (FILTER_FREE).
+ *		17/10/26: a levelled profile may be split into
+ *		roughness and waviness (gauss.h).
+ *		17/10/26: put_smoothed() writes full precision at once.
+ *		17/10/26: load_raw() is timed and counts what it reads
+ *		(see stats.h).
  *****************************************************************/
 
 
@@ -17,12 +35,22 @@
  * require routines to read data from files
  */
 #include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 /*
  * global definitions
  */
 #include "global.h"
+#include "context.h"
 #include "maths.h"
+#include "parse.h"
+#include "surfb.h"
+#include "gauss.h"
+#include "writer.h"
+#include "stats.h"
 
 /*
  * definitions of horizontal and vertical magnifications
@@ -36,7 +64,7 @@
  * "mag[1]" is magnification number 1, which, when plotted on
  * Talysurf paper, has a range of +/- 50 microns.
  */
-double mag[] = {0,
+const double mag[] = {0,
   50,
   25,
   12.5,
@@ -46,20 +74,13 @@ double mag[] = {0,
   0.5,
   0.25};
 
-/*
- * global variables
- */
-int filter_set;  /* filter setting of Talysurf */
-int mag_set;  /* magnification setting of Talysurf */
-double x_division;  /* scaling factor for x axis */
-double y_division;  /* scaling factor for y axis */
-
 /*
  * Routine:	load
  *
- * Description: Read a data file created by the Talysurf.
+ * Description: Read a data file created by the Talysurf, asking the
+ *		user for its name.
  *
- * Parameters:	none
+ * Parameters:	ctx	<> the analysis context
  *
  * Returns:	TRUE	- no errors
  *		ER_FIL	- file not found
@@ -70,13 +91,9 @@ double y_division;  /* scaling factor for y axis */
  *
  * Date:	22/5/91
  */
-int load()
+int load(struct surf_context *ctx)
 {
    char filename[MAX_FIL_LEN];  /* the name of the file to be read */
-   FILE *f;  /* file handle */
-   unsigned char ch[4];  /* current sample read */
-   int byte;  /* the number of the current byte being read */
-   int sample_num;  /* count through the samples */
  
    /*
     * get the file name
@@ -86,15 +103,179 @@ int load()
    (void) fscanf(stdin,"%s",filename);
    clrscr();
 
+   return(load_file(ctx,filename));
+}
+
+
+/*
+ * Routine:	load_file
+ *
+ * Description: Read a named data file created by the Talysurf, text
+ *		or binary (see load_raw()), and re-calculate the data
+ *		relative to the best fitting line. The best fitting
+ *		line and the parameters of the levelled profile come
+ *		from the statistics gathered while reading. With a
+ *		"cutoff" the levelled profile is then split into
+ *		roughness and waviness (see gauss_filter()).
+ *
+ * Parameters:	ctx		<> the analysis context
+ *		filename	< the name of the file to be read
+ *
+ * Returns:	TRUE	- no errors
+ *		ER_FIL	- file not found
+ *		ER_MAG	- magnification number invalid
+ *		ER_FILT	- filter setting invalid
+ *		ER_COMPAT	- a setting or sample is not a number, or
+ *			  the binary file is damaged
+ *		ER_COUNT	- too few or too many samples
+ *		ER_MEM	- no memory for the samples or the filter
+ *
+ * Example:	load_file(ctx,"data/m1g2.txt");
+ *
+ * Date:	17/10/26
+ */
+int load_file(struct surf_context *ctx, const char *filename)
+{
+   int result;
+
+   result = load_raw(ctx,filename);
+
+   /*
+    * Re-calculate data relative to the best fitting line (in a mean-
+    * squared error sense)
+    */
+   if (result == TRUE) {
+      remove_bias(ctx);
+
+      /*
+       * separate the roughness from the waviness, if asked
+       */
+      result = gauss_filter(ctx);
+   }
+
+   return(result);
+}
+
+
+/*
+ * Routine:	load_raw
+ *
+ * Description: Read the settings and samples of a named data file,
+ *		as they are in the file. The file is mapped into memory;
+ *		a binary file (see surfb.h) is recognised by its first
+ *		bytes and its samples are copied straight out of the
+ *		map, while the numbers of a text file are read from it
+ *		in place (see parse.h).
+ *
+ * Parameters:	ctx		<> the analysis context
+ *		filename	< the name of the file to be read
+ *
+ * Returns:	TRUE	- no errors
+ *		ER_FIL	- file not found
+ *		ER_MAG	- magnification number invalid
+ *		ER_FILT	- filter setting invalid
+ *		ER_COMPAT	- a setting or sample is not a number, or
+ *			  the binary file is damaged
+ *		ER_COUNT	- too few or too many samples
+ *		ER_MEM	- no memory for the samples
+ *
+ * Example:	load_raw(ctx,"data/m1g2.surfb");
+ *
+ * Date:	17/10/26
+ */
+int load_raw(struct surf_context *ctx, const char *filename)
+{
+   int fd;  /* file descriptor */
+   struct stat info;
+   char *text;  /* the mapped file */
+   size_t size;
+   int result;
+   STATS_TIMER(start);
+
+   /*
+    * the results of the last profile, even if they came from the
+    * cache, are not those of this one
+    */
+   ctx->cached = FALSE;
+
    /*
     * the file to be "read"
     */
-   f = fopen(filename,"r");
+   STATS_START(start);
+   fd = open(filename,O_RDONLY);
+   if (fd < 0) {
+      ctx->error_number = ER_FIL;
+      return(ER_FIL);
+   }
+   if (fstat(fd,&info) != 0) {
+      close(fd);
+      ctx->error_number = ER_FIL;
+      return(ER_FIL);
+   }
 
-   if (f==NULL) {
-      error_number = ER_FIL;
+   /*
+    * an empty file cannot be mapped, and has no settings anyway
+    */
+   size = (size_t) info.st_size;
+   if (size == 0) {
+      close(fd);
+      ctx->error_number = ER_COMPAT;
+      return(ER_COMPAT);
+   }
+
+   text = (char *) mmap(NULL,size,PROT_READ,MAP_PRIVATE,fd,0);
+   close(fd);
+   if (text == (char *) MAP_FAILED) {
+      ctx->error_number = ER_FIL;
       return(ER_FIL);
    }
+   (void) madvise(text,size,MADV_SEQUENTIAL);
+
+   /*
+    * the statistics are gathered as the samples are read
+    */
+   online_reset(&ctx->online);
+   if (surfb_is_binary(text,size) == TRUE)
+      result = surfb_read(ctx,text,size);
+   else
+      result = load_text(ctx,text,text+size);
+   munmap(text,size);
+
+   STATS_STOP(STATS_LOAD,start);
+   STATS_COUNT(STATS_BYTES,(long) size);
+   if (result == TRUE) {
+      STATS_COUNT(STATS_PROFILES,1);
+      STATS_COUNT(STATS_SAMPLES,ctx->num_data);
+   }
+   return(result);
+}
+
+
+/*
+ * Routine:	load_text
+ *
+ * Description: Read the settings and samples of a Talysurf data file
+ *		held in memory.
+ *
+ * Parameters:	ctx	<> the analysis context
+ *		text	< the contents of the file
+ *		end	< one past the last character
+ *
+ * Returns:	TRUE	- no errors
+ *		ER_MAG	- magnification number invalid
+ *		ER_FILT	- filter setting invalid
+ *		ER_COMPAT	- a setting or sample is not a number
+ *		ER_COUNT	- too few or too many samples
+ *		ER_MEM	- no memory for the samples
+ *
+ * Example:	load_text(ctx,"3 2 -7.719728 ...",end);
+ *
+ * Date:	17/10/26
+ */
+int load_text(struct surf_context *ctx, const char *text, const char *end)
+{
+   const char *p;
+   int sample_num;  /* count through the samples */
 
    /*
     * The first item in the file describes the magnification and
@@ -102,52 +283,71 @@ int load()
     *  magnification setting (range 1 to 8) = first nibble
     *  filter setting (range 1 to 3) = second nibble
     */
-   fscanf(f,"%d",&mag_set);
-   fscanf(f,"%d",&filter_set);
+   p = parse_int(parse_space(text,end),end,&ctx->mag_set);
+   if (p != NULL)
+      p = parse_int(parse_space(p,end),end,&ctx->filter_set);
+   if (p == NULL) {
+      ctx->error_number = ER_COMPAT;
+      return(ER_COMPAT);
+   }
 
    /*
     * Check that the magnification number is within range.
     */
-   if (check_mag() != TRUE){
-      fclose(f);
+   if (check_mag(ctx) != TRUE)
       return(ER_MAG);
-   }
 
    /*
     * Check that the filter setting is within range and determine the
     * number of samples to be acquired from the file.
     */
-   if (check_filter() != TRUE){
-      fclose(f);
+   if (check_filter(ctx) != TRUE)
       return(ER_FILT);
-   }
 
    /*
     * calculate the scaling factors
     */
-   x_division = SAMPLE_INT;
-   y_division = mag[mag_set]/HSD_SAMPLES;
+   ctx->x_division = SAMPLE_INT;
+   ctx->y_division = mag[ctx->mag_set]/HSD_SAMPLES;
 
    /*
-    * Read the data from file
+    * a traverse of any length is as long as the file, and the arrays
+    * are sized to fit; it needs two samples for a line to be taken
+    * off
     */
-   sample_num = 0;
-   while (sample_num<num_data) {
-      fscanf(f,"%lf",&data[sample_num++]);
+   if (ctx->filter_set == FILTER_FREE) {
+      ctx->num_data = parse_count(p,end);
+      if (ctx->num_data < 2) {
+         ctx->error_number = ER_COUNT;
+         return(ER_COUNT);
+      }
    }
+   if (context_reserve(ctx,ctx->num_data) != TRUE)
+      return(ER_MEM);
 
    /*
-    * Re-calculate data relative to the best fitting line (in a mean-
-    * squared error sense)
+    * Read the data, which must be exactly the number of samples
+    * taken with this filter
     */
-   remove_bias();
-
-   /*
-    * Data has been acquired
-    */
-   fclose(f);
+   for(sample_num=0;sample_num<ctx->num_data;sample_num++) {
+      p = parse_space(p,end);
+      if (p == end) {
+         ctx->error_number = ER_COUNT;
+         return(ER_COUNT);
+      }
+      p = parse_double(p,end,&ctx->data[sample_num]);
+      if (p == NULL) {
+         ctx->error_number = ER_COMPAT;
+         return(ER_COMPAT);
+      }
+      (void) online_add(&ctx->online,ctx->data[sample_num]);
+   }
+   if (parse_space(p,end) != end) {
+      ctx->error_number = ER_COUNT;
+      return(ER_COUNT);
+   }
 
-  return(TRUE);
+   return(TRUE);
 }
 
 
@@ -156,21 +356,21 @@ int load()
  *
  * Description: Check that the magnification number is within range.
  *
- * Parameters:
+ * Parameters:	ctx	<> the analysis context
  *
  * Returns:	TRUE	- magnification setting is valid
  *		ER_MAG	- magnification setting is invalid
  *
  * Example:     mag_set = 3;
- *		check_mag(3);
+ *		check_mag(ctx);
  *		return(TRUE);  * assuming 3<=NUM_MAG_SETTINGS) *
  *
  * Date:	22/5/91
  */
-int check_mag()
+int check_mag(struct surf_context *ctx)
 {
-   if (mag_set<1 || mag_set>NUM_MAG_SETTINGS) {
-      error_number = ER_MAG;
+   if (ctx->mag_set<1 || ctx->mag_set>NUM_MAG_SETTINGS) {
+      ctx->error_number = ER_MAG;
       return(ER_MAG);
    }
    return(TRUE);
@@ -180,33 +380,38 @@ int check_mag()
 /*
  * Routine:	check_filter
  *
- * Description: Check that the filter setting is within range.
+ * Description: Check that the filter setting is within range, and
+ *		set the number of samples taken with the filter (0
+ *		for FILTER_FREE).
  *
- * Parameters:
+ * Parameters:	ctx	<> the analysis context
  *
  * Returns:	TRUE	- filter setting is valid
  *		ER_FILT	- filter setting is invalid
  *
  * Example:     filter_set = 3;  * L type filter *
- *		check_filter(3);
+ *		check_filter(ctx);
  *		return(TRUE);
  *
  * Date:	22/5/91
  */
-int check_filter()
+int check_filter(struct surf_context *ctx)
 {
-   switch (filter_set) {
+   switch (ctx->filter_set) {
       case FILTER_J:
-	 num_data = FILTER_J_SAMPLES;
+	 ctx->num_data = FILTER_J_SAMPLES;
 	 break;
       case FILTER_K:
-	 num_data = FILTER_K_SAMPLES;
+	 ctx->num_data = FILTER_K_SAMPLES;
 	 break;
       case FILTER_L:
-	 num_data = FILTER_L_SAMPLES;
+	 ctx->num_data = FILTER_L_SAMPLES;
+	 break;
+      case FILTER_FREE:
+	 ctx->num_data = 0;  /* found from the file */
 	 break;
       default:
-	 error_number = ER_FILT;
+	 ctx->error_number = ER_FILT;
 	 return(ER_FILT);
    }
    return(TRUE);
@@ -216,9 +421,12 @@ int check_filter()
 /*
  * Routine:	put_smoothed
  *
- * Description: Save the current smoothed spectral data
+ * Description: Save the current smoothed spectral data: the number
+ *		of bands, then the first subscript and mean value of
+ *		each band and, if any profiles have been combined, the
+ *		saved average of the band.
  *
- * Parameters:	none
+ * Parameters:	ctx	<> the analysis context
  *
  * Returns:	TRUE	- success
  *		ER_FIL	- file not found
@@ -226,11 +434,17 @@ int check_filter()
  * Example:     
  *
  * Date:	2/7/91
+ * Modified:	17/10/26: the bands of smooth_spectrum() rather than
+ *		the raw spectral data
+ *		17/10/26: values to full precision (see writer_double()),
+ *		formatted in memory and written at once
  */
-int put_smoothed()
+int put_smoothed(struct surf_context *ctx)
 {
    char filename[MAX_FIL_LEN];  /* the name of the file to be read */
    FILE *f;  /* file handle */
+   char text[SMOOTH_MAX_DATA*(2*WRITER_DOUBLE_LEN + 24) + 16];
+   char *q;  /* end of the text */
    int i;  /* count through data */
  
    /*
@@ -245,18 +459,30 @@ int put_smoothed()
     */
    f = fopen(filename,"w");
    if (f==NULL) {
-      error_number = ER_FIL;
+      ctx->error_number = ER_FIL;
       return(ER_FIL);
    }
 
    /* 
     * save smoothed spectral data
     */
-   if (tfm_valid == TRUE) {
-      (void) fprintf(f,"%d\n",num_data);
-      for(i=0;i<num_data;i++) {
-         (void) fprintf(f,"%d  ",i);
-         (void) fprintf(f,"%ld\n",spec_data[i]);
+   if (ctx->tfm_valid == TRUE) {
+      q = text + sprintf(text,"%d\n",ctx->smooth_num_data);
+      for(i=0;i<ctx->smooth_num_data;i++) {
+         q += sprintf(q,"%d  ",ctx->smooth[i].subscr);
+         q += writer_double(q,ctx->smooth[i].data);
+         if (ctx->num_combinations > 0
+            && ctx->saved_num_data == ctx->smooth_num_data) {
+            *q++ = ' ';
+            *q++ = ' ';
+            q += writer_double(q,ctx->saved_smooth[i].data);
+         }
+         *q++ = '\n';
+      }
+      if (fwrite(text,1,q-text,f) != (size_t) (q-text)) {
+         fclose(f);
+         ctx->error_number = ER_FIL;
+         return(ER_FIL);
       }
    }
 
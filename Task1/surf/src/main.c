@@ -3,17 +3,21 @@
  *
  * Purpose:	Analyze data acquired from the Talysurf.
  *
- * Contents:	main		- controls the program
- *		assign_memory	- grab memory needed by the
- *				  arrays of the program
+ * Contents:	main		- controls the program, interactively
+ *				  or in batch mode
+ *		invalid_input	- respond to an invalid key press
  *
  * Date:	22/5/91
+ * Modified:	17/10/26: "--cache", results kept on disk
+ *		17/10/26: 'o', the form taken off a profile
+ *		17/10/26: "--stats", the time of each stage
  *****************************************************************/
 
 /*
  * global definitions
  */
 #include "global.h"
+#include "context.h"
 
 /*
  * declarations
@@ -23,112 +27,277 @@
 #include "fourier.h"
 #include "complex.h"
 #include "error.h"
+#include "batch.h"
+#include "pool.h"
+#include "welch.h"
+#include "smooth.h"
+#include "rcache.h"
+#include "form.h"
+#include "stats.h"
 
-/*
- * data are valid if already read from a file, transform values if
- * transform has been calculated for the data currently in memory, and
- * dxf_valid if a graph is to be plotted in dxf format.
- */
-int data_valid;
-int tfm_valid;
+#include <string.h>
+#include <stdlib.h>
 
 /*
  * Routine:	main
  *
- * Description:	Control the running of the program.
+ * Description:	Control the running of the program. With "--batch"
+ *		on the command line the files named there are analysed
+ *		without any user input (see batch_run()); otherwise the
+ *		user is prompted for options. "--cache" keeps the
+ *		results of each profile in a directory, within
+ *		"--cache-size" megabytes, so that loading one analysed
+ *		before finds them there (see rcache.h). "--stats"
+ *		times the stages of every analysis and counts what
+ *		they read, printing them as a table, or as JSON with
+ *		"--stats=json", when the program ends: on stderr
+ *		after a batch, on stdout on 'e' (see stats.h). Built
+ *		without SURF_STATS there is nothing to print.
  *
- * Parameters:	none
+ *		surf [--cache dir [--cache-size mb]] [--stats[=text|json]]
+ *
+ * Parameters:	argc	< number of command line arguments
+ *		argv	< the command line arguments
  *
  * Returns:	TRUE 			- successful completion
  *		positive integer	- unsuccessful
  *
- * Example:
+ * Example:	surf --batch data --out results.csv
  *
  * Date:	22/5/91
+ * Modified:	17/10/26: "--cache"
+ *		17/10/26: 'o'
+ *		17/10/26: "--stats"
  */
-main()
+int main(int argc, char *argv[])
 {
+   struct surf_context *ctx; /* the profile being analysed */
    int option; /* user input */
+   char window[MAX_FIL_LEN]; /* name of a Welch window */
+   char form[MAX_FIL_LEN]; /* name of a form */
+   char *cache_name; /* the results cache, NULL for none */
+   long cache_mb; /* its size in megabytes */
+   int stats_format; /* STATS_TEXT or STATS_JSON, FALSE for none */
+   int result;
+   int i;
+
+   /*
+    * the timings, if asked for, before any workers are started
+    */
+   stats_format = FALSE;
+   for(i=1;i<argc;i++) {
+      if (strcmp(argv[i],"--stats") == 0)
+         stats_format = STATS_TEXT;
+      else if (strncmp(argv[i],"--stats=",8) == 0) {
+         stats_format = stats_format_name(argv[i]+8);
+         if (stats_format == FALSE) {
+            (void) fprintf(stderr,"%s: unknown statistics format\n",
+               argv[i]+8);
+            return(ER_FIL);
+         }
+      }
+   }
+#ifdef SURF_STATS
+   if (stats_format != FALSE)
+      stats_enable();
+#else
+   if (stats_format != FALSE) {
+      (void) fprintf(stderr,"surf: built without SURF_STATS, "
+         "--stats ignored\n");
+      stats_format = FALSE;
+   }
+#endif
+
+   /*
+    * batch mode
+    */
+   for(i=1;i<argc;i++) {
+      if (strcmp(argv[i],"--batch") == 0) {
+         result = batch_run(argc,argv);
+         if (stats_format != FALSE)
+            stats_print(stderr,stats_format);
+         return(result);
+      }
+   }
 
    /*
-    * assign memory to the data and transform arrays
+    * assign memory to the data and transform arrays; the valid
+    * flags start FALSE
     */
-   if (assign_memory() != TRUE) {
-      (void) print_error();
-      return(error_number);
+   ctx = context_create();
+   if (ctx == NULL) {
+      (void) print_error(ER_MEM);
+      return(ER_MEM);
    }
 
    /*
-    * set up valid flags
+    * workers for the segments of a Welch spectrum; without them the
+    * segments are transformed one after another
     */
-   data_valid = FALSE;
-   tfm_valid = FALSE;
+   ctx->pool = pool_create(0);
+
+   /*
+    * the results cache, if asked for
+    */
+   cache_name = NULL;
+   cache_mb = RCACHE_DEFAULT_MB;
+   for(i=1;i<argc;i++) {
+      if (strcmp(argv[i],"--cache") == 0 && i+1 < argc)
+         cache_name = argv[++i];
+      else if (strcmp(argv[i],"--cache-size") == 0 && i+1 < argc)
+         cache_mb = atol(argv[++i]);
+   }
+   if (cache_name != NULL) {
+      ctx->cache = rcache_open(cache_name,cache_mb << 20);
+      if (ctx->cache == NULL) {
+         (void) print_error(ER_FIL);
+         return(ER_FIL);
+      }
+   }
 
    /*
     * wait for an input
     */
    while (1) {
-      printf("Enter your option (l,f,p,m,e): ");
+      printf("Enter your option (l,f,p,m,x,w,b,a,c,o,e): ");
       option=getc(stdin);
       /*
        * respond to the user input
        */
       switch(option) {
-         case 'l': if (load() != TRUE) {       /* load data */
-                      (void) print_error();
-                      return(error_number);
+         case 'l': if (load(ctx) != TRUE) {       /* load data */
+                      (void) print_error(ctx->error_number);
+                      return(ctx->error_number);
                    }
-                   data_valid = TRUE;
-			 tfm_valid = FALSE;
+                   ctx->data_valid = TRUE;
+			 ctx->tfm_valid = FALSE;
 
                    break;
 
-         case 'f': if (data_valid == TRUE) {
-	 	      			 if (tfm_valid == FALSE) {   
-                         if (calculate_fft() != TRUE) {   /* perform fft */
-                            (void) print_error();
-                            return(error_number);
+         case 'f': if (ctx->data_valid == TRUE) {
+	 	      			 if (ctx->tfm_valid == FALSE) {   
+                         if (calculate_fft(ctx) != TRUE) {   /* perform fft */
+                            (void) print_error(ctx->error_number);
+                            return(ctx->error_number);
                          }
 		      			 }
-		      			 tfm_valid = TRUE;
+		      			 ctx->tfm_valid = TRUE;
                      }
                    break;
 
-	 case 'p': if (tfm_valid == TRUE) {
-		      	  if (calc_params() != TRUE) {
-			 			  (void) print_error();
-			 			  return(error_number);
+	 case 'p': if (ctx->tfm_valid == TRUE) {
+		      	  if (calc_params(ctx) != TRUE) {
+			 			  (void) print_error(ctx->error_number);
+			 			  return(ctx->error_number);
 		      	  }
-                 if (put_smoothed() != TRUE) {
-			 			  (void) print_error();
+                 if (put_smoothed(ctx) != TRUE) {
+			 			  (void) print_error(ctx->error_number);
 		      	  }
 		      	  getc(stdin);
 		   	  }
 		   	  break;
 		    
-    case 'm': if (data_valid == TRUE && tfm_valid == TRUE) {
-		      	  if (calc_params() != TRUE) {
-			 			  (void) print_error();
-			 			  return(error_number);
+    case 'm': if (ctx->data_valid == TRUE && ctx->tfm_valid == TRUE) {
+		      	  if (calc_params(ctx) != TRUE) {
+			 			  (void) print_error(ctx->error_number);
+			 			  return(ctx->error_number);
 		      	  }
-		      	  if (print_params() != TRUE) {
-			 			  (void) print_error();
-			 			  return(error_number);
+		      	  if (print_params(ctx) != TRUE) {
+			 			  (void) print_error(ctx->error_number);
+			 			  return(ctx->error_number);
 		      	  }
 		   	  }
 		   	  break;
 
+    case 'x': if (ctx->trans_mode == TRANS_PADDED) {
+                 ctx->trans_mode = TRANS_EXACT;
+                 printf("transform length: exact\n");
+              }
+              else {
+                 ctx->trans_mode = TRANS_PADDED;
+                 printf("transform length: padded to power of 2\n");
+              }
+              ctx->tfm_valid = FALSE;
+              break;
+
+    case 'w': printf("Enter the segment length (0 for one periodogram): ");
+              (void) fscanf(stdin,"%d",&ctx->welch_length);
+              if (ctx->welch_length > 0) {
+                 printf("Enter the overlap: ");
+                 (void) fscanf(stdin,"%d",&ctx->welch_overlap);
+                 printf("Enter the window (hann, hamming, blackman): ");
+                 (void) fscanf(stdin,"%39s",window);
+                 if (welch_window_name(window) != FALSE)
+                    ctx->welch_window = welch_window_name(window);
+                 else
+                    invalid_input();
+              }
+              ctx->tfm_valid = FALSE;
+              break;
+
+    case 'b': if (ctx->smooth_mode == SMOOTH_LINEAR) {
+                 ctx->smooth_mode = SMOOTH_LOG;
+                 printf("smoothing bands: log spaced\n");
+              }
+              else {
+                 ctx->smooth_mode = SMOOTH_LINEAR;
+                 printf("smoothing bands: linear\n");
+              }
+              smooth_clear(ctx);
+              ctx->tfm_valid = FALSE;
+              break;
+
+    case 'c': printf("Enter the cutoff wavelength (0 for no filter): ");
+              (void) fscanf(stdin,"%lf",&ctx->cutoff);
+              printf("the cutoff applies to the next profile loaded\n");
+              ctx->data_valid = FALSE;
+              ctx->tfm_valid = FALSE;
+              break;
+
+    case 'o': printf("Enter the form (line, arc, 2, 3, 4, 5): ");
+              (void) fscanf(stdin,"%39s",form);
+              if (form_name(form) != FALSE) {
+                 ctx->form = form_name(form);
+                 printf("the form applies to the next profile loaded\n");
+                 ctx->data_valid = FALSE;
+                 ctx->tfm_valid = FALSE;
+              }
+              else
+                 invalid_input();
+              break;
+
+    case 'a': if (ctx->tfm_valid == TRUE) {
+                 if (smooth_combine(ctx) != TRUE)
+                    (void) print_error(ctx->error_number);
+                 else
+                    printf("profiles averaged: %d\n",ctx->num_combinations);
+              }
+              break;
+
     case 'h': printf("\n\n\n\nhelp\n----\n");
 			     printf("l - load data\n");
 		   	  printf("f - compute frequency spectrum data\n");
 
 		      printf("p - save frequency spectral data\n");
 		   	  printf("m - compute parameters\n");
+		   	  printf("x - toggle exact/padded transform length\n");
+		   	  printf("w - Welch segment length, overlap and window\n");
+		   	  printf("b - toggle linear/log smoothing bands\n");
+		   	  printf("a - add smoothed spectrum to the average\n");
+		   	  printf("c - roughness cutoff wavelength\n");
+		   	  printf("o - form removed (line, arc or polynomial)\n");
 		   	  printf("e - end program\n\n\n");
 		   	  getc(stdin);
 		   	  break;
 
-    case 'e': 
+    case 'e': if (ctx->cache != NULL) {
+                 rcache_print_stats(ctx->cache,stdout);
+                 rcache_close(ctx->cache);
+              }
+              if (stats_format != FALSE)
+                 stats_print(stdout,stats_format);
+              pool_destroy(ctx->pool);
+              context_destroy(ctx);
               return(TRUE);         /* successful completion */
 
     default:  invalid_input();
@@ -138,88 +307,6 @@ main()
 }
 
 
-/*
- * Routine:	assign_memory
- *
- * Description:	Find memory space for the various arrays used in the
- *		program.
- *
- * Parameters:	none
- *
- * Returns:	TRUE	- memory allocated
- *		ER_MEM	- memory not allocated
- *
- * Example:
- *
- * Date:	22/5/91
- */
-
-/*
- * memory allocation routines
- */
-#include <stdlib.h>
-#include <malloc.h>  // not needed for calloc?
-
-/*
- * data and transform arrays
- */
-
-/* Talysurf data */
-int num_data;
-double  *data;
-double  *smooth_data;
-
-/* transform data */
-int trans_num_data;
-struct complex  *trans_data;
-struct complex  *dummy_data;
-
-/* spectral data */
-int spec_num_data;
-double  *spec_data;
-int smooth_num_data = SMOOTH_MAX_DATA;
-struct smoothed  *smooth;
-int num_combinations;
-struct smoothed  *saved_smooth;
-
-int assign_memory()
-{
-   /*
-    * memory for the data acquired by the Talysurf
-    */
-   data = (double *) calloc(MAX_DATA,sizeof(double));
-   smooth_data = (double *) calloc(MAX_DATA,sizeof(double));
-
-   /*
-    * transform data and dummy transform data
-    */
-   trans_data = (struct complex *)
-      calloc(MAX_DATA,sizeof(struct complex));
-   dummy_data = (struct complex *)
-      calloc(MAX_DATA,sizeof(struct complex));
-
-
-   /*
-    * spectral data
-    */
-   spec_data = (double *) calloc(SPEC_MAX_DATA,sizeof(double));
-   smooth = (struct smoothed *)
-      calloc(SMOOTH_MAX_DATA,sizeof(struct smoothed));
-   saved_smooth = (struct smoothed *)
-      calloc(SMOOTH_MAX_DATA,sizeof(struct smoothed));
-
-   /*
-    * test that allocation has been achieved
-    */
-   if (data==NULL || trans_data==NULL || dummy_data==NULL || 
-      spec_data==NULL || smooth==NULL) {
-         error_number = ER_MEM;
-         return(ER_MEM);
-   }
-
-   return(TRUE);
-}
-
 /*
  * Routine:	invalid_input
  *
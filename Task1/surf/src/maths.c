@@ -10,6 +10,8 @@
  *		remove_bias()	- re-calculate data relative to mse line
  *
  * Date:	22/5/91
+ * Modified:	17/10/26: the form removed may be other than a line
+ *		17/10/26: remove_bias() is timed
  *****************************************************************/
 
 /*
@@ -23,11 +25,14 @@
  * global declarations
  */
 #include "global.h" 
+#include "context.h"
           
 /*
  * local declarations
  */          
 #include "maths.h"
+#include "form.h"
+#include "stats.h"
    
    
 /*
@@ -82,7 +87,7 @@ char *fcvt2(char *dest, double source)
 
    result = gcvt(source,SIG_FIG,buf);
    (void) strcpy(dest,result);
-   if (dest == "") strcpy(dest,"0");
+   if (dest[0] == '\0') strcpy(dest,"0");
  
    return(dest);
 }
@@ -114,7 +119,7 @@ char *fcvt3(char *dest, double source)
 
    result = gcvt(source,SIG_FIG,buf);
    (void) strcpy(dest,result);
-   if (dest == "") strcpy(dest,"0");
+   if (dest[0] == '\0') strcpy(dest,"0");
  
    return(dest);
 }
@@ -159,56 +164,52 @@ double fixed(double source, int places)
  * Routine:	remove_bias
  *
  * Description:	Re-calculate data relative to the best-fitting mse
- *		line
+ *		line. The line comes from the statistics gathered while
+ *		the data were read (see online.h), which are gathered
+ *		here if the data did not come from load_raw(). Any
+ *		other "form" of the context is taken off by
+ *		form_remove().
  *
- * Parameters:	none
+ * Parameters:	ctx	<> the analysis context
  *
  * Returns:	nothing
  *
  * Example:	
  *
  * Date:	23/7/91
+ * Modified:	17/10/26: the line is found from the running sums
+ *		17/10/26: other forms
+ *		17/10/26: timed (see stats.h)
  */
-void remove_bias()
+void remove_bias(struct surf_context *ctx)
 {
-   double sum_x,sum_y;
-   double sum_x_2,prod_x_y;
    double a,b;
    int i;
+   STATS_TIMER(start);
 
-   /*
-    * find the various parameters needed
-    */
-   sum_x = 0.0;
-   sum_y = 0.0;
-   sum_x_2 = 0.0;
-   prod_x_y = 0.0;
-   for(i=0;i<num_data;i++) {
-     sum_x = sum_x + i;
-     sum_y = sum_y + data[i]; 
-     sum_x_2 = sum_x_2 + pow(i,2.0);
-     prod_x_y = prod_x_y + i*data[i];      
+   if (ctx->form != FORM_LINE) {
+      form_remove(ctx);
+      return;
    }
+   STATS_START(start);
 
    /*
-    * solve 2 simultaneous equations of the form:
-    *
-    * (1) num_data*a + sum_x*b = sum_y
-    * (2) sum_x*a + sum_x_2*b = prod_x_y
-    *
-    * to get the best-fitting line of equation
+    * the best-fitting line of equation
     *
     * y = a + bx
     */
-   b = (sum_y*sum_x-num_data*prod_x_y)/(sum_x*sum_x-num_data*sum_x_2);
-   a = (prod_x_y-sum_x_2*b)/sum_x;
+   if (ctx->online.n != ctx->num_data) {
+      online_reset(&ctx->online);
+      (void) online_add_block(&ctx->online,ctx->data,ctx->num_data);
+   }
+   online_fit(&ctx->online,&a,&b);
 
    /*
     * subtract the data from the fitted line
     */
-   for(i=0;i<num_data;i++){
-      data[i]=data[i]-(a+b*i);
+   for(i=0;i<ctx->num_data;i++){
+      ctx->data[i]=ctx->data[i]-(a+b*i);
    }
+   STATS_STOP(STATS_LEVEL,start);
 
 }
-
@@ -0,0 +1,145 @@
+/******************************************************************
+ * Module:	mixfft.c
+ *
+ * Purpose:	Transforms of lengths that are not an integral power
+ *		of 2.
+ *
+ * Contents:	mixfft_factor()	- split a length into radices
+ *		mixfft_run()	- mixed-radix transform
+ *		bluestein_init()	- tables for a chirp-z transform
+ *		bluestein_run()	- chirp-z transform
+ *		and the same transforms in float (see mixfftt.h)
+ *
+ * Date:	17/10/26
+ * Modified:	17/10/26: the transforms are written once for doubles
+ *		and floats (see mixfftt.h).
+ *****************************************************************/
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "global.h"
+#include "fft.h"
+#include "mixfft.h"
+
+
+/*
+ * Routine:	mixfft_factor
+ *
+ * Description:	Split "n" into the radices used by the mixed-radix
+ *		transform, largest stages first: 4s, then 2s, then odd
+ *		primes. The factors are stored as pairs of radix and
+ *		the length remaining after that radix.
+ *
+ * Parameters:	n	< the transform length
+ *		factors	> 2*FFT_MAX_FACTORS radix, length pairs
+ *
+ * Returns:	TRUE	- every prime factor is at most FFT_MAX_RADIX
+ *		FALSE	- the length needs the Bluestein transform
+ *
+ * Example:	mixfft_factor(1500,factors);
+ *		factors = [4,375, 3,125, 5,25, 5,5, 5,1]
+ *
+ * Date:	17/10/26
+ */
+int mixfft_factor(int n, int *factors)
+{
+   int p,num_factors;
+
+   p = 4;
+   num_factors = 0;
+   do {
+      while (n % p != 0) {
+         switch (p) {
+            case 4: p = 2; break;
+            case 2: p = 3; break;
+            default: p += 2; break;
+         }
+         if (p > FFT_MAX_RADIX)
+            return(FALSE);
+      }
+      n /= p;
+      factors[2*num_factors] = p;
+      factors[2*num_factors+1] = n;
+      num_factors++;
+   } while (n > 1 && num_factors < FFT_MAX_FACTORS);
+
+   if (n > 1)
+      return(FALSE);
+   return(TRUE);
+}
+
+
+/*
+ * Routine:	bluestein_init
+ *
+ * Description:	Calculate the chirp and the transform of its conjugate
+ *		for a chirp-z transform of "plan->n" points.
+ *
+ * Parameters:	plan	<> a FFT_BLUESTEIN plan with "n" set
+ *
+ * Returns:	TRUE	- tables calculated
+ *		ER_MEM	- memory not available
+ *
+ * Date:	17/10/26
+ */
+int bluestein_init(struct fft_plan *plan)
+{
+   struct fft_plan *sub_plan;
+   int n,m,k;
+   long k_2;
+
+   n = plan->n;
+   for(m=1;m<2*n-1;m*=2)
+      ;
+
+   sub_plan = fft_plan_create(m);
+   plan->sub_plan = sub_plan;
+   plan->chirp_re = (double *) calloc(n,sizeof(double));
+   plan->chirp_im = (double *) calloc(n,sizeof(double));
+   plan->chirp_tfm_re = (double *) calloc(m,sizeof(double));
+   plan->chirp_tfm_im = (double *) calloc(m,sizeof(double));
+   plan->scratch_re = (double *) calloc(m,sizeof(double));
+   plan->scratch_im = (double *) calloc(m,sizeof(double));
+   if (sub_plan == NULL || plan->chirp_re == NULL || plan->chirp_im == NULL
+      || plan->chirp_tfm_re == NULL || plan->chirp_tfm_im == NULL
+      || plan->scratch_re == NULL || plan->scratch_im == NULL)
+      return(ER_MEM);
+
+   /*
+    * chirp[k] = exp(-pi*j*k*k/n); k*k is reduced modulo 2n first so
+    * that the argument stays small and accurate
+    */
+   for(k=0;k<n;k++) {
+      k_2 = ((long) k*k) % (2L*n);
+      plan->chirp_re[k] = cos(TWO_PI*k_2/(2.0*n));
+      plan->chirp_im[k] = -sin(TWO_PI*k_2/(2.0*n));
+   }
+
+   /*
+    * the conjugate chirp, wrapped around so that the convolution is
+    * circular over "m" points
+    */
+   plan->chirp_tfm_re[0] = plan->chirp_re[0];
+   plan->chirp_tfm_im[0] = -plan->chirp_im[0];
+   for(k=1;k<n;k++) {
+      plan->chirp_tfm_re[k] = plan->chirp_re[k];
+      plan->chirp_tfm_im[k] = -plan->chirp_im[k];
+      plan->chirp_tfm_re[m-k] = plan->chirp_tfm_re[k];
+      plan->chirp_tfm_im[m-k] = plan->chirp_tfm_im[k];
+   }
+   fft_plan_run(sub_plan,plan->chirp_tfm_re,plan->chirp_tfm_im);
+
+   return(TRUE);
+}
+
+
+/*
+ * the transforms of each precision
+ */
+#include "scalar.h"
+#include "mixfftt.h"
+
+#define SCALAR_FLOAT
+#include "scalar.h"
+#include "mixfftt.h"
@@ -0,0 +1,58 @@
+/******************************************************************
+ * Module:	moments.c
+ *
+ * Purpose:	Sums, extremes and lag products of a profile, found in
+ *		one pass over the data.
+ *
+ * Contents:	moments_heights()	- every sum of a profile in one pass
+ *		kahan_add()	- add to a compensated sum
+ *		heights_slope()	- seven point slope
+ *		heights_add()	- add a sample near an end to lane 0
+ *		heights_crossing()	- place a crossing of the mean line
+ *		lanes_total()	- add up the partial sums
+ *		and the same pass over floats (see momentst.h)
+ *
+ * Date:	17/10/26
+ * Modified:	17/10/26: the passes are written once for doubles and
+ *		floats (see momentst.h).
+ *		17/10/26: one pass, moments_heights(), finds every sum.
+ *****************************************************************/
+
+/*
+ * global definitions
+ */
+#include "global.h"
+#include "moments.h"
+
+/*
+ * Routine:	kahan_add
+ *
+ * Description:	Add "v" to the compensated sum "s", whose lost low
+ *		order part (negated) is "c".
+ *
+ * Example:	kahan_add(s,c,x*x);
+ */
+#define kahan_add(s,c,v) \
+   do { scalar y_ = (v) - (c); scalar t_ = (s) + y_; \
+        (c) = (t_ - (s)) - y_; (s) = t_; } while (0)
+
+/*
+ * Routine:	heights_slope
+ *
+ * Description:	Seven point slope at z[i], per sample interval
+ *		(ISO 4287); needs three samples either side.
+ */
+#define heights_slope(z,i) \
+   (((z)[(i)+3] - 9*(z)[(i)+2] + 45*(z)[(i)+1] \
+     - 45*(z)[(i)-1] + 9*(z)[(i)-2] - (z)[(i)-3])/(scalar) 60)
+
+
+/*
+ * the pass of each precision
+ */
+#include "scalar.h"
+#include "momentst.h"
+
+#define SCALAR_FLOAT
+#include "scalar.h"
+#include "momentst.h"
@@ -0,0 +1,381 @@
+/******************************************************************
+ * Module:	online.c
+ *
+ * Purpose:	Profile statistics gathered sample by sample as the
+ *		data arrive, so that the parameters are known as soon
+ *		as the last sample is read.
+ *
+ * Contents:	online_reset()	- start a new profile
+ *		online_add()	- add one sample
+ *		online_add_block()	- add a block of samples
+ *		online_fit()	- the best-fitting (mse) line
+ *		online_params()	- parameters of the levelled profile
+ *		online_free()	- release the hulls
+ *		hull_add()	- extend a convex hull
+ *		hull_extreme()	- furthest hull point from a line
+ *
+ * Date:	17/10/26
+ * Modified:	17/10/26: the moments of x in closed form
+ *****************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * global definitions
+ */
+#include "global.h"
+#include "context.h"
+#include "online.h"
+
+static int hull_add(struct online_hull *hull, int x, double y, int upper);
+static double hull_extreme(const struct online_hull *hull, double b,
+   int upper);
+
+
+/*
+ * Routine:	online_reset
+ *
+ * Description:	Start a new profile, keeping the hull memory.
+ *
+ * Parameters:	acc	<> the accumulator
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void online_reset(struct surf_online *acc)
+{
+   acc->n = 0;
+   acc->status = TRUE;
+   acc->mean_x = 0.0;
+   acc->mean_y = 0.0;
+   acc->m2_x = 0.0;
+   acc->m2_y = 0.0;
+   acc->c_xy = 0.0;
+   acc->first = 0.0;
+   acc->last = 0.0;
+   acc->lag = 0.0;
+   acc->min = 0.0;
+   acc->max = 0.0;
+   acc->upper.size = 0;
+   acc->lower.size = 0;
+}
+
+
+/*
+ * Routine:	online_add
+ *
+ * Description:	Add the next sample.
+ *
+ * Parameters:	acc	<> the accumulator
+ *		y	< the sample
+ *
+ * Returns:	TRUE	- added
+ *		ER_MEM	- no memory to extend a hull; the sums are
+ *			  still kept, but not Rp and Rv
+ *
+ * Example:	online_add(&ctx->online,ctx->data[i]);
+ *
+ * Date:	17/10/26
+ */
+int online_add(struct surf_online *acc, double y)
+{
+   double dx,dy,shifted;
+   int x;
+
+   /*
+    * lag-1 product and extremes, about the first sample
+    */
+   x = acc->n;
+   if (x == 0) {
+      acc->first = y;
+      acc->min = y;
+      acc->max = y;
+   }
+   shifted = y - acc->first;
+   acc->lag += shifted*acc->last;
+   acc->last = shifted;
+   if (y < acc->min)
+      acc->min = y;
+   if (y > acc->max)
+      acc->max = y;
+
+   /*
+    * Welford's running mean, variance and covariance. The x are
+    * 0..n-1, so their moments have closed forms: x less the old
+    * mean of x is always n/2 (n counting this sample), which is
+    * what Welford's update would find.
+    */
+   acc->n++;
+   dx = 0.5*acc->n;
+   dy = y - acc->mean_y;
+   acc->mean_y += dy/acc->n;
+   acc->mean_x = 0.5*x;
+   acc->m2_x = (double) acc->n*((double) acc->n*acc->n - 1.0)/12.0;
+   acc->m2_y += dy*(y - acc->mean_y);
+   acc->c_xy += dx*(y - acc->mean_y);
+
+   /*
+    * the hulls last, so that the sums are right even if there is no
+    * memory for them
+    */
+   if (acc->status == TRUE) {
+      if (hull_add(&acc->upper,x,y,TRUE) != TRUE
+         || hull_add(&acc->lower,x,y,FALSE) != TRUE)
+         acc->status = ER_MEM;
+   }
+
+   return(acc->status);
+}
+
+
+/*
+ * Routine:	online_add_block
+ *
+ * Description:	Add the next "n" samples.
+ *
+ * Parameters:	acc	<> the accumulator
+ *		y	< the samples
+ *		n	< number of samples
+ *
+ * Returns:	TRUE	- added
+ *		ER_MEM	- no memory to extend a hull
+ *
+ * Date:	17/10/26
+ */
+int online_add_block(struct surf_online *acc, const double *y, int n)
+{
+   int i;
+
+   for(i=0;i<n;i++)
+      (void) online_add(acc,y[i]);
+   return(acc->status);
+}
+
+
+/*
+ * Routine:	online_fit
+ *
+ * Description:	The best-fitting (mean-squared error) line
+ *		y = a + b*x through the samples so far.
+ *
+ * Parameters:	acc	< the accumulator
+ *		a	> the intercept
+ *		b	> the slope
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void online_fit(const struct surf_online *acc, double *a, double *b)
+{
+   *b = acc->m2_x > 0.0 ? acc->c_xy/acc->m2_x : 0.0;
+   *a = acc->mean_y - *b*acc->mean_x;
+}
+
+
+/*
+ * Routine:	online_params
+ *
+ * Description:	The parameters calc_params() would find for the
+ *		samples so far once the best-fitting line is taken off
+ *		(see remove_bias()), worked out from the running sums
+ *		and hulls alone. The residuals of the fit have zero
+ *		mean, so Rp and Rv are the largest deviations above and
+ *		below the line.
+ *
+ * Parameters:	acc	< the accumulator
+ *		y_division	< y scaling factor
+ *		params	> mean, var, rp, rv, rt, gamma0 and gamma1;
+ *			  all cleared when there are no samples
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ *
+ * Modified:	17/10/26: no samples clear the parameters
+ *		17/10/26: the variance, Rp and Rv in microns
+ */
+void online_params(const struct surf_online *acc, double y_division,
+   struct surf_params *params)
+{
+   double a,b;  /* the fitted line */
+   double a0;  /* its intercept about the first sample */
+   double sum_res_sq;  /* sum of the squared residuals */
+   double sum_y,sum_xy;  /* sums of y-y[0] and x*(y-y[0]) */
+   double y1,y0;  /* sums of y[i]-y[0] and y[i-1]-y[0], i = 1..n-1 */
+   double p,q;  /* sums of (i-1)*(y[i]-y[0]) and i*(y[i-1]-y[0]) */
+   double m;  /* n-1 */
+   double lag;
+   int n;
+
+   n = acc->n;
+   if (n == 0) {
+      (void) memset(params,0,sizeof(*params));
+      return;
+   }
+   online_fit(acc,&a,&b);
+
+   /*
+    * variance of the residuals, which have zero mean
+    */
+   sum_res_sq = acc->m2_y - b*acc->c_xy;
+   if (sum_res_sq < 0.0)
+      sum_res_sq = 0.0;
+   params->mean = 0.0;
+   params->var = y_division*y_division*sum_res_sq/n;
+
+   /*
+    * largest deviations above and below the line
+    */
+   params->rp = y_division*(hull_extreme(&acc->upper,b,TRUE) - a);
+   if (params->rp < 0)
+      params->rp = 0;
+   params->rv = y_division*(a - hull_extreme(&acc->lower,b,FALSE));
+   if (params->rv < 0)
+      params->rv = 0;
+   params->rt = params->rp + params->rv;
+
+   /*
+    * The lag-1 product of the residuals r[i] = y[i] - a - b*i,
+    * expanded into sums known from the accumulator; y is taken
+    * about y[0] throughout to keep the terms small.
+    */
+   a0 = a - acc->first;
+   sum_y = n*(acc->mean_y - acc->first);
+   sum_xy = acc->c_xy + n*acc->mean_x*(acc->mean_y - acc->first);
+   m = n-1;
+   y1 = sum_y;
+   y0 = sum_y - acc->last;
+   p = sum_xy - y1;
+   q = sum_xy - m*acc->last + y0;
+   lag = acc->lag - a0*(y1+y0) - b*(p+q) + m*a0*a0 + a0*b*m*m
+      + b*b*m*n*(n-2)/3.0;
+
+   params->gamma0 = y_division*y_division*sum_res_sq/n;
+   params->gamma1 = y_division*y_division*lag/n;
+}
+
+
+/*
+ * Routine:	online_free
+ *
+ * Description:	Release the hull memory.
+ *
+ * Parameters:	acc	<> the accumulator
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void online_free(struct surf_online *acc)
+{
+   free(acc->upper.x);
+   free(acc->upper.y);
+   free(acc->lower.x);
+   free(acc->lower.y);
+   acc->upper.x = acc->lower.x = NULL;
+   acc->upper.y = acc->lower.y = NULL;
+   acc->upper.size = acc->upper.max_size = 0;
+   acc->lower.size = acc->lower.max_size = 0;
+}
+
+
+/*
+ * Routine:	hull_add
+ *
+ * Description:	Add a point to the right of an upper (lower) convex
+ *		hull, first removing the points that are no longer on
+ *		it (Andrew's monotone chain).
+ *
+ * Parameters:	hull	<> the hull
+ *		x, y	< the point
+ *		upper	< TRUE for the upper hull
+ *
+ * Returns:	TRUE	- added
+ *		ER_MEM	- no memory to extend the hull
+ *
+ * Date:	17/10/26
+ */
+static int hull_add(struct online_hull *hull, int x, double y, int upper)
+{
+   double cross;
+   int *hx;
+   double *hy;
+   int max_size;
+   int k;
+
+   k = hull->size;
+   while (k >= 2) {
+      /*
+       * positive if the last point is above the line from the one
+       * before it to the new point
+       */
+      cross = (hull->y[k-1] - hull->y[k-2])*(x - hull->x[k-2])
+         - (y - hull->y[k-2])*(hull->x[k-1] - hull->x[k-2]);
+      if (upper == TRUE ? cross > 0.0 : cross < 0.0)
+         break;
+      k--;
+   }
+
+   if (k == hull->max_size) {
+      max_size = hull->max_size ? 2*hull->max_size : ONLINE_HULL_START;
+      hx = (int *) realloc(hull->x,max_size*sizeof(int));
+      if (hx != NULL)
+         hull->x = hx;
+      hy = (double *) realloc(hull->y,max_size*sizeof(double));
+      if (hy != NULL)
+         hull->y = hy;
+      if (hx == NULL || hy == NULL)
+         return(ER_MEM);
+      hull->max_size = max_size;
+   }
+
+   hull->x[k] = x;
+   hull->y[k] = y;
+   hull->size = k+1;
+   return(TRUE);
+}
+
+
+/*
+ * Routine:	hull_extreme
+ *
+ * Description:	The largest (upper hull) or smallest (lower hull)
+ *		value of y - b*x over the hull. Along the hull the
+ *		slopes of the edges fall (rise), so the best point is
+ *		found by bisection.
+ *
+ * Parameters:	hull	< the hull
+ *		b	< the slope of the line
+ *		upper	< TRUE for the upper hull
+ *
+ * Returns:	the value
+ *
+ * Date:	17/10/26
+ */
+static double hull_extreme(const struct online_hull *hull, double b,
+   int upper)
+{
+   int lo,hi,mid;
+   double rise;
+
+   /*
+    * find the first point whose outgoing edge is no steeper (upper)
+    * or no shallower (lower) than the line
+    */
+   lo = 0;
+   hi = hull->size-1;
+   while (lo < hi) {
+      mid = (lo+hi)/2;
+      rise = hull->y[mid+1] - hull->y[mid]
+         - b*(hull->x[mid+1] - hull->x[mid]);
+      if (upper == TRUE ? rise <= 0.0 : rise >= 0.0)
+         hi = mid;
+      else
+         lo = mid+1;
+   }
+
+   return(hull->y[lo] - b*hull->x[lo]);
+}
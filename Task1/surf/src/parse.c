@@ -0,0 +1,321 @@
+/******************************************************************
+ * Module:	parse.c
+ *
+ * Purpose:	Read numbers straight from text held in memory (a
+ *		mapped file), without copying or allocating.
+ *
+ * Contents:	parse_space()	- skip white space
+ *		parse_count()	- count the items
+ *		parse_int()	- read a decimal integer
+ *		parse_double()	- read a floating point number
+ *		parse_strtod()	- read a number with strtod()
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+/*
+ * global definitions
+ */
+#include "global.h"
+#include "parse.h"
+
+/*
+ * white space, as isspace() in the "C" locale - the test is written
+ * out so that the current locale does not matter
+ */
+#define PARSE_SPACE(c) ((c) == ' ' || ((c) >= '\t' && (c) <= '\r'))
+
+/*
+ * most significant digits held exactly in the 64 bit mantissa
+ */
+#define PARSE_MAX_DIGITS 19
+
+/*
+ * largest integer with an exact double (2^53), and largest power
+ * of ten with an exact double
+ */
+#define PARSE_MAX_EXACT 9007199254740992ULL
+#define PARSE_MAX_POW10 22
+
+static const double pow10_exact[PARSE_MAX_POW10+1] = {
+   1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static const char *parse_strtod(const char *text, const char *end,
+   double *value);
+
+
+/*
+ * Routine:	parse_space
+ *
+ * Description:	Skip the white space (as isspace() in the "C" locale)
+ *		at the start of text[0..end-1].
+ *
+ * Parameters:	text	< the text
+ *		end	< one past the last character
+ *
+ * Returns:	the first character that is not white space, or end
+ *
+ * Date:	17/10/26
+ */
+const char *parse_space(const char *text, const char *end)
+{
+   while (text < end && PARSE_SPACE(*text))
+      text++;
+   return(text);
+}
+
+
+/*
+ * Routine:	parse_count
+ *
+ * Description:	Count the items, separated by white space, in
+ *		text[0..end-1].
+ *
+ * Parameters:	text	< the text
+ *		end	< one past the last character
+ *
+ * Returns:	the number of items
+ *
+ * Example:	parse_count(" 1.5 -2\n3 ",end);
+ *		return(3);
+ *
+ * Date:	17/10/26
+ */
+int parse_count(const char *text, const char *end)
+{
+   int count;
+
+   count = 0;
+   text = parse_space(text,end);
+   while (text < end) {
+      count++;
+      while (text < end && !PARSE_SPACE(*text))
+         text++;
+      text = parse_space(text,end);
+   }
+   return(count);
+}
+
+
+/*
+ * Routine:	parse_int
+ *
+ * Description:	Read a decimal integer, with an optional sign, that
+ *		runs up to white space or the end of the text.
+ *
+ * Parameters:	text	< the first character of the number
+ *		end	< one past the last character of the text
+ *		value	> the number
+ *
+ * Returns:	the character after the number, or NULL if the text
+ *		is not an integer or is out of range
+ *
+ * Example:	parse_int("12 3",end,&value);
+ *		value = 12, returns a pointer to " 3"
+ *
+ * Date:	17/10/26
+ */
+const char *parse_int(const char *text, const char *end, int *value)
+{
+   const char *p;
+   long n;
+   int negative;
+
+   p = text;
+   negative = 0;
+   if (p < end && (*p == '+' || *p == '-')) {
+      negative = *p == '-';
+      p++;
+   }
+   if (p == end || *p < '0' || *p > '9')
+      return(NULL);
+
+   n = 0;
+   while (p < end && *p >= '0' && *p <= '9') {
+      n = 10*n + (*p++ - '0');
+      if (n > (long) INT_MAX + 1)
+         return(NULL);
+   }
+   if (p < end && !PARSE_SPACE(*p))
+      return(NULL);
+   if (negative)
+      n = -n;
+   if (n > INT_MAX || n < INT_MIN)
+      return(NULL);
+
+   *value = (int) n;
+   return(p);
+}
+
+
+/*
+ * Routine:	parse_double
+ *
+ * Description:	Read a floating point number that runs up to white
+ *		space or the end of the text, rounded exactly as
+ *		strtod() rounds it. Numbers of up to 19 significant
+ *		digits whose value and power of ten are both exact
+ *		doubles are worked out directly (one correctly rounded
+ *		multiplication or division); anything else is copied
+ *		to a buffer and given to strtod().
+ *
+ * Parameters:	text	< the first character of the number
+ *		end	< one past the last character of the text
+ *		value	> the number
+ *
+ * Returns:	the character after the number, or NULL if the text
+ *		is not a number or is longer than PARSE_MAX_TOKEN
+ *
+ * Example:	parse_double("-7.719728\n",end,&value);
+ *		value = -7.719728, returns a pointer to "\n"
+ *
+ * Date:	17/10/26
+ */
+const char *parse_double(const char *text, const char *end, double *value)
+{
+   const char *p;
+   unsigned long long mantissa;  /* the significant digits */
+   int num_digits;  /* significant digits in the mantissa */
+   int any_digits;  /* digits seen, including leading zeros */
+   int exponent;  /* power of ten to apply to the mantissa */
+   int exp_value,exp_negative;
+   int negative;
+   double x;
+
+   p = text;
+   negative = 0;
+   if (p < end && (*p == '+' || *p == '-')) {
+      negative = *p == '-';
+      p++;
+   }
+
+   /*
+    * integer part, then fraction; leading zeros are not significant
+    */
+   mantissa = 0;
+   num_digits = 0;
+   any_digits = 0;
+   exponent = 0;
+   while (p < end && *p >= '0' && *p <= '9') {
+      any_digits = 1;
+      if (mantissa != 0 || *p != '0') {
+         if (num_digits == PARSE_MAX_DIGITS)
+            return(parse_strtod(text,end,value));
+         mantissa = 10*mantissa + (*p - '0');
+         num_digits++;
+      }
+      p++;
+   }
+   if (p < end && *p == '.') {
+      p++;
+      while (p < end && *p >= '0' && *p <= '9') {
+         any_digits = 1;
+         if (mantissa != 0 || *p != '0') {
+            if (num_digits == PARSE_MAX_DIGITS)
+               return(parse_strtod(text,end,value));
+            mantissa = 10*mantissa + (*p - '0');
+            num_digits++;
+         }
+         exponent--;
+         p++;
+      }
+   }
+   if (!any_digits)
+      return(parse_strtod(text,end,value));
+
+   /*
+    * exponent
+    */
+   if (p < end && (*p == 'e' || *p == 'E')) {
+      p++;
+      exp_negative = 0;
+      if (p < end && (*p == '+' || *p == '-')) {
+         exp_negative = *p == '-';
+         p++;
+      }
+      if (p == end || *p < '0' || *p > '9')
+         return(parse_strtod(text,end,value));
+      exp_value = 0;
+      while (p < end && *p >= '0' && *p <= '9') {
+         if (exp_value < 10000)
+            exp_value = 10*exp_value + (*p - '0');
+         p++;
+      }
+      exponent += exp_negative ? -exp_value : exp_value;
+   }
+
+   /*
+    * the number must end here; anything else ("inf", hexadecimal,
+    * or not a number at all) is left to strtod()
+    */
+   if (p < end && !PARSE_SPACE(*p))
+      return(parse_strtod(text,end,value));
+
+   /*
+    * Both the mantissa and 10^|exponent| are exact, so the one
+    * rounding of the product or quotient is the correct rounding of
+    * the decimal value (Clinger's fast path).
+    */
+   if (mantissa == 0)
+      x = 0.0;
+   else if (mantissa <= PARSE_MAX_EXACT && exponent >= -PARSE_MAX_POW10
+      && exponent <= PARSE_MAX_POW10) {
+      x = (double) mantissa;
+      if (exponent < 0)
+         x = x / pow10_exact[-exponent];
+      else
+         x = x * pow10_exact[exponent];
+   }
+   else
+      return(parse_strtod(text,end,value));
+
+   *value = negative ? -x : x;
+   return(p);
+}
+
+
+/*
+ * Routine:	parse_strtod
+ *
+ * Description:	Copy a number to a buffer and read it with strtod(),
+ *		which must use all of it.
+ *
+ * Parameters:	text	< the first character of the number
+ *		end	< one past the last character of the text
+ *		value	> the number
+ *
+ * Returns:	the character after the number, or NULL if the text
+ *		is not a number or is longer than PARSE_MAX_TOKEN
+ *
+ * Date:	17/10/26
+ */
+static const char *parse_strtod(const char *text, const char *end,
+   double *value)
+{
+   char buffer[PARSE_MAX_TOKEN+1];
+   char *stop;
+   size_t len;
+
+   len = 0;
+   while (text+len < end && !PARSE_SPACE(text[len])) {
+      if (len == PARSE_MAX_TOKEN)
+         return(NULL);
+      len++;
+   }
+   if (len == 0)
+      return(NULL);
+
+   (void) memcpy(buffer,text,len);
+   buffer[len] = '\0';
+   *value = strtod(buffer,&stop);
+   if (stop != buffer+len)
+      return(NULL);
+
+   return(text+len);
+}
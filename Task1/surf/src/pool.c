@@ -0,0 +1,415 @@
+/******************************************************************
+ * Module:	pool.c
+ *
+ * Purpose:	A pool of worker threads sharing out numbered tasks by
+ *		work stealing.
+ *
+ * Contents:	pool_default_workers()	- number of processors online
+ *		pool_create()		- start the worker threads
+ *		pool_num_workers()	- number of workers in a pool
+ *		pool_run()		- run tasks 0..num_tasks-1
+ *		pool_destroy()		- stop the worker threads
+ *		pool_thread()		- body of a worker thread
+ *		pool_work()		- run tasks until none are left
+ *		pool_take()		- next task from a worker's own run
+ *		pool_steal()		- take half of another worker's run
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+
+/*
+ * global definitions
+ */
+#include "global.h"
+#include "pool.h"
+
+/*
+ * size of a cache line: each worker's queue is kept on its own
+ * lines so that taking a task does not disturb the other workers
+ */
+#define POOL_LINE 64
+
+/*
+ * The tasks waiting for a worker, first..last-1. The owner takes
+ * from the front; thieves take from the back.
+ */
+struct pool_queue {
+   pthread_mutex_t lock;
+   int first;
+   int last;
+   char pad[POOL_LINE];
+};
+
+struct surf_pool {
+   int num_workers;
+   pthread_t *thread;  /* workers 1..num_workers-1 */
+   struct pool_queue *queue;  /* one per worker */
+
+   pthread_mutex_t lock;  /* guards everything below */
+   pthread_cond_t start;  /* a run has begun, or quit */
+   pthread_cond_t done;  /* a worker has finished its part of a run */
+   int generation;  /* number of runs begun */
+   int num_busy;  /* threads still working on this run */
+   int quit;  /* non-zero when the threads are to stop */
+   pool_task_fn fn;
+   void *shared;
+};
+
+struct pool_start {
+   struct surf_pool *pool;
+   int worker;
+};
+
+static void *pool_thread(void *arg);
+static void pool_work(struct surf_pool *pool, int worker);
+static int pool_take(struct surf_pool *pool, int worker);
+static int pool_steal(struct surf_pool *pool, int worker);
+
+
+/*
+ * Routine:	pool_default_workers
+ *
+ * Description:	The number of processors online, at least 1.
+ *
+ * Parameters:	none
+ *
+ * Returns:	the number of processors
+ *
+ * Date:	17/10/26
+ */
+int pool_default_workers()
+{
+   long n;
+
+   n = sysconf(_SC_NPROCESSORS_ONLN);
+   return(n < 1 ? 1 : (int) n);
+}
+
+
+/*
+ * Routine:	pool_create
+ *
+ * Description:	Start a pool of "num_workers" workers. The thread
+ *		calling pool_run() is worker 0, so num_workers-1 threads
+ *		are started.
+ *
+ * Parameters:	num_workers	< number of workers, 0 for one per
+ *				  processor
+ *
+ * Returns:	the pool, or NULL if it could not be started
+ *
+ * Example:	pool = pool_create(0);
+ *
+ * Date:	17/10/26
+ */
+struct surf_pool *pool_create(int num_workers)
+{
+   struct surf_pool *pool;
+   struct pool_start *start;
+   int i;
+
+   if (num_workers < 1)
+      num_workers = pool_default_workers();
+
+   pool = (struct surf_pool *) calloc(1,sizeof(struct surf_pool));
+   if (pool == NULL)
+      return(NULL);
+   pool->queue = (struct pool_queue *)
+      calloc(num_workers,sizeof(struct pool_queue));
+   pool->thread = (pthread_t *) calloc(num_workers,sizeof(pthread_t));
+   if (pool->queue == NULL || pool->thread == NULL) {
+      free(pool->queue);
+      free(pool->thread);
+      free(pool);
+      return(NULL);
+   }
+
+   for(i=0;i<num_workers;i++)
+      (void) pthread_mutex_init(&pool->queue[i].lock,NULL);
+   (void) pthread_mutex_init(&pool->lock,NULL);
+   (void) pthread_cond_init(&pool->start,NULL);
+   (void) pthread_cond_init(&pool->done,NULL);
+
+   /*
+    * start the threads; if one fails the pool is just smaller
+    */
+   pool->num_workers = 1;
+   for(i=1;i<num_workers;i++) {
+      start = (struct pool_start *) malloc(sizeof(struct pool_start));
+      if (start == NULL)
+         break;
+      start->pool = pool;
+      start->worker = i;
+      if (pthread_create(&pool->thread[i],NULL,pool_thread,start) != 0) {
+         free(start);
+         break;
+      }
+      pool->num_workers++;
+   }
+
+   return(pool);
+}
+
+
+/*
+ * Routine:	pool_num_workers
+ *
+ * Description:	The number of workers in a pool.
+ *
+ * Parameters:	pool	< the pool
+ *
+ * Returns:	the number of workers
+ *
+ * Date:	17/10/26
+ */
+int pool_num_workers(const struct surf_pool *pool)
+{
+   return(pool->num_workers);
+}
+
+
+/*
+ * Routine:	pool_run
+ *
+ * Description:	Run fn(shared, worker, task) for every task from 0 to
+ *		num_tasks-1 and wait for them all to finish. Each
+ *		worker starts with an equal run of consecutive tasks;
+ *		a worker that runs out steals the back half of the
+ *		run of another.
+ *
+ * Parameters:	pool		< the pool
+ *		num_tasks	< number of tasks
+ *		fn		< the task routine
+ *		shared		< passed to every task
+ *
+ * Returns:	nothing
+ *
+ * Example:	pool_run(pool,num_files,analyse_file,&job);
+ *
+ * Date:	17/10/26
+ */
+void pool_run(struct surf_pool *pool, int num_tasks, pool_task_fn fn,
+   void *shared)
+{
+   int n;
+   int i;
+
+   if (num_tasks <= 0)
+      return;
+
+   /*
+    * deal the tasks out in equal runs
+    */
+   n = pool->num_workers;
+   for(i=0;i<n;i++) {
+      pthread_mutex_lock(&pool->queue[i].lock);
+      pool->queue[i].first = (int) ((long) num_tasks*i/n);
+      pool->queue[i].last = (int) ((long) num_tasks*(i+1)/n);
+      pthread_mutex_unlock(&pool->queue[i].lock);
+   }
+
+   /*
+    * wake the threads, do a share of the work here, and wait for
+    * the threads to finish theirs
+    */
+   pthread_mutex_lock(&pool->lock);
+   pool->fn = fn;
+   pool->shared = shared;
+   pool->num_busy = n-1;
+   pool->generation++;
+   pthread_cond_broadcast(&pool->start);
+   pthread_mutex_unlock(&pool->lock);
+
+   pool_work(pool,0);
+
+   pthread_mutex_lock(&pool->lock);
+   while (pool->num_busy > 0)
+      pthread_cond_wait(&pool->done,&pool->lock);
+   pthread_mutex_unlock(&pool->lock);
+}
+
+
+/*
+ * Routine:	pool_destroy
+ *
+ * Description:	Stop the worker threads and release the pool.
+ *
+ * Parameters:	pool	< the pool made by pool_create()
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void pool_destroy(struct surf_pool *pool)
+{
+   int i;
+
+   if (pool == NULL)
+      return;
+
+   pthread_mutex_lock(&pool->lock);
+   pool->quit = 1;
+   pthread_cond_broadcast(&pool->start);
+   pthread_mutex_unlock(&pool->lock);
+
+   for(i=1;i<pool->num_workers;i++)
+      (void) pthread_join(pool->thread[i],NULL);
+
+   for(i=0;i<pool->num_workers;i++)
+      (void) pthread_mutex_destroy(&pool->queue[i].lock);
+   (void) pthread_mutex_destroy(&pool->lock);
+   (void) pthread_cond_destroy(&pool->start);
+   (void) pthread_cond_destroy(&pool->done);
+   free(pool->queue);
+   free(pool->thread);
+   free(pool);
+}
+
+
+/*
+ * Routine:	pool_thread
+ *
+ * Description:	Body of worker thread: wait for a run to begin, work
+ *		on it, report back, until the pool is destroyed.
+ *
+ * Parameters:	arg	< the pool_start naming the pool and worker
+ *
+ * Returns:	NULL
+ *
+ * Date:	17/10/26
+ */
+static void *pool_thread(void *arg)
+{
+   struct surf_pool *pool;
+   int worker;
+   int seen;  /* the last run worked on */
+
+   pool = ((struct pool_start *) arg)->pool;
+   worker = ((struct pool_start *) arg)->worker;
+   free(arg);
+
+   /*
+    * no run has begun when the thread is created, even if one has
+    * by the time it gets here
+    */
+   seen = 0;
+   pthread_mutex_lock(&pool->lock);
+   while (1) {
+      while (pool->generation == seen && !pool->quit)
+         pthread_cond_wait(&pool->start,&pool->lock);
+      if (pool->quit)
+         break;
+      seen = pool->generation;
+      pthread_mutex_unlock(&pool->lock);
+
+      pool_work(pool,worker);
+
+      pthread_mutex_lock(&pool->lock);
+      if (--pool->num_busy == 0)
+         pthread_cond_signal(&pool->done);
+   }
+   pthread_mutex_unlock(&pool->lock);
+
+   return(NULL);
+}
+
+
+/*
+ * Routine:	pool_work
+ *
+ * Description:	Run tasks from the worker's own run, then stolen
+ *		ones, until there are none left anywhere.
+ *
+ * Parameters:	pool	< the pool
+ *		worker	< the worker
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+static void pool_work(struct surf_pool *pool, int worker)
+{
+   int task;
+
+   while (1) {
+      task = pool_take(pool,worker);
+      if (task < 0)
+         task = pool_steal(pool,worker);
+      if (task < 0)
+         return;
+      pool->fn(pool->shared,worker,task);
+   }
+}
+
+
+/*
+ * Routine:	pool_take
+ *
+ * Description:	Take the task at the front of a worker's own run.
+ *
+ * Parameters:	pool	< the pool
+ *		worker	< the worker
+ *
+ * Returns:	the task, or -1 if the run is empty
+ *
+ * Date:	17/10/26
+ */
+static int pool_take(struct surf_pool *pool, int worker)
+{
+   struct pool_queue *q;
+   int task;
+
+   q = &pool->queue[worker];
+   task = -1;
+   pthread_mutex_lock(&q->lock);
+   if (q->first < q->last)
+      task = q->first++;
+   pthread_mutex_unlock(&q->lock);
+
+   return(task);
+}
+
+
+/*
+ * Routine:	pool_steal
+ *
+ * Description:	Take the back half of the run of the next worker
+ *		that has any tasks left, keep the first of them to run
+ *		now and make the rest the thief's own run.
+ *
+ * Parameters:	pool	< the pool
+ *		worker	< the thief
+ *
+ * Returns:	the task to run, or -1 if no worker has any left
+ *
+ * Date:	17/10/26
+ */
+static int pool_steal(struct surf_pool *pool, int worker)
+{
+   struct pool_queue *victim;
+   int first,last;
+   int i;
+
+   for(i=1;i<pool->num_workers;i++) {
+      victim = &pool->queue[(worker+i) % pool->num_workers];
+      pthread_mutex_lock(&victim->lock);
+      last = victim->last;
+      first = last - (last-victim->first+1)/2;
+      victim->last = first;
+      pthread_mutex_unlock(&victim->lock);
+
+      if (first < last) {
+         pthread_mutex_lock(&pool->queue[worker].lock);
+         pool->queue[worker].first = first+1;
+         pool->queue[worker].last = last;
+         pthread_mutex_unlock(&pool->queue[worker].lock);
+         return(first);
+      }
+   }
+
+   return(-1);
+}
@@ -0,0 +1,684 @@
+/******************************************************************
+ * Module:	rcache.c
+ *
+ * Purpose:	A cache on disk of the results of analyses, so that a
+ *		profile analysed before in the same way is not
+ *		transformed again (see rcache.h).
+ *
+ * Contents:	rcache_open()	- open or make a cache directory
+ *		rcache_close()	- release a cache
+ *		rcache_fetch()	- the results of a context's data
+ *		rcache_store()	- keep the results of a context
+ *		rcache_get_stats()	- what the cache has done
+ *		rcache_print_stats()	- print what the cache has done
+ *		rcache_key()	- the key of a context's data
+ *		rcache_hash()	- continue a hash over a block
+ *		rcache_path()	- the file of an entry
+ *		rcache_read()	- read an entry into a context
+ *		rcache_scan()	- the entries in the directory
+ *		rcache_evict()	- remove the least recently used
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+/*
+ * global definitions
+ */
+#include "global.h"
+#include "context.h"
+
+/*
+ * declarations
+ */
+#include "rcache.h"
+#include "stats.h"
+
+/*
+ * The first 8 bytes of every entry. An entry is written in the byte
+ * order of the machine that made it, and one of another version or
+ * order is taken as missing.
+ */
+#define RCACHE_MAGIC "SURFRC\r\n"
+#define RCACHE_MAGIC_LEN 8
+#define RCACHE_VERSION 3
+#define RCACHE_BYTE_ORDER 0x01020304
+
+/*
+ * The key is two 64 bit hashes of the data and settings, from
+ * different starting values; each step multiplies by an odd constant
+ * and folds the high bits down.
+ */
+#define RCACHE_SEED_0 0xcbf29ce484222325ULL
+#define RCACHE_SEED_1 0x84222325cbf29ce4ULL
+#define RCACHE_MULTIPLIER 0x9e3779b97f4a7c15ULL
+
+/*
+ * a cache directory and what has been done through it
+ */
+struct rcache {
+   char *dir;
+   long max_bytes;
+   pthread_mutex_t lock;  /* guards "stats" and the writing and removal
+                             of entries */
+   struct rcache_stats stats;
+};
+
+/*
+ * the start of an entry, followed by "spec_num_data" spectral values,
+ * "acf_num_data" autocorrelation values and "smooth_num_data"
+ * smoothed bands
+ */
+struct rcache_header {
+   char magic[RCACHE_MAGIC_LEN];  /* RCACHE_MAGIC */
+   uint32_t version;  /* RCACHE_VERSION */
+   uint32_t byte_order;  /* RCACHE_BYTE_ORDER */
+   uint64_t key[2];
+   int32_t num_data;
+   int32_t trans_num_data;
+   int32_t spec_num_data;
+   int32_t acf_num_data;
+   int32_t smooth_num_data;
+   int32_t reserved;  /* zero */
+   struct surf_params params;
+};
+
+/*
+ * what the results depend on besides the data, hashed after them
+ */
+struct rcache_settings {
+   int32_t version;  /* RCACHE_VERSION */
+   int32_t num_data;
+   int32_t trans_mode;
+   int32_t precision;
+   int32_t welch_length;
+   int32_t welch_overlap;
+   int32_t welch_window;
+   int32_t smooth_mode;
+   int32_t cut_num_data;
+   int32_t reserved;  /* zero */
+   double cutoff;
+   double x_division;
+   double y_division;
+};
+
+/*
+ * an entry found in the directory
+ */
+struct rcache_entry {
+   char *name;
+   time_t used;  /* last written or found */
+   long size;
+};
+
+static void rcache_key(const struct surf_context *ctx, uint64_t key[2]);
+static uint64_t rcache_hash(const void *block, size_t size, uint64_t hash);
+static char *rcache_path(const struct rcache *cache, const uint64_t key[2],
+   const char *suffix);
+static int rcache_read(FILE *f, struct surf_context *ctx);
+static long rcache_scan(struct rcache *cache, struct rcache_entry **entries,
+   int *num_entries);
+static void rcache_evict(struct rcache *cache);
+static int compare_entries(const void *a, const void *b);
+
+
+/*
+ * Routine:	rcache_open
+ *
+ * Description:	Open the cache held in a directory, making the
+ *		directory if there is none, and find the size of the
+ *		entries already in it.
+ *
+ * Parameters:	dir		< the directory
+ *		max_bytes	< the largest size of its entries
+ *
+ * Returns:	the cache, or NULL if the directory cannot be made
+ *		or memory is not available
+ *
+ * Example:	ctx->cache = rcache_open("surf.cache",256L << 20);
+ *
+ * Date:	17/10/26
+ */
+struct rcache *rcache_open(const char *dir, long max_bytes)
+{
+   struct rcache *cache;
+   struct stat info;
+
+   if (stat(dir,&info) != 0 && mkdir(dir,0777) != 0)
+      return(NULL);
+   if (stat(dir,&info) != 0 || !S_ISDIR(info.st_mode))
+      return(NULL);
+
+   cache = (struct rcache *) calloc(1,sizeof(struct rcache));
+   if (cache == NULL)
+      return(NULL);
+   cache->dir = (char *) malloc(strlen(dir)+1);
+   if (cache->dir == NULL) {
+      free(cache);
+      return(NULL);
+   }
+   (void) strcpy(cache->dir,dir);
+   cache->max_bytes = max_bytes;
+   (void) pthread_mutex_init(&cache->lock,NULL);
+   cache->stats.bytes = rcache_scan(cache,NULL,NULL);
+
+   return(cache);
+}
+
+
+/*
+ * Routine:	rcache_close
+ *
+ * Description:	Release a cache; its entries stay on disk.
+ *
+ * Parameters:	cache	< the cache, or NULL
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void rcache_close(struct rcache *cache)
+{
+   if (cache == NULL)
+      return;
+   (void) pthread_mutex_destroy(&cache->lock);
+   free(cache->dir);
+   free(cache);
+}
+
+
+/*
+ * Routine:	rcache_fetch
+ *
+ * Description:	Look up the data of a context with its settings in the
+ *		context's cache, reading the results into the context
+ *		if they are there. An entry that is found has its time
+ *		brought up to date, so that it is the last to be
+ *		removed.
+ *
+ * Parameters:	ctx	<> the analysis context
+ *
+ * Returns:	TRUE	- the results were found
+ *		FALSE	- they were not, or the context has no cache
+ *
+ * Date:	17/10/26
+ */
+int rcache_fetch(struct surf_context *ctx)
+{
+   struct rcache *cache;
+   char *path;
+   FILE *f;
+   int found;
+
+   ctx->cached = FALSE;
+   cache = ctx->cache;
+   if (cache == NULL)
+      return(FALSE);
+
+   rcache_key(ctx,ctx->cache_key);
+   path = rcache_path(cache,ctx->cache_key,RCACHE_EXTENSION);
+   found = FALSE;
+   if (path != NULL) {
+      f = fopen(path,"rb");
+      if (f != NULL) {
+         found = rcache_read(f,ctx);
+         fclose(f);
+      }
+      if (found == TRUE)
+         (void) utime(path,NULL);
+      free(path);
+   }
+
+   (void) pthread_mutex_lock(&cache->lock);
+   if (found == TRUE)
+      cache->stats.hits++;
+   else
+      cache->stats.misses++;
+   (void) pthread_mutex_unlock(&cache->lock);
+   STATS_COUNT(found == TRUE ? STATS_CACHE_HITS : STATS_CACHE_MISSES,1);
+
+   ctx->cached = found;
+   return(found);
+}
+
+
+/*
+ * Routine:	rcache_store
+ *
+ * Description:	Keep the results of a context's data, under the key
+ *		found by rcache_fetch(). The entry is written to a
+ *		temporary file and renamed, so that another process
+ *		sharing the directory never reads half an entry.
+ *
+ * Parameters:	ctx	<> the analysis context
+ *
+ * Returns:	TRUE	- kept
+ *		FALSE	- not kept, or the context has no cache
+ *
+ * Date:	17/10/26
+ */
+int rcache_store(struct surf_context *ctx)
+{
+   struct rcache *cache;
+   struct rcache_header header;
+   char suffix[32];
+   char *path,*temp;
+   FILE *f;
+   int written;
+
+   cache = ctx->cache;
+   if (cache == NULL)
+      return(FALSE);
+
+   memset(&header,0,sizeof(header));
+   memcpy(header.magic,RCACHE_MAGIC,RCACHE_MAGIC_LEN);
+   header.version = RCACHE_VERSION;
+   header.byte_order = RCACHE_BYTE_ORDER;
+   header.key[0] = ctx->cache_key[0];
+   header.key[1] = ctx->cache_key[1];
+   header.num_data = ctx->num_data;
+   header.trans_num_data = ctx->trans_num_data;
+   header.spec_num_data = ctx->spec_num_data;
+   header.acf_num_data = ctx->acf_num_data;
+   header.smooth_num_data = ctx->smooth_num_data;
+   header.params = ctx->params;
+
+   (void) sprintf(suffix,".tmp%ld",(long) getpid());
+   path = rcache_path(cache,ctx->cache_key,RCACHE_EXTENSION);
+   temp = rcache_path(cache,ctx->cache_key,suffix);
+   if (path == NULL || temp == NULL) {
+      free(path);
+      free(temp);
+      return(FALSE);
+   }
+
+   (void) pthread_mutex_lock(&cache->lock);
+   written = FALSE;
+   f = fopen(temp,"wb");
+   if (f != NULL) {
+      if (fwrite(&header,sizeof(header),1,f) == 1
+         && fwrite(ctx->spec_data,sizeof(double),ctx->spec_num_data,f)
+            == (size_t) ctx->spec_num_data
+         && fwrite(ctx->acf,sizeof(double),ctx->acf_num_data,f)
+            == (size_t) ctx->acf_num_data
+         && fwrite(ctx->smooth,sizeof(struct smoothed),ctx->smooth_num_data,
+            f) == (size_t) ctx->smooth_num_data)
+         written = TRUE;
+      if (fclose(f) != 0)
+         written = FALSE;
+   }
+   if (written == TRUE && rename(temp,path) != 0)
+      written = FALSE;
+   if (written == TRUE) {
+      cache->stats.stores++;
+      cache->stats.bytes += (long) (sizeof(header)
+         + (ctx->spec_num_data + ctx->acf_num_data)*sizeof(double)
+         + ctx->smooth_num_data*sizeof(struct smoothed));
+      if (cache->stats.bytes > cache->max_bytes)
+         rcache_evict(cache);
+   }
+   else
+      (void) remove(temp);
+   (void) pthread_mutex_unlock(&cache->lock);
+
+   free(path);
+   free(temp);
+   if (written == TRUE)
+      ctx->cached = TRUE;
+   return(written);
+}
+
+
+/*
+ * Routine:	rcache_get_stats
+ *
+ * Description:	What a cache has done since it was opened.
+ *
+ * Parameters:	cache	< the cache
+ *		stats	> the lookups, entries and size
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void rcache_get_stats(struct rcache *cache, struct rcache_stats *stats)
+{
+   (void) pthread_mutex_lock(&cache->lock);
+   *stats = cache->stats;
+   (void) pthread_mutex_unlock(&cache->lock);
+}
+
+
+/*
+ * Routine:	rcache_print_stats
+ *
+ * Description:	Print what a cache has done on one line.
+ *
+ * Parameters:	cache	< the cache
+ *		f	< where to print
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void rcache_print_stats(struct rcache *cache, FILE *f)
+{
+   struct rcache_stats stats;
+
+   rcache_get_stats(cache,&stats);
+   (void) fprintf(f,"cache: %ld hits, %ld misses, %ld stored, %ld evicted, "
+      "%ld bytes in %s\n",stats.hits,stats.misses,stats.stores,
+      stats.evictions,stats.bytes,cache->dir);
+}
+
+
+/*
+ * Routine:	rcache_key
+ *
+ * Description:	The key of a context's data, as levelled (and
+ *		filtered), and of every setting the results depend on.
+ *
+ * Parameters:	ctx	< the analysis context
+ *		key	> the key
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+static void rcache_key(const struct surf_context *ctx, uint64_t key[2])
+{
+   struct rcache_settings settings;
+
+   memset(&settings,0,sizeof(settings));
+   settings.version = RCACHE_VERSION;
+   settings.num_data = ctx->num_data;
+   settings.trans_mode = ctx->trans_mode;
+   settings.precision = ctx->precision;
+   settings.welch_length = ctx->welch_length;
+   settings.welch_overlap = ctx->welch_overlap;
+   settings.welch_window = ctx->welch_window;
+   settings.smooth_mode = ctx->smooth_mode;
+   settings.cut_num_data = ctx->cut_num_data;
+   settings.cutoff = ctx->cutoff;
+   settings.x_division = ctx->x_division;
+   settings.y_division = ctx->y_division;
+
+   key[0] = rcache_hash(&settings,sizeof(settings),
+      rcache_hash(ctx->data,ctx->num_data*sizeof(double),RCACHE_SEED_0));
+   key[1] = rcache_hash(&settings,sizeof(settings),
+      rcache_hash(ctx->data,ctx->num_data*sizeof(double),RCACHE_SEED_1));
+}
+
+
+/*
+ * Routine:	rcache_hash
+ *
+ * Description:	Continue a 64 bit hash over a block of memory, eight
+ *		bytes at a time.
+ *
+ * Parameters:	block	< the memory
+ *		size	< its size in bytes
+ *		hash	< the hash so far, or a seed
+ *
+ * Returns:	the hash
+ *
+ * Date:	17/10/26
+ */
+static uint64_t rcache_hash(const void *block, size_t size, uint64_t hash)
+{
+   const unsigned char *p;
+   uint64_t word;
+
+   p = (const unsigned char *) block;
+   for(;size>=sizeof(word);size-=sizeof(word),p+=sizeof(word)) {
+      memcpy(&word,p,sizeof(word));
+      hash = (hash ^ word)*RCACHE_MULTIPLIER;
+      hash ^= hash >> 29;
+   }
+   for(;size>0;size--,p++) {
+      hash = (hash ^ *p)*RCACHE_MULTIPLIER;
+      hash ^= hash >> 29;
+   }
+
+   return(hash);
+}
+
+
+/*
+ * Routine:	rcache_path
+ *
+ * Description:	The file name of an entry: the directory, the key in
+ *		hexadecimal and a suffix.
+ *
+ * Parameters:	cache	< the cache
+ *		key	< the key of the entry
+ *		suffix	< RCACHE_EXTENSION, or that of a temporary file
+ *
+ * Returns:	the name, to be freed, or NULL if memory is not
+ *		available
+ *
+ * Date:	17/10/26
+ */
+static char *rcache_path(const struct rcache *cache, const uint64_t key[2],
+   const char *suffix)
+{
+   char *path;
+
+   path = (char *) malloc(strlen(cache->dir) + 34 + strlen(suffix) + 1);
+   if (path == NULL)
+      return(NULL);
+   (void) sprintf(path,"%s/%016llx%016llx%s",cache->dir,
+      (unsigned long long) key[0],(unsigned long long) key[1],suffix);
+
+   return(path);
+}
+
+
+/*
+ * Routine:	rcache_read
+ *
+ * Description:	Read an entry into a context, checking that it is of
+ *		this version and byte order, that its key is the
+ *		context's and that its arrays fit the context's.
+ *
+ * Parameters:	f	< the entry, open for reading
+ *		ctx	<> the analysis context
+ *
+ * Returns:	TRUE	- read
+ *		FALSE	- not an entry for the context; its arrays may
+ *			  have been overwritten
+ *
+ * Date:	17/10/26
+ */
+static int rcache_read(FILE *f, struct surf_context *ctx)
+{
+   struct rcache_header header;
+   int power;
+
+   /*
+    * the sizes of the arrays made by context_reserve()
+    */
+   power = 2;
+   while (power < ctx->num_data)
+      power = 2*power;
+
+   if (fread(&header,sizeof(header),1,f) != 1
+      || memcmp(header.magic,RCACHE_MAGIC,RCACHE_MAGIC_LEN) != 0
+      || header.version != RCACHE_VERSION
+      || header.byte_order != RCACHE_BYTE_ORDER
+      || header.key[0] != ctx->cache_key[0]
+      || header.key[1] != ctx->cache_key[1]
+      || header.num_data != ctx->num_data
+      || header.spec_num_data < 0 || header.spec_num_data > power/2+1
+      || header.acf_num_data < 0 || header.acf_num_data > power+1
+      || header.smooth_num_data < 0
+      || header.smooth_num_data > SMOOTH_MAX_DATA)
+      return(FALSE);
+
+   if (fread(ctx->spec_data,sizeof(double),header.spec_num_data,f)
+         != (size_t) header.spec_num_data
+      || fread(ctx->acf,sizeof(double),header.acf_num_data,f)
+         != (size_t) header.acf_num_data
+      || fread(ctx->smooth,sizeof(struct smoothed),header.smooth_num_data,f)
+         != (size_t) header.smooth_num_data)
+      return(FALSE);
+
+   ctx->trans_num_data = header.trans_num_data;
+   ctx->spec_num_data = header.spec_num_data;
+   ctx->acf_num_data = header.acf_num_data;
+   ctx->smooth_num_data = header.smooth_num_data;
+   ctx->params = header.params;
+
+   return(TRUE);
+}
+
+
+/*
+ * Routine:	rcache_scan
+ *
+ * Description:	Find the entries in the directory of a cache, and
+ *		their total size.
+ *
+ * Parameters:	cache		< the cache
+ *		entries		> the entries, to be freed with their
+ *				  names; NULL for only the size
+ *		num_entries	> number of entries
+ *
+ * Returns:	the total size of the entries in bytes
+ *
+ * Date:	17/10/26
+ */
+static long rcache_scan(struct rcache *cache, struct rcache_entry **entries,
+   int *num_entries)
+{
+   struct rcache_entry *list,*grown;
+   struct stat info;
+   struct dirent *found;
+   DIR *dir;
+   char *path;
+   size_t len,ext_len;
+   int count,max_count;
+   long total;
+
+   list = NULL;
+   count = 0;
+   max_count = 0;
+   total = 0;
+   ext_len = strlen(RCACHE_EXTENSION);
+   dir = opendir(cache->dir);
+   while (dir != NULL && (found = readdir(dir)) != NULL) {
+      len = strlen(found->d_name);
+      if (len <= ext_len
+         || strcmp(found->d_name+len-ext_len,RCACHE_EXTENSION) != 0)
+         continue;
+
+      path = (char *) malloc(strlen(cache->dir) + len + 2);
+      if (path == NULL)
+         break;
+      (void) sprintf(path,"%s/%s",cache->dir,found->d_name);
+      if (stat(path,&info) != 0) {
+         free(path);
+         continue;
+      }
+      total += (long) info.st_size;
+
+      if (entries == NULL) {
+         free(path);
+         continue;
+      }
+      if (count == max_count) {
+         grown = (struct rcache_entry *) realloc(list,
+            (2*max_count + 16)*sizeof(struct rcache_entry));
+         if (grown == NULL) {
+            free(path);
+            break;
+         }
+         list = grown;
+         max_count = 2*max_count + 16;
+      }
+      list[count].name = path;
+      list[count].used = info.st_mtime;
+      list[count].size = (long) info.st_size;
+      count++;
+   }
+   if (dir != NULL)
+      closedir(dir);
+
+   if (entries != NULL) {
+      *entries = list;
+      *num_entries = count;
+   }
+   return(total);
+}
+
+
+/*
+ * Routine:	rcache_evict
+ *
+ * Description:	Remove the least recently used entries of a cache
+ *		until it is within its size. The directory is read
+ *		again, so that entries written by other processes are
+ *		counted too. Called with the cache locked.
+ *
+ * Parameters:	cache	<> the cache
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+static void rcache_evict(struct rcache *cache)
+{
+   struct rcache_entry *entries;
+   int num_entries;
+   long total;
+   int i;
+
+   entries = NULL;
+   num_entries = 0;
+   total = rcache_scan(cache,&entries,&num_entries);
+   if (num_entries > 1)
+      qsort(entries,num_entries,sizeof(struct rcache_entry),
+         compare_entries);
+
+   for(i=0;i<num_entries && total>cache->max_bytes;i++) {
+      if (remove(entries[i].name) == 0) {
+         total -= entries[i].size;
+         cache->stats.evictions++;
+      }
+   }
+   cache->stats.bytes = total;
+
+   for(i=0;i<num_entries;i++)
+      free(entries[i].name);
+   free(entries);
+}
+
+
+/*
+ * Routine:	compare_entries
+ *
+ * Description:	qsort() comparison of two entries, least recently
+ *		used first.
+ *
+ * Date:	17/10/26
+ */
+static int compare_entries(const void *a, const void *b)
+{
+   const struct rcache_entry *x,*y;
+
+   x = (const struct rcache_entry *) a;
+   y = (const struct rcache_entry *) b;
+   if (x->used < y->used)
+      return(-1);
+   return(x->used > y->used ? 1 : 0);
+}
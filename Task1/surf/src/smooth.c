@@ -0,0 +1,195 @@
+/******************************************************************
+ * Module:	smooth.c
+ *
+ * Purpose:	Smoothing of the spectral data by averaging them over
+ *		bands of frequency.
+ *
+ * Contents:	smooth_spectrum()	- average the spectrum over bands
+ *		smooth_combine()	- add the bands to the saved average
+ *		smooth_clear()	- forget the saved average
+ *		smooth_edges()	- first subscript of each band
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+#include <math.h>
+
+/*
+ * global definitions
+ */
+#include "global.h"
+#include "context.h"
+
+/*
+ * declarations
+ */
+#include "smooth.h"
+
+static void smooth_edges(int mode, int cut, int num_bands, int *edge);
+
+
+/*
+ * Routine:	smooth_spectrum
+ *
+ * Description:	Average the spectral data over at most SMOOTH_MAX_DATA
+ *		bands, spaced as "smooth_mode", leaving them in
+ *		"smooth". The mean (subscript 0) and any values from
+ *		"cut_num_data" up are left out. Each band holds the
+ *		first subscript it covers and the mean of the values
+ *		up to the next band. One pass over the values finds
+ *		every band.
+ *
+ * Parameters:	ctx	<> the analysis context
+ *
+ * Returns:	nothing
+ *
+ * Example:	20 linear bands of 4097 values cover subscripts 1-204,
+ *		205-409, ... 3892-4096; 20 log bands start at 1, 2, 3,
+ *		4, 5, 8, 12, ... 2702
+ *
+ * Date:	17/10/26
+ */
+void smooth_spectrum(struct surf_context *ctx)
+{
+   int edge[SMOOTH_MAX_DATA+1];
+   double sum;
+   int cut,num_bands;
+   int b,k;
+
+   cut = ctx->spec_num_data;
+   if (ctx->cut_num_data > 0 && ctx->cut_num_data < cut)
+      cut = ctx->cut_num_data;
+   num_bands = SMOOTH_MAX_DATA;
+   if (num_bands > cut-1)
+      num_bands = cut-1;
+   if (num_bands < 1) {
+      ctx->smooth_num_data = 0;
+      return;
+   }
+   smooth_edges(ctx->smooth_mode,cut,num_bands,edge);
+
+   /*
+    * The running sum is started again at each edge rather than
+    * differenced, since the later bands of a falling spectrum are
+    * small beside the total of the earlier ones.
+    */
+   b = 0;
+   sum = 0.0;
+   for(k=edge[0];k<cut;k++) {
+      sum += ctx->spec_data[k];
+      if (k+1 == edge[b+1]) {
+         ctx->smooth[b].subscr = edge[b];
+         ctx->smooth[b].data = sum/(edge[b+1] - edge[b]);
+         sum = 0.0;
+         b++;
+      }
+   }
+   ctx->smooth_num_data = num_bands;
+}
+
+
+/*
+ * Routine:	smooth_combine
+ *
+ * Description:	Add the bands of the current profile to the running
+ *		average of the profiles combined so far in
+ *		"saved_smooth", counted by "num_combinations".
+ *
+ * Parameters:	ctx	<> the analysis context
+ *
+ * Returns:	TRUE		- added
+ *		ER_BANDS	- the bands differ from those saved
+ *
+ * Example:	for each profile: load_file(), calculate_fft(),
+ *		smooth_combine()
+ *
+ * Date:	17/10/26
+ */
+int smooth_combine(struct surf_context *ctx)
+{
+   int b;
+
+   if (ctx->num_combinations == 0) {
+      for(b=0;b<ctx->smooth_num_data;b++)
+         ctx->saved_smooth[b] = ctx->smooth[b];
+      ctx->saved_num_data = ctx->smooth_num_data;
+      ctx->num_combinations = 1;
+      return(TRUE);
+   }
+
+   /*
+    * only spectra of the same bands can be averaged
+    */
+   if (ctx->saved_num_data != ctx->smooth_num_data) {
+      ctx->error_number = ER_BANDS;
+      return(ER_BANDS);
+   }
+   for(b=0;b<ctx->smooth_num_data;b++) {
+      if (ctx->saved_smooth[b].subscr != ctx->smooth[b].subscr) {
+         ctx->error_number = ER_BANDS;
+         return(ER_BANDS);
+      }
+   }
+
+   ctx->num_combinations++;
+   for(b=0;b<ctx->smooth_num_data;b++)
+      ctx->saved_smooth[b].data += (ctx->smooth[b].data
+         - ctx->saved_smooth[b].data)/ctx->num_combinations;
+
+   return(TRUE);
+}
+
+
+/*
+ * Routine:	smooth_clear
+ *
+ * Description:	Start a new average of smoothed spectra.
+ *
+ * Parameters:	ctx	<> the analysis context
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void smooth_clear(struct surf_context *ctx)
+{
+   ctx->num_combinations = 0;
+   ctx->saved_num_data = 0;
+}
+
+
+/*
+ * Routine:	smooth_edges
+ *
+ * Description:	The first subscript of each of "num_bands" bands
+ *		covering subscripts 1 to cut-1, and "cut" after the
+ *		last. Log-spaced edges are kept at least one apart, so
+ *		that the first bands may be single values.
+ *
+ * Parameters:	mode		< SMOOTH_LINEAR or SMOOTH_LOG
+ *		cut		< one past the last subscript
+ *		num_bands	< number of bands, at most cut-1
+ *		edge		> num_bands+1 subscripts
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+static void smooth_edges(int mode, int cut, int num_bands, int *edge)
+{
+   int b,e;
+
+   edge[0] = 1;
+   for(b=1;b<num_bands;b++) {
+      if (mode == SMOOTH_LOG)
+         e = (int) floor(pow((double) cut,(double) b/num_bands));
+      else
+         e = 1 + (int) ((double) b*(cut-1)/num_bands);
+      if (e < edge[b-1]+1)
+         e = edge[b-1]+1;
+      if (e > cut-(num_bands-b))
+         e = cut-(num_bands-b);
+      edge[b] = e;
+   }
+   edge[num_bands] = cut;
+}
@@ -0,0 +1,321 @@
+/******************************************************************
+ * Module:	stats.c
+ *
+ * Purpose:	Timings of the stages of the analyses and counts of
+ *		what they processed.
+ *
+ * Contents:	stats_enable()	- start gathering
+ *		stats_clock()	- monotonic clock
+ *		stats_time()	- add the time of a stage
+ *		stats_add()	- add to a counter
+ *		stats_print()	- print what was gathered
+ *		stats_format_name()	- format from its name
+ *		stats_percentile()	- a percentile of sorted times
+ *		compare_times()	- order of two times, for qsort()
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
+/*
+ * global definitions
+ */
+#include "global.h"
+
+/*
+ * declarations
+ */
+#include "stats.h"
+
+/*
+ * Structure:	stats_stage
+ *
+ * Description:	What has been gathered for one stage: every call is
+ *		in the count, total and longest, and the first
+ *		STATS_MAX_TIMES calls are kept for the percentiles.
+ */
+struct stats_stage {
+   long calls;
+   uint64_t total;
+   uint64_t max;
+   uint64_t *times;
+   long num_times;
+   long size;  /* of times */
+};
+
+static const char *stats_stage_names[STATS_NUM_STAGES] = {
+   "load", "level", "filter", "fft", "spectrum", "welch", "params",
+   "write"};
+
+static const char *stats_counter_names[STATS_NUM_COUNTERS] = {
+   "profiles", "samples", "bytes_read", "cache_hits", "cache_misses"};
+
+/*
+ * set once by stats_enable(), before any threads, and only read
+ * after that
+ */
+int stats_enabled = FALSE;
+
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct stats_stage stats_stages[STATS_NUM_STAGES];
+static long stats_counters[STATS_NUM_COUNTERS];
+
+static uint64_t stats_percentile(const uint64_t *times, long n, int p);
+static int compare_times(const void *a, const void *b);
+
+
+/*
+ * Routine:	stats_enable
+ *
+ * Description:	Start gathering timings and counts.
+ *
+ * Parameters:	none
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void stats_enable()
+{
+   stats_enabled = TRUE;
+}
+
+
+/*
+ * Routine:	stats_clock
+ *
+ * Description:	The monotonic clock, in nanoseconds.
+ *
+ * Parameters:	none
+ *
+ * Returns:	the time
+ *
+ * Date:	17/10/26
+ */
+uint64_t stats_clock()
+{
+   struct timespec now;
+
+   (void) clock_gettime(CLOCK_MONOTONIC,&now);
+   return((uint64_t) now.tv_sec*1000000000u + (uint64_t) now.tv_nsec);
+}
+
+
+/*
+ * Routine:	stats_time
+ *
+ * Description:	Add one call of a stage and the time it took. Once the
+ *		kept times cannot grow, the call still counts in the
+ *		totals.
+ *
+ * Parameters:	stage	< the stage
+ *		ns	< the time taken, in nanoseconds
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void stats_time(int stage, uint64_t ns)
+{
+   struct stats_stage *s;
+   uint64_t *times;
+   long size;
+
+   if ((stage < 0) || (stage >= STATS_NUM_STAGES))
+      return;
+   s = &stats_stages[stage];
+   pthread_mutex_lock(&stats_lock);
+   s->calls++;
+   s->total += ns;
+   if (ns > s->max)
+      s->max = ns;
+   if ((s->num_times == s->size) && (s->size < STATS_MAX_TIMES)) {
+      size = (s->size == 0) ? 64 : 2*s->size;
+      if (size > STATS_MAX_TIMES)
+         size = STATS_MAX_TIMES;
+      times = (uint64_t *) realloc(s->times,size*sizeof(uint64_t));
+      if (times != NULL) {
+         s->times = times;
+         s->size = size;
+      }
+   }
+   if (s->num_times < s->size)
+      s->times[s->num_times++] = ns;
+   pthread_mutex_unlock(&stats_lock);
+}
+
+
+/*
+ * Routine:	stats_add
+ *
+ * Description:	Add to a counter.
+ *
+ * Parameters:	counter	< the counter
+ *		n	< the amount
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void stats_add(int counter, long n)
+{
+   if ((counter < 0) || (counter >= STATS_NUM_COUNTERS))
+      return;
+   pthread_mutex_lock(&stats_lock);
+   stats_counters[counter] += n;
+   pthread_mutex_unlock(&stats_lock);
+}
+
+
+/*
+ * Routine:	stats_print
+ *
+ * Description:	Print what was gathered, as a table or as one JSON
+ *		object. The share of a stage is of the time of all the
+ *		stages together, added up over every thread; the times
+ *		are the nearest-rank percentiles of the kept calls.
+ *
+ * Parameters:	f	< where to print
+ *		format	< STATS_TEXT or STATS_JSON
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void stats_print(FILE *f, int format)
+{
+   struct stats_stage *s;
+   uint64_t *sorted;
+   uint64_t all,p50,p90,p99;
+   int i,first;
+
+   pthread_mutex_lock(&stats_lock);
+   all = 0;
+   for(i=0;i<STATS_NUM_STAGES;i++)
+      all += stats_stages[i].total;
+   if (format == STATS_JSON)
+      (void) fprintf(f,"{\"stages\":{");
+   else
+      (void) fprintf(f,"%-10s %8s %12s %6s %10s %10s %10s %10s\n",
+         "stage","calls","total ms","share","p50 us","p90 us","p99 us",
+         "max us");
+   first = TRUE;
+   for(i=0;i<STATS_NUM_STAGES;i++) {
+      s = &stats_stages[i];
+      if (s->calls == 0)
+         continue;
+      p50 = p90 = p99 = 0;
+      sorted = (uint64_t *) malloc((s->num_times+1)*sizeof(uint64_t));
+      if ((sorted != NULL) && (s->num_times > 0)) {
+         memcpy(sorted,s->times,s->num_times*sizeof(uint64_t));
+         qsort(sorted,s->num_times,sizeof(uint64_t),compare_times);
+         p50 = stats_percentile(sorted,s->num_times,50);
+         p90 = stats_percentile(sorted,s->num_times,90);
+         p99 = stats_percentile(sorted,s->num_times,99);
+      }
+      free(sorted);
+      if (format == STATS_JSON) {
+         (void) fprintf(f,"%s\"%s\":{\"calls\":%ld,\"total_ns\":%llu,"
+            "\"p50_ns\":%llu,\"p90_ns\":%llu,\"p99_ns\":%llu,"
+            "\"max_ns\":%llu}",(first == TRUE) ? "" : ",",
+            stats_stage_names[i],s->calls,(unsigned long long) s->total,
+            (unsigned long long) p50,(unsigned long long) p90,
+            (unsigned long long) p99,(unsigned long long) s->max);
+      }
+      else {
+         (void) fprintf(f,"%-10s %8ld %12.3f %5.1f%% %10.3f %10.3f "
+            "%10.3f %10.3f\n",stats_stage_names[i],s->calls,
+            1e-6*s->total,(all == 0) ? 0.0 : 100.0*s->total/all,
+            1e-3*p50,1e-3*p90,1e-3*p99,1e-3*s->max);
+      }
+      first = FALSE;
+   }
+   if (format == STATS_JSON) {
+      (void) fprintf(f,"},\"total_ns\":%llu,\"counters\":{",
+         (unsigned long long) all);
+      for(i=0;i<STATS_NUM_COUNTERS;i++)
+         (void) fprintf(f,"%s\"%s\":%ld",(i == 0) ? "" : ",",
+            stats_counter_names[i],stats_counters[i]);
+      (void) fprintf(f,"}}\n");
+   }
+   else {
+      (void) fprintf(f,"%-10s %8s %12.3f\n","all","",1e-6*all);
+      for(i=0;i<STATS_NUM_COUNTERS;i++)
+         (void) fprintf(f,"%-12s %ld\n",stats_counter_names[i],
+            stats_counters[i]);
+   }
+   pthread_mutex_unlock(&stats_lock);
+}
+
+
+/*
+ * Routine:	stats_format_name
+ *
+ * Description:	The format named "text" or "json".
+ *
+ * Parameters:	name	< the name
+ *
+ * Returns:	the format, or FALSE if the name is not known
+ *
+ * Date:	17/10/26
+ */
+int stats_format_name(const char *name)
+{
+   if (strcmp(name,"text") == 0)
+      return(STATS_TEXT);
+   if (strcmp(name,"json") == 0)
+      return(STATS_JSON);
+   return(FALSE);
+}
+
+
+/*
+ * Routine:	stats_percentile
+ *
+ * Description:	The nearest-rank percentile of times sorted into
+ *		ascending order.
+ *
+ * Parameters:	times	< the times, sorted
+ *		n	< how many, at least 1
+ *		p	< the percentile, 1 to 100
+ *
+ * Returns:	the time
+ *
+ * Date:	17/10/26
+ */
+static uint64_t stats_percentile(const uint64_t *times, long n, int p)
+{
+   long rank;
+
+   rank = (p*n + 99)/100;
+   if (rank < 1)
+      rank = 1;
+   return(times[rank-1]);
+}
+
+
+/*
+ * Routine:	compare_times
+ *
+ * Description:	The order of two times, for qsort().
+ *
+ * Parameters:	a, b	< the times
+ *
+ * Returns:	-1, 0 or 1
+ *
+ * Date:	17/10/26
+ */
+static int compare_times(const void *a, const void *b)
+{
+   uint64_t x,y;
+
+   x = *(const uint64_t *) a;
+   y = *(const uint64_t *) b;
+   return((x > y) - (x < y));
+}
@@ -0,0 +1,242 @@
+/******************************************************************
+ * Module:	surf.c
+ *
+ * Purpose:	The analysis of a profile as a library (libsurf), for
+ *		programs that hold the samples in memory rather than
+ *		in a Talysurf file.
+ *
+ * Contents:	surf_settings_default()	- the settings of surf
+ *		surf_analyze()	- analyse samples held in memory
+ *		surf_analyze_file()	- analyse a Talysurf file
+ *		surf_apply()	- give a context the settings
+ *		surf_finish()	- transform, parameters and result
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+/*
+ * global definitions
+ */
+#include "global.h"
+#include "context.h"
+
+/*
+ * declarations
+ */
+#include "surf.h"
+#include "load.h"
+#include "fourier.h"
+#include "online.h"
+#include "welch.h"
+#include "smooth.h"
+#include "gauss.h"
+#include "form.h"
+
+static void surf_apply(struct surf_context *ctx,
+   const struct surf_settings *settings);
+static int surf_finish(struct surf_context *ctx, struct surf_result *result);
+
+
+/*
+ * Routine:	surf_settings_default
+ *
+ * Description:	The settings surf starts with: a padded transform of
+ *		the whole profile, levelled to its best-fitting line,
+ *		in double, in linear bands, with samples in microns
+ *		taken SAMPLE_INT apart.
+ *
+ * Parameters:	settings	> the settings
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void surf_settings_default(struct surf_settings *settings)
+{
+   settings->trans_mode = TRANS_PADDED;
+   settings->precision = PRECISION_DOUBLE;
+   settings->welch_length = 0;
+   settings->welch_overlap = -1;
+   settings->welch_window = WELCH_HANN;
+   settings->smooth_mode = SMOOTH_LINEAR;
+   settings->cut_num_data = 0;
+   settings->form = FORM_LINE;
+   settings->cutoff = 0.0;
+   settings->x_division = SAMPLE_INT;
+   settings->y_division = 1.0;
+}
+
+
+/*
+ * Routine:	surf_analyze
+ *
+ * Description:	Level, transform and calculate the parameters of
+ *		"num_data" samples. The samples are read where they
+ *		are and not changed; the levelled profile is written
+ *		straight into the context's arrays and, with a
+ *		"cutoff", split into roughness and waviness (see
+ *		gauss_filter()). A context is used by one thread at a
+ *		time, but any number of contexts may be analysing at
+ *		once.
+ *
+ * Parameters:	ctx		<> the analysis context
+ *		samples		< the samples
+ *		num_data	< number of samples
+ *		settings	< how they are analysed
+ *		result		> what was found
+ *
+ * Returns:	TRUE		- successful analysis
+ *		ER_COUNT	- fewer than 2 samples
+ *		ER_MEM		- no memory
+ *
+ * Example:	surf_settings_default(&settings);
+ *		surf_analyze(ctx,samples,7500,&settings,&result);
+ *
+ * Date:	17/10/26
+ */
+int surf_analyze(struct surf_context *ctx, const double *samples,
+   int num_data, const struct surf_settings *settings,
+   struct surf_result *result)
+{
+   double a,b;
+   int i;
+
+   if (num_data < 2) {
+      ctx->error_number = ER_COUNT;
+      return(ER_COUNT);
+   }
+
+   surf_apply(ctx,settings);
+   ctx->mag_set = 0;
+   ctx->filter_set = FILTER_FREE;
+   ctx->x_division = settings->x_division;
+   ctx->y_division = settings->y_division;
+   ctx->num_data = num_data;
+   if (context_reserve(ctx,num_data) != TRUE)
+      return(ER_MEM);
+
+   /*
+    * The statistics of the samples give the best-fitting line, and
+    * the levelled profile is the only copy made of them: the samples
+    * are taken off the line as they are moved into the context
+    * (remove_bias() does the same in place for a file). Any other
+    * form is taken off the copy.
+    */
+   if (ctx->form != FORM_LINE) {
+      for(i=0;i<num_data;i++)
+         ctx->data[i] = samples[i];
+      form_remove(ctx);
+   }
+   else {
+      online_reset(&ctx->online);
+      (void) online_add_block(&ctx->online,samples,num_data);
+      online_fit(&ctx->online,&a,&b);
+      for(i=0;i<num_data;i++)
+         ctx->data[i] = samples[i] - (a+b*i);
+   }
+   if (gauss_filter(ctx) != TRUE)
+      return(ER_MEM);
+   ctx->data_valid = TRUE;
+
+   return(surf_finish(ctx,result));
+}
+
+
+/*
+ * Routine:	surf_analyze_file
+ *
+ * Description:	Load, transform and calculate the parameters of a
+ *		Talysurf file, text or binary (see load_file()).
+ *
+ * Parameters:	ctx		<> the analysis context
+ *		filename	< the file
+ *		settings	< how it is analysed
+ *		result		> what was found
+ *
+ * Returns:	TRUE	- successful analysis
+ *		otherwise the error of load_file(), or ER_MEM
+ *
+ * Example:	surf_analyze_file(ctx,"data/m1g2.txt",&settings,&result);
+ *
+ * Date:	17/10/26
+ */
+int surf_analyze_file(struct surf_context *ctx, const char *filename,
+   const struct surf_settings *settings, struct surf_result *result)
+{
+   int status;
+
+   surf_apply(ctx,settings);
+   status = load_file(ctx,filename);
+   if (status != TRUE)
+      return(status);
+   ctx->data_valid = TRUE;
+
+   return(surf_finish(ctx,result));
+}
+
+
+/*
+ * Routine:	surf_apply
+ *
+ * Description:	Give a context the settings that do not depend on
+ *		where the samples come from.
+ *
+ * Parameters:	ctx		<> the analysis context
+ *		settings	< the settings
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+static void surf_apply(struct surf_context *ctx,
+   const struct surf_settings *settings)
+{
+   ctx->trans_mode = settings->trans_mode;
+   ctx->precision = settings->precision;
+   ctx->welch_length = settings->welch_length;
+   ctx->welch_overlap = settings->welch_overlap;
+   ctx->welch_window = settings->welch_window;
+   ctx->smooth_mode = settings->smooth_mode;
+   ctx->cut_num_data = settings->cut_num_data;
+   ctx->form = settings->form;
+   ctx->cutoff = settings->cutoff;
+   ctx->data_valid = FALSE;
+   ctx->tfm_valid = FALSE;
+   ctx->cached = FALSE;
+}
+
+
+/*
+ * Routine:	surf_finish
+ *
+ * Description:	Transform the levelled profile of a context, calculate
+ *		its parameters and point the result at them.
+ *
+ * Parameters:	ctx	<> the analysis context
+ *		result	> what was found
+ *
+ * Returns:	TRUE	- successful analysis
+ *		ER_MEM	- no memory for a transform
+ *
+ * Date:	17/10/26
+ */
+static int surf_finish(struct surf_context *ctx, struct surf_result *result)
+{
+   if (calculate_fft(ctx) != TRUE || calc_params(ctx) != TRUE)
+      return(ctx->error_number);
+   ctx->tfm_valid = TRUE;
+
+   result->num_data = ctx->num_data;
+   result->data = ctx->data;
+   result->waviness = ctx->cutoff > 0.0 ? ctx->smooth_data : NULL;
+   result->trans_num_data = ctx->trans_num_data;
+   result->params = ctx->params;
+   result->spec_num_data = ctx->spec_num_data;
+   result->spec_data = ctx->spec_data;
+   result->acf_num_data = ctx->acf_num_data;
+   result->acf = ctx->acf;
+   result->smooth_num_data = ctx->smooth_num_data;
+   result->smooth = ctx->smooth;
+
+   return(TRUE);
+}
@@ -0,0 +1,299 @@
+/******************************************************************
+ * Module:	surfb.c
+ *
+ * Purpose:	The binary profile format (".surfb"): a fixed header
+ *		followed by an aligned block of samples that is copied
+ *		out of the mapped file into the data array without
+ *		parsing; int16 counts are scaled on the way.
+ *
+ * Contents:	surfb_is_binary()	- test for the binary format
+ *		surfb_read()	- read a binary file held in memory
+ *		surfb_write()	- write a profile in the binary format
+ *		surfb_checksum()	- checksum of a block of memory
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+
+/*
+ * global definitions
+ */
+#include "global.h"
+#include "context.h"
+#include "load.h"
+#include "surfb.h"
+
+/*
+ * multiplier of the checksum
+ */
+#define SURFB_CHECKSUM_PRIME 0x100000001b3ULL
+
+/*
+ * largest int16 count
+ */
+#define SURFB_INT16_MAX 32767
+
+
+/*
+ * Routine:	surfb_is_binary
+ *
+ * Description:	Test whether a file held in memory starts with
+ *		SURFB_MAGIC.
+ *
+ * Parameters:	text	< the contents of the file
+ *		size	< its size in bytes
+ *
+ * Returns:	TRUE	- a binary file
+ *		FALSE	- anything else
+ *
+ * Date:	17/10/26
+ */
+int surfb_is_binary(const char *text, size_t size)
+{
+   if (size < SURFB_MAGIC_LEN
+      || memcmp(text,SURFB_MAGIC,SURFB_MAGIC_LEN) != 0)
+      return(FALSE);
+   return(TRUE);
+}
+
+
+/*
+ * Routine:	surfb_read
+ *
+ * Description:	Check the header and checksum of a binary file held in
+ *		memory and copy its settings, scaling factors and
+ *		samples into the context, adding the samples to its
+ *		statistics.
+ *
+ * Parameters:	ctx	<> the analysis context
+ *		text	< the contents of the file
+ *		size	< its size in bytes
+ *
+ * Returns:	TRUE	- no errors
+ *		ER_MAG	- magnification number invalid
+ *		ER_FILT	- filter setting invalid
+ *		ER_COMPAT	- not a binary file this version can read,
+ *			  or the checksum is wrong
+ *		ER_COUNT	- too few or too many samples
+ *		ER_MEM	- no memory for the samples
+ *
+ * Date:	17/10/26
+ */
+int surfb_read(struct surf_context *ctx, const char *text, size_t size)
+{
+   struct surfb_header header;
+   const char *block;  /* the samples */
+   size_t block_size;
+   uint64_t sum;
+   const int16_t *counts;
+   int i;
+
+   /*
+    * the header, which must be one this version can read
+    */
+   if (size < sizeof(header)) {
+      ctx->error_number = ER_COMPAT;
+      return(ER_COMPAT);
+   }
+   (void) memcpy(&header,text,sizeof(header));
+   if (memcmp(header.magic,SURFB_MAGIC,SURFB_MAGIC_LEN) != 0
+      || header.version != SURFB_VERSION
+      || header.byte_order != SURFB_BYTE_ORDER
+      || (header.sample_type != SURFB_FLOAT64
+         && header.sample_type != SURFB_INT16)
+      || header.data_offset < sizeof(header)
+      || header.data_offset % SURFB_ALIGN != 0
+      || header.data_offset > size) {
+      ctx->error_number = ER_COMPAT;
+      return(ER_COMPAT);
+   }
+
+   /*
+    * the settings, checked just as for a text file
+    */
+   ctx->mag_set = header.mag_set;
+   ctx->filter_set = header.filter_set;
+   if (check_mag(ctx) != TRUE)
+      return(ER_MAG);
+   if (check_filter(ctx) != TRUE)
+      return(ER_FILT);
+
+   /*
+    * the sample block must hold exactly the samples taken with this
+    * filter (at least two for FILTER_FREE), and must not have been
+    * altered
+    */
+   block = text + header.data_offset;
+   block_size = header.num_data * (header.sample_type == SURFB_FLOAT64 ?
+      sizeof(double) : sizeof(int16_t));
+   if (ctx->filter_set == FILTER_FREE && header.num_data <= INT_MAX)
+      ctx->num_data = (int) header.num_data;
+   if (header.num_data != (uint32_t) ctx->num_data || ctx->num_data < 2
+      || block_size != size - header.data_offset) {
+      ctx->error_number = ER_COUNT;
+      return(ER_COUNT);
+   }
+
+   sum = header.checksum;
+   header.checksum = 0;
+   if (surfb_checksum(block,block_size,
+      surfb_checksum(&header,sizeof(header),SURFB_CHECKSUM_START)) != sum) {
+      ctx->error_number = ER_COMPAT;
+      return(ER_COMPAT);
+   }
+
+   ctx->x_division = header.x_division;
+   ctx->y_division = header.y_division;
+   if (context_reserve(ctx,ctx->num_data) != TRUE)
+      return(ER_MEM);
+
+   /*
+    * float64 samples are copied as they are; int16 counts are
+    * scaled
+    */
+   if (header.sample_type == SURFB_FLOAT64)
+      (void) memcpy(ctx->data,block,block_size);
+   else {
+      counts = (const int16_t *) block;
+      for(i=0;i<ctx->num_data;i++)
+         ctx->data[i] = counts[i]*header.sample_scale;
+   }
+   (void) online_add_block(&ctx->online,ctx->data,ctx->num_data);
+
+   return(TRUE);
+}
+
+
+/*
+ * Routine:	surfb_write
+ *
+ * Description:	Write the profile held in a context (as read, before
+ *		remove_bias()) in the binary format. Int16 samples are
+ *		scaled so that the largest sample is 32767 counts; this
+ *		loses precision, float64 does not.
+ *
+ * Parameters:	ctx		< the analysis context
+ *		filename	< the file to be written
+ *		sample_type	< SURFB_FLOAT64 or SURFB_INT16
+ *
+ * Returns:	TRUE	- file written
+ *		ER_FIL	- the file could not be written
+ *		ER_MEM	- no memory for the sample block
+ *
+ * Example:	surfb_write(ctx,"data/m1g2.surfb",SURFB_FLOAT64);
+ *
+ * Date:	17/10/26
+ */
+int surfb_write(const struct surf_context *ctx, const char *filename,
+   int sample_type)
+{
+   struct surfb_header header;
+   char pad[SURFB_ALIGN];
+   void *block;
+   size_t block_size;
+   int16_t *counts;
+   double largest;
+   FILE *f;
+   int i;
+
+   /*
+    * the sample block
+    */
+   memset(&header,0,sizeof(header));
+   header.sample_scale = 1.0;
+   if (sample_type == SURFB_INT16) {
+      largest = 0.0;
+      for(i=0;i<ctx->num_data;i++)
+         if (fabs(ctx->data[i]) > largest)
+            largest = fabs(ctx->data[i]);
+      if (largest > 0.0)
+         header.sample_scale = largest/SURFB_INT16_MAX;
+
+      block_size = ctx->num_data*sizeof(int16_t);
+      counts = (int16_t *) malloc(block_size);
+      if (counts == NULL)
+         return(ER_MEM);
+      for(i=0;i<ctx->num_data;i++)
+         counts[i] = (int16_t) floor(ctx->data[i]/header.sample_scale+0.5);
+      block = counts;
+   }
+   else {
+      sample_type = SURFB_FLOAT64;
+      block_size = ctx->num_data*sizeof(double);
+      block = ctx->data;
+   }
+
+   /*
+    * the header
+    */
+   (void) memcpy(header.magic,SURFB_MAGIC,SURFB_MAGIC_LEN);
+   header.version = SURFB_VERSION;
+   header.byte_order = SURFB_BYTE_ORDER;
+   header.mag_set = ctx->mag_set;
+   header.filter_set = ctx->filter_set;
+   header.sample_type = sample_type;
+   header.num_data = ctx->num_data;
+   header.data_offset = SURFB_DATA_OFFSET;
+   header.x_division = ctx->x_division;
+   header.y_division = ctx->y_division;
+   header.checksum = surfb_checksum(block,block_size,
+      surfb_checksum(&header,sizeof(header),SURFB_CHECKSUM_START));
+
+   /*
+    * header, padding up to the sample block, samples
+    */
+   memset(pad,0,sizeof(pad));
+   f = fopen(filename,"wb");
+   if (f != NULL) {
+      if (fwrite(&header,sizeof(header),1,f) != 1
+         || fwrite(pad,SURFB_DATA_OFFSET-sizeof(header),1,f) != 1
+         || fwrite(block,block_size,1,f) != 1) {
+         fclose(f);
+         f = NULL;
+      }
+      else if (fclose(f) != 0)
+         f = NULL;
+   }
+   if (block != ctx->data)
+      free(block);
+
+   return(f == NULL ? ER_FIL : TRUE);
+}
+
+
+/*
+ * Routine:	surfb_checksum
+ *
+ * Description:	Continue a 64 bit FNV-1a style checksum over a block
+ *		of memory, eight bytes at a time.
+ *
+ * Parameters:	block	< the memory
+ *		size	< its size in bytes
+ *		sum	< the checksum so far (SURFB_CHECKSUM_START to
+ *			  begin)
+ *
+ * Returns:	the checksum
+ *
+ * Date:	17/10/26
+ */
+uint64_t surfb_checksum(const void *block, size_t size, uint64_t sum)
+{
+   const unsigned char *p;
+   uint64_t word;
+   size_t i;
+
+   p = (const unsigned char *) block;
+   for(i=0;i+sizeof(word)<=size;i+=sizeof(word)) {
+      (void) memcpy(&word,p+i,sizeof(word));
+      sum = (sum ^ word) * SURFB_CHECKSUM_PRIME;
+   }
+   for(;i<size;i++)
+      sum = (sum ^ p[i]) * SURFB_CHECKSUM_PRIME;
+
+   return(sum);
+}
@@ -0,0 +1,137 @@
+/******************************************************************
+ * Module:	surfconv.c
+ *
+ * Purpose:	Convert Talysurf text data files to the binary format
+ *		(see surfb.h).
+ *
+ * Contents:	main		- convert the files named on the command
+ *				  line
+ *		convert_name	- name of the binary file
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * global definitions
+ */
+#include "global.h"
+#include "context.h"
+
+/*
+ * declarations
+ */
+#include "load.h"
+#include "batch.h"
+#include "surfb.h"
+
+static char *convert_name(const char *filename);
+
+
+/*
+ * Routine:	main
+ *
+ * Description:	Convert every file named on the command line, writing
+ *		"name.surfb" beside "name.txt". The samples are stored
+ *		as float64 unless "--int16" is given.
+ *
+ *		surfconv [--int16] file ...
+ *
+ * Parameters:	argc	< number of command line arguments
+ *		argv	< the command line arguments
+ *
+ * Returns:	TRUE		- every file converted
+ *		positive integer	- the last error
+ *
+ * Example:	surfconv data/m1g2.txt data/m1g3.txt
+ *
+ * Date:	17/10/26
+ */
+int main(int argc, char *argv[])
+{
+   struct surf_context *ctx;
+   int sample_type;
+   char *out_name;
+   int status,result;
+   int i;
+
+   ctx = context_create();
+   if (ctx == NULL) {
+      (void) fprintf(stderr,"%s\n",error_string(ER_MEM));
+      return(ER_MEM);
+   }
+
+   sample_type = SURFB_FLOAT64;
+   for(i=1;i<argc;i++) {
+      if (strcmp(argv[i],"--int16") == 0)
+         sample_type = SURFB_INT16;
+   }
+
+   result = TRUE;
+   for(i=1;i<argc;i++) {
+      if (strncmp(argv[i],"--",2) == 0)
+         continue;
+
+      /*
+       * the samples as they are in the file, before remove_bias()
+       */
+      status = load_raw(ctx,argv[i]);
+      if (status == TRUE) {
+         out_name = convert_name(argv[i]);
+         if (out_name == NULL)
+            status = ER_MEM;
+         else {
+            status = surfb_write(ctx,out_name,sample_type);
+            if (status == TRUE)
+               (void) printf("%s -> %s\n",argv[i],out_name);
+            free(out_name);
+         }
+      }
+      if (status != TRUE) {
+         (void) fprintf(stderr,"%s: %s\n",argv[i],error_string(status));
+         result = status;
+      }
+   }
+
+   context_destroy(ctx);
+   return(result);
+}
+
+
+/*
+ * Routine:	convert_name
+ *
+ * Description:	The name of the binary file: the text file's name with
+ *		BATCH_EXTENSION replaced by SURFB_EXTENSION, or with
+ *		SURFB_EXTENSION added.
+ *
+ * Parameters:	filename	< the text file
+ *
+ * Returns:	the name (to be freed), or NULL if no memory
+ *
+ * Example:	convert_name("data/m1g2.txt");
+ *		return("data/m1g2.surfb");
+ *
+ * Date:	17/10/26
+ */
+static char *convert_name(const char *filename)
+{
+   char *name;
+   size_t len,ext_len;
+
+   len = strlen(filename);
+   ext_len = strlen(BATCH_EXTENSION);
+   if (len > ext_len && strcmp(filename+len-ext_len,BATCH_EXTENSION) == 0)
+      len -= ext_len;
+
+   name = (char *) malloc(len + strlen(SURFB_EXTENSION) + 1);
+   if (name == NULL)
+      return(NULL);
+   (void) memcpy(name,filename,len);
+   (void) strcpy(name+len,SURFB_EXTENSION);
+
+   return(name);
+}
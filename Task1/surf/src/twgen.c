@@ -0,0 +1,95 @@
+/******************************************************************
+ * Module:	twgen.c
+ *
+ * Purpose:	Write fftconst.h, the twiddle factors compiled into
+ *		the transforms of the Talysurf filters' lengths (see
+ *		FFT_FIXED in fft.h), so that plans of those lengths
+ *		need not calculate them. Run by the Makefile before
+ *		fft.c is compiled.
+ *
+ * Contents:	main()		- write the header
+ *		twgen_table()	- write one table
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include "global.h"
+#include "fft.h"
+
+/*
+ * the stage tables run to the stage of FFT_CONST_MAX points, and
+ * the split step of FFT_CONST_MAX points (see fft_plan_run_real())
+ * takes FFT_CONST_MAX/2+1 factors more
+ */
+#define TWGEN_LENGTH (FFT_CONST_MAX + FFT_CONST_MAX/2 + 1)
+
+static void twgen_table(const char *name, int sine);
+
+
+/*
+ * Routine:	main
+ *
+ * Description:	Write fftconst.h to the standard output.
+ *
+ *		twgen > include/fftconst.h
+ *
+ * Parameters:	none
+ *
+ * Returns:	TRUE
+ *
+ * Date:	17/10/26
+ */
+int main()
+{
+   (void) printf("/*\n");
+   (void) printf(" * fftconst.h: made by twgen, do not edit.\n");
+   (void) printf(" *\n");
+   (void) printf(" * Element half+i holds the twiddle factor of point i of the\n");
+   (void) printf(" * stage combining transforms of \"half\" points, exp(-pi*j*i/half),\n");
+   (void) printf(" * as the stage tables of fft_plan_create(). The factors of the\n");
+   (void) printf(" * split step of n points are the same, from element n.\n");
+   (void) printf(" */\n");
+   (void) printf("#define FFT_CONST_LENGTH %d\n\n",TWGEN_LENGTH);
+   twgen_table("fft_const_re",FALSE);
+   (void) printf("\n");
+   twgen_table("fft_const_im",TRUE);
+
+   return(TRUE);
+}
+
+
+/*
+ * Routine:	twgen_table
+ *
+ * Description:	Write the real parts, or the imaginary parts, of the
+ *		twiddle factors as a table of doubles. Each is
+ *		evaluated by the expression fft_plan_create() uses and
+ *		written with enough digits to be read back exactly.
+ *
+ * Parameters:	name	< the name of the table
+ *		sine	< TRUE for the imaginary parts
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+static void twgen_table(const char *name, int sine)
+{
+   double value;
+   int half,i,k;
+
+   (void) printf("static const double %s[FFT_CONST_LENGTH] = {\n",name);
+   (void) printf("   0.0");
+   k = 1;
+   for(half=1;half<=FFT_CONST_MAX;half*=2) {
+      for(i=0;i<half && half+i<TWGEN_LENGTH;i++) {
+         value = sine == TRUE ? -sin(TWO_PI*i/(2*half))
+            : cos(TWO_PI*i/(2*half));
+         (void) printf(k % 3 == 0 ? ",\n   %.17g" : ", %.17g",value);
+         k++;
+      }
+   }
+   (void) printf("\n};\n");
+}
@@ -0,0 +1,302 @@
+/******************************************************************
+ * Module:	welch.c
+ *
+ * Purpose:	Power spectrum averaged over overlapping, windowed
+ *		segments of the profile (Welch's method).
+ *
+ * Contents:	welch_spectrum()	- the averaged spectrum
+ *		welch_table_get()	- window table of a length
+ *		welch_table_free()	- release a window table
+ *		welch_window_name()	- window kind from its name
+ *		welch_segment()	- periodogram of one segment
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/*
+ * global definitions
+ */
+#include "global.h"
+#include "context.h"
+
+/*
+ * declarations
+ */
+#include "fft.h"
+#include "pool.h"
+#include "welch.h"
+
+/*
+ * Structure:	welch_job
+ *
+ * Description:	What every segment of a profile shares.
+ */
+struct welch_job {
+   struct surf_context *ctx;
+   const struct fft_plan *plan;  /* half the segment length */
+   int step;  /* samples from one segment to the next */
+};
+
+static void welch_segment(void *shared, int worker, int task);
+
+
+/*
+ * Routine:	welch_spectrum
+ *
+ * Description:	Calculate the spectral data as the average of the
+ *		periodograms of segments of "welch_length" samples
+ *		(rounded down to an integral power of 2, and to no more
+ *		than the number of data) that overlap by
+ *		"welch_overlap" samples (half a segment if negative),
+ *		each multiplied by the window "welch_window". The
+ *		segments are transformed by the context's pool of
+ *		workers, if it has one. The values are scaled like
+ *		those of a single periodogram, so that on average they
+ *		have the same sum.
+ *
+ * Parameters:	ctx	<> the analysis context
+ *
+ * Returns:	TRUE	- successful calculation
+ *		FALSE	- no memory for the window, plan or segments
+ *
+ * Example:	ctx->welch_length = 512;
+ *		ctx->welch_overlap = 256;
+ *		welch_spectrum(ctx);
+ *
+ * Date:	17/10/26
+ */
+int welch_spectrum(struct surf_context *ctx)
+{
+   struct welch_job job;
+   double *work;
+   double scale;
+   int length,half,overlap,num_segments,size;
+   int i,k;
+
+   /*
+    * the segment length, an integral power of 2 so that every
+    * segment is transformed by the radix-2 butterflies, which share
+    * the plan safely between workers
+    */
+   length = WELCH_MIN_LENGTH;
+   while (2*length <= ctx->welch_length && 2*length <= ctx->num_data)
+      length = 2*length;
+   half = length/2;
+
+   overlap = ctx->welch_overlap;
+   if (overlap < 0)
+      overlap = half;
+   if (overlap > length-1)
+      overlap = length-1;
+   job.step = length - overlap;
+   num_segments = (ctx->num_data - length)/job.step + 1;
+
+   /*
+    * the window, the plan and room for the periodogram of each
+    * segment
+    */
+   if (welch_table_get(&ctx->window,ctx->welch_window,length) != TRUE) {
+      ctx->error_number = ER_MEM;
+      return(FALSE);
+   }
+   job.plan = fft_plan_get(&ctx->plans,half);
+   if (job.plan == NULL) {
+      ctx->error_number = ER_MEM;
+      return(FALSE);
+   }
+   size = 2*(half+1)*num_segments;
+   if (size > ctx->welch_max_size) {
+      work = (double *) realloc(ctx->welch_work,size*sizeof(double));
+      if (work == NULL) {
+         ctx->error_number = ER_MEM;
+         return(FALSE);
+      }
+      ctx->welch_work = work;
+      ctx->welch_max_size = size;
+   }
+   job.ctx = ctx;
+
+   /*
+    * a periodogram of each segment
+    */
+   if (ctx->pool != NULL)
+      pool_run(ctx->pool,num_segments,welch_segment,&job);
+   else {
+      for(i=0;i<num_segments;i++)
+         welch_segment(&job,0,i);
+   }
+
+   /*
+    * Average them, always in the same order so that the result does
+    * not depend on the number of workers. Each periodogram sums to
+    * "length" times the sum of the squares of the windowed segment,
+    * which is on average sum_sq/length of the sum over the
+    * unwindowed segment; num_data/length segments make up the whole
+    * profile.
+    */
+   ctx->trans_num_data = length;
+   ctx->spec_num_data = half+1;
+   for(k=0;k<=half;k++)
+      ctx->spec_data[k] = 0.0;
+   for(i=0;i<num_segments;i++) {
+      work = ctx->welch_work + 2*(half+1)*i;
+      for(k=0;k<=half;k++)
+         ctx->spec_data[k] += work[k];
+   }
+
+   scale = (double) ctx->num_data
+      /((double) num_segments*length*ctx->window.sum_sq);
+   ctx->spec_data[0] = scale*ctx->spec_data[0];
+   for(k=1;k<half;k++)
+      ctx->spec_data[k] = 2*scale*ctx->spec_data[k];
+   ctx->spec_data[half] = scale*ctx->spec_data[half];
+
+   return(TRUE);
+}
+
+
+/*
+ * Routine:	welch_table_get
+ *
+ * Description:	Make sure that a table holds the window "kind" of
+ *		"length" values, calculating it only if it does not
+ *		already.
+ *
+ * Parameters:	table	<> the table
+ *		kind	< WELCH_HANN, WELCH_HAMMING or WELCH_BLACKMAN
+ *		length	< number of values
+ *
+ * Returns:	TRUE	- the table is ready
+ *		ER_MEM	- no memory for the values
+ *
+ * Date:	17/10/26
+ */
+int welch_table_get(struct welch_table *table, int kind, int length)
+{
+   double *w;
+   double phase;
+   int i;
+
+   if (table->length == length && table->kind == kind)
+      return(TRUE);
+
+   w = (double *) realloc(table->w,length*sizeof(double));
+   if (w == NULL)
+      return(ER_MEM);
+   table->w = w;
+
+   /*
+    * the periodic forms, which repeat every "length" samples as the
+    * transform assumes
+    */
+   table->sum_sq = 0.0;
+   for(i=0;i<length;i++) {
+      phase = TWO_PI*i/length;
+      if (kind == WELCH_HAMMING)
+         w[i] = 0.54 - 0.46*cos(phase);
+      else if (kind == WELCH_BLACKMAN)
+         w[i] = 0.42 - 0.5*cos(phase) + 0.08*cos(2*phase);
+      else
+         w[i] = 0.5 - 0.5*cos(phase);
+      table->sum_sq += w[i]*w[i];
+   }
+   table->kind = kind;
+   table->length = length;
+
+   return(TRUE);
+}
+
+
+/*
+ * Routine:	welch_table_free
+ *
+ * Description:	Release the values of a table.
+ *
+ * Parameters:	table	<> the table
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+void welch_table_free(struct welch_table *table)
+{
+   free(table->w);
+   table->w = NULL;
+   table->length = 0;
+}
+
+
+/*
+ * Routine:	welch_window_name
+ *
+ * Description:	The window kind named "hann", "hamming" or "blackman".
+ *
+ * Parameters:	name	< the name
+ *
+ * Returns:	the kind, or FALSE if the name is not known
+ *
+ * Example:	welch_window_name("blackman");
+ *		return(WELCH_BLACKMAN);
+ *
+ * Date:	17/10/26
+ */
+int welch_window_name(const char *name)
+{
+   if (strcmp(name,"hann") == 0)
+      return(WELCH_HANN);
+   if (strcmp(name,"hamming") == 0)
+      return(WELCH_HAMMING);
+   if (strcmp(name,"blackman") == 0)
+      return(WELCH_BLACKMAN);
+   return(FALSE);
+}
+
+
+/*
+ * Routine:	welch_segment
+ *
+ * Description:	Window and transform one segment, leaving its
+ *		periodogram (the squared magnitudes of its first
+ *		half+1 coefficients) at the start of its part of
+ *		"welch_work". Each segment has its own part, so any
+ *		worker may take any segment.
+ *
+ * Parameters:	shared	< the welch_job
+ *		worker	< not used
+ *		task	< the segment
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+static void welch_segment(void *shared, int worker, int task)
+{
+   struct welch_job *job;
+   const double *x,*w;
+   double *re,*im;
+   int half,k;
+
+   (void) worker;
+   job = (struct welch_job *) shared;
+   half = job->plan->n;
+   re = job->ctx->welch_work + 2*(half+1)*task;
+   im = re + half+1;
+   x = job->ctx->data + job->step*task;
+   w = job->ctx->window.w;
+
+   /*
+    * the windowed samples, two to a complex value
+    */
+   for(k=0;k<half;k++) {
+      re[k] = w[2*k]*x[2*k];
+      im[k] = w[2*k+1]*x[2*k+1];
+   }
+   fft_plan_run_real(job->plan,re,im);
+
+   for(k=0;k<=half;k++)
+      re[k] = re[k]*re[k] + im[k]*im[k];
+}
@@ -0,0 +1,674 @@
+/******************************************************************
+ * Module:	writer.c
+ *
+ * Purpose:	Writing the results of many profiles: comma-separated
+ *		rows, JSON Lines, or a binary file of the spectra.
+ *
+ * Contents:	writer_open()	- start writing results
+ *		writer_row()	- write the record of a profile
+ *		writer_sync()	- write out what is buffered
+ *		writer_close()	- finish writing results
+ *		writer_format_name()	- format from its name
+ *		writer_double()	- shortest exact text of a double
+ *		writer_reserve()	- room in the buffer
+ *		writer_flush()	- write out the buffer
+ *		writer_text()	- a comma-separated or JSON record
+ *		writer_binary()	- a binary record
+ *		put_int()	- text of an int
+ *		put_name()	- text of a file name
+ *		put_u32()	- little-endian 32-bit integer
+ *		put_f64()	- little-endian double
+ *
+ * Date:	17/10/26
+ *****************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+/*
+ * global definitions
+ */
+#include "global.h"
+#include "context.h"
+
+/*
+ * declarations
+ */
+#include "writer.h"
+
+/*
+ * The parameters in the order of the comma-separated columns and
+ * JSON members, which is not that of surf_params.
+ */
+#define WRITER_NUM_COLUMNS 13
+
+/*
+ * Structure:	writer
+ *
+ * Description:	The file, its format and the buffer the records are
+ *		formatted into.
+ */
+struct writer {
+   FILE *f;
+   int format;
+   int bands;  /* TRUE to write the bands */
+   int status;  /* TRUE, or ER_FIL once a write has failed */
+   char *buf;
+   size_t size;  /* of buf */
+   size_t used;  /* bytes waiting to be written */
+};
+
+static const char *column_name[WRITER_NUM_COLUMNS] = {
+   "rp", "rv", "rt", "gamma0", "gamma1", "c_lambda", "ra", "rq", "rsk",
+   "rku", "rz", "rsm", "rdq"
+};
+
+static int writer_reserve(struct writer *w, size_t size);
+static int writer_flush(struct writer *w);
+static void writer_text(struct writer *w, const struct writer_row *row);
+static void writer_binary(struct writer *w, const struct writer_row *row);
+static char *put_int(char *dest, int value);
+static char *put_name(char *dest, const char *name, int json);
+static unsigned char *put_u32(unsigned char *dest, uint32_t value);
+static unsigned char *put_f64(unsigned char *dest, double value);
+
+
+/*
+ * Routine:	writer_open
+ *
+ * Description:	Start writing results to a file, writing the column
+ *		names of a comma-separated file or the header of a
+ *		binary one.
+ *
+ * Parameters:	f	< the file, open for writing
+ *		format	< WRITER_CSV, WRITER_JSONL or WRITER_BINARY
+ *		bands	< TRUE to write SMOOTH_MAX_DATA bands per row
+ *
+ * Returns:	the writer, or NULL if memory is not available
+ *
+ * Example:	w = writer_open(stdout,WRITER_CSV,FALSE);
+ *
+ * Date:	17/10/26
+ */
+struct writer *writer_open(FILE *f, int format, int bands)
+{
+   struct writer *w;
+   unsigned char *p;
+   char *q;
+   int i;
+
+   w = (struct writer *) calloc(1,sizeof(struct writer));
+   if (w == NULL)
+      return(NULL);
+   w->buf = (char *) malloc(WRITER_BUFFER);
+   if (w->buf == NULL) {
+      free(w);
+      return(NULL);
+   }
+   w->f = f;
+   w->format = format;
+   w->bands = bands;
+   w->status = TRUE;
+   w->size = WRITER_BUFFER;
+   w->used = 0;
+
+   if (format == WRITER_CSV) {
+      q = w->buf;
+      q += sprintf(q,"file,mag_set,filter_set,num_data,trans_num_data");
+      for(i=0;i<WRITER_NUM_COLUMNS;i++)
+         q += sprintf(q,",%s",column_name[i]);
+      if (bands == TRUE) {
+         for(i=0;i<SMOOTH_MAX_DATA;i++)
+            q += sprintf(q,",band%d",i+1);
+      }
+      *q++ = '\n';
+      w->used = q - w->buf;
+   }
+   else if (format == WRITER_BINARY) {
+      p = (unsigned char *) w->buf;
+      memcpy(p,WRITER_MAGIC,8);
+      p = put_u32(p+8,WRITER_VERSION);
+      p = put_u32(p,WRITER_RECORD_SIZE);
+      p = put_u32(p,0);
+      p = put_u32(p,0);
+      w->used = WRITER_HEADER_SIZE;
+   }
+
+   return(w);
+}
+
+
+/*
+ * Routine:	writer_row
+ *
+ * Description:	Add the record of one profile, first writing out the
+ *		buffer if the record would not fit in it.
+ *
+ * Parameters:	w	<> the writer
+ *		row	< the record
+ *
+ * Returns:	TRUE	- added
+ *		ER_FIL	- the file could not be written
+ *		ER_MEM	- no memory for the record
+ *
+ * Date:	17/10/26
+ */
+int writer_row(struct writer *w, const struct writer_row *row)
+{
+   size_t size;
+   int result;
+
+   /*
+    * the most the record can take: a name escaped for JSON takes up
+    * to six characters a byte, and one quoted for CSV two
+    */
+   if (w->format == WRITER_BINARY)
+      size = WRITER_RECORD_SIZE + strlen(row->filename) + 8
+         + 8*((size_t) row->spec_num_data + row->smooth_num_data);
+   else
+      size = 6*strlen(row->filename) + 256
+         + (WRITER_NUM_COLUMNS + SMOOTH_MAX_DATA)
+         *(WRITER_DOUBLE_LEN + 16);
+   result = writer_reserve(w,size);
+   if (result != TRUE)
+      return(result);
+
+   if (w->format == WRITER_BINARY)
+      writer_binary(w,row);
+   else
+      writer_text(w,row);
+
+   return(w->status);
+}
+
+
+/*
+ * Routine:	writer_sync
+ *
+ * Description:	Write out the buffer and flush the file.
+ *
+ * Parameters:	w	<> the writer
+ *
+ * Returns:	TRUE	- everything so far was written
+ *		ER_FIL	- some of it could not be
+ *
+ * Date:	17/10/26
+ */
+int writer_sync(struct writer *w)
+{
+   if (writer_flush(w) != TRUE)
+      return(ER_FIL);
+   if (fflush(w->f) != 0) {
+      w->status = ER_FIL;
+      return(ER_FIL);
+   }
+   return(TRUE);
+}
+
+
+/*
+ * Routine:	writer_close
+ *
+ * Description:	Write out what is left in the buffer and release the
+ *		writer; the file stays open.
+ *
+ * Parameters:	w	< the writer, or NULL
+ *
+ * Returns:	TRUE	- everything was written
+ *		ER_FIL	- some of it could not be
+ *
+ * Date:	17/10/26
+ */
+int writer_close(struct writer *w)
+{
+   int result;
+
+   if (w == NULL)
+      return(TRUE);
+   result = writer_flush(w);
+   if (fflush(w->f) != 0)
+      result = ER_FIL;
+   free(w->buf);
+   free(w);
+   return(result);
+}
+
+
+/*
+ * Routine:	writer_format_name
+ *
+ * Description:	The format named "csv", "jsonl" or "binary".
+ *
+ * Parameters:	name	< the name
+ *
+ * Returns:	the format, or FALSE if the name is not known
+ *
+ * Example:	writer_format_name("jsonl");
+ *		return(WRITER_JSONL);
+ *
+ * Date:	17/10/26
+ */
+int writer_format_name(const char *name)
+{
+   if (strcmp(name,"csv") == 0)
+      return(WRITER_CSV);
+   if (strcmp(name,"jsonl") == 0)
+      return(WRITER_JSONL);
+   if (strcmp(name,"binary") == 0)
+      return(WRITER_BINARY);
+   return(FALSE);
+}
+
+
+/*
+ * Routine:	writer_double
+ *
+ * Description:	The text of a double with the fewest significant
+ *		digits (15 to 17) that strtod() reads back as the same
+ *		double. Fifteen digits read back exactly for any
+ *		double that has a decimal form that short, and
+ *		seventeen for every double, so at most three tries
+ *		are made.
+ *
+ * Parameters:	dest	> at least WRITER_DOUBLE_LEN characters
+ *		x	< the double
+ *
+ * Returns:	the number of characters written, without the NUL
+ *
+ * Example:	writer_double(dest,0.1);
+ *		dest = "0.1"
+ *
+ * Date:	17/10/26
+ */
+int writer_double(char *dest, double x)
+{
+   int digits,len;
+
+   if (isnan(x)) {
+      (void) strcpy(dest,"nan");
+      return(3);
+   }
+   if (isinf(x)) {
+      (void) strcpy(dest,x > 0.0 ? "inf" : "-inf");
+      return(x > 0.0 ? 3 : 4);
+   }
+   if (fabs(x) < 1.0e9 && x == (int) x) {
+      len = (int) (put_int(dest,(int) x) - dest);
+      dest[len] = '\0';
+      return(len);
+   }
+
+   len = 0;
+   for(digits=15;digits<=17;digits++) {
+      len = sprintf(dest,"%.*g",digits,x);
+      if (strtod(dest,NULL) == x)
+         break;
+   }
+   return(len);
+}
+
+
+/*
+ * Routine:	writer_reserve
+ *
+ * Description:	Make room for "size" more bytes in the buffer,
+ *		writing it out if need be and growing it if one record
+ *		needs more than it holds.
+ *
+ * Parameters:	w	<> the writer
+ *		size	< bytes needed
+ *
+ * Returns:	TRUE	- there is room
+ *		ER_FIL	- the buffer could not be written
+ *		ER_MEM	- no memory to grow it
+ *
+ * Date:	17/10/26
+ */
+static int writer_reserve(struct writer *w, size_t size)
+{
+   char *buf;
+
+   if (w->used + size <= w->size)
+      return(TRUE);
+   if (writer_flush(w) != TRUE)
+      return(ER_FIL);
+   if (size > w->size) {
+      buf = (char *) realloc(w->buf,size);
+      if (buf == NULL)
+         return(ER_MEM);
+      w->buf = buf;
+      w->size = size;
+   }
+   return(TRUE);
+}
+
+
+/*
+ * Routine:	writer_flush
+ *
+ * Description:	Write out the buffer with one fwrite().
+ *
+ * Parameters:	w	<> the writer
+ *
+ * Returns:	TRUE	- written, or a write had already failed
+ *		ER_FIL	- it could not be
+ *
+ * Date:	17/10/26
+ */
+static int writer_flush(struct writer *w)
+{
+   if (w->used > 0 && w->status == TRUE) {
+      if (fwrite(w->buf,1,w->used,w->f) != w->used)
+         w->status = ER_FIL;
+   }
+   w->used = 0;
+   return(w->status);
+}
+
+
+/*
+ * Routine:	writer_text
+ *
+ * Description:	Format a comma-separated row or a JSON object of one
+ *		profile into the buffer, which has room for it. A
+ *		number that is not finite is an empty cell or null.
+ *
+ * Parameters:	w	<> the writer
+ *		row	< the record
+ *
+ * Returns:	nothing
+ *
+ * Example:	{"file":"data/m1g2.txt","mag_set":3,...,"rdq":0.55,
+ *		 "bands":[...]}
+ *
+ * Date:	17/10/26
+ */
+static void writer_text(struct writer *w, const struct writer_row *row)
+{
+   static const char *int_name[4] = {
+      "mag_set", "filter_set", "num_data", "trans_num_data"
+   };
+   double column[WRITER_NUM_COLUMNS];
+   int value[4];
+   char *q;
+   int json;
+   int i;
+
+   json = w->format == WRITER_JSONL ? TRUE : FALSE;
+   value[0] = row->mag_set;
+   value[1] = row->filter_set;
+   value[2] = row->num_data;
+   value[3] = row->trans_num_data;
+   column[0] = row->params->rp;
+   column[1] = row->params->rv;
+   column[2] = row->params->rt;
+   column[3] = row->params->gamma0;
+   column[4] = row->params->gamma1;
+   column[5] = row->params->c_lambda;
+   column[6] = row->params->ra;
+   column[7] = row->params->rq;
+   column[8] = row->params->rsk;
+   column[9] = row->params->rku;
+   column[10] = row->params->rz;
+   column[11] = row->params->rsm;
+   column[12] = row->params->rdq;
+
+   q = w->buf + w->used;
+   if (json == TRUE) {
+      memcpy(q,"{\"file\":",8);
+      q += 8;
+   }
+   q = put_name(q,row->filename,json);
+
+   for(i=0;i<4;i++) {
+      *q++ = ',';
+      if (json == TRUE)
+         q += sprintf(q,"\"%s\":",int_name[i]);
+      q = put_int(q,value[i]);
+   }
+
+   for(i=0;i<WRITER_NUM_COLUMNS;i++) {
+      *q++ = ',';
+      if (json == TRUE)
+         q += sprintf(q,"\"%s\":",column_name[i]);
+      if (isfinite(column[i]))
+         q += writer_double(q,column[i]);
+      else if (json == TRUE) {
+         memcpy(q,"null",4);
+         q += 4;
+      }
+   }
+
+   if (w->bands == TRUE) {
+      if (json == TRUE) {
+         memcpy(q,",\"bands\":[",10);
+         q += 10;
+         for(i=0;i<row->smooth_num_data;i++) {
+            if (i > 0)
+               *q++ = ',';
+            if (isfinite(row->smooth[i].data))
+               q += writer_double(q,row->smooth[i].data);
+            else {
+               memcpy(q,"null",4);
+               q += 4;
+            }
+         }
+         *q++ = ']';
+      }
+      else {
+         for(i=0;i<SMOOTH_MAX_DATA;i++) {
+            *q++ = ',';
+            if (i < row->smooth_num_data
+               && isfinite(row->smooth[i].data))
+               q += writer_double(q,row->smooth[i].data);
+         }
+      }
+   }
+
+   if (json == TRUE)
+      *q++ = '}';
+   *q++ = '\n';
+   w->used = q - w->buf;
+}
+
+
+/*
+ * Routine:	writer_binary
+ *
+ * Description:	Format the binary record of one profile into the
+ *		buffer, which has room for it (see writer.h).
+ *
+ * Parameters:	w	<> the writer
+ *		row	< the record
+ *
+ * Returns:	nothing
+ *
+ * Date:	17/10/26
+ */
+static void writer_binary(struct writer *w, const struct writer_row *row)
+{
+   const struct surf_params *params;
+   unsigned char *p;
+   size_t name_size,record_size,len;
+   int i;
+
+   len = strlen(row->filename);
+   name_size = (len + 8) & ~(size_t) 7;
+   record_size = WRITER_RECORD_SIZE + name_size
+      + 8*((size_t) row->spec_num_data + row->smooth_num_data);
+   params = row->params;
+
+   p = (unsigned char *) w->buf + w->used;
+   p = put_u32(p,(uint32_t) record_size);
+   p = put_u32(p,(uint32_t) name_size);
+   p = put_u32(p,(uint32_t) row->mag_set);
+   p = put_u32(p,(uint32_t) row->filter_set);
+   p = put_u32(p,(uint32_t) row->num_data);
+   p = put_u32(p,(uint32_t) row->trans_num_data);
+   p = put_u32(p,(uint32_t) row->spec_num_data);
+   p = put_u32(p,(uint32_t) row->smooth_num_data);
+   p = put_f64(p,params->mean);
+   p = put_f64(p,params->var);
+   p = put_f64(p,params->ra);
+   p = put_f64(p,params->rq);
+   p = put_f64(p,params->rsk);
+   p = put_f64(p,params->rku);
+   p = put_f64(p,params->rp);
+   p = put_f64(p,params->rv);
+   p = put_f64(p,params->rt);
+   p = put_f64(p,params->rz);
+   p = put_f64(p,params->rsm);
+   p = put_f64(p,params->rdq);
+   p = put_f64(p,params->gamma0);
+   p = put_f64(p,params->gamma1);
+   p = put_f64(p,params->c_lambda);
+
+   memcpy(p,row->filename,len);
+   memset(p+len,0,name_size-len);
+   p += name_size;
+   for(i=0;i<row->spec_num_data;i++)
+      p = put_f64(p,row->spec_data[i]);
+   for(i=0;i<row->smooth_num_data;i++)
+      p = put_f64(p,row->smooth[i].data);
+
+   w->used = (char *) p - w->buf;
+}
+
+
+/*
+ * Routine:	put_int
+ *
+ * Description:	The decimal text of an int, without a NUL.
+ *
+ * Parameters:	dest	> the text
+ *		value	< the int
+ *
+ * Returns:	the character after the text
+ *
+ * Date:	17/10/26
+ */
+static char *put_int(char *dest, int value)
+{
+   char digits[12];
+   unsigned int u;
+   int n;
+
+   u = value < 0 ? 0u - (unsigned int) value : (unsigned int) value;
+   n = 0;
+   do {
+      digits[n++] = (char) ('0' + u % 10);
+      u /= 10;
+   } while (u != 0);
+   if (value < 0)
+      *dest++ = '-';
+   while (n > 0)
+      *dest++ = digits[--n];
+   return(dest);
+}
+
+
+/*
+ * Routine:	put_name
+ *
+ * Description:	A file name as a comma-separated field or as a JSON
+ *		string. The field is the name as it is, unless the name
+ *		holds a comma, quote or line break, when it is quoted
+ *		and its quotes doubled (RFC 4180). The JSON string has
+ *		its quotes, backslashes and control characters escaped.
+ *
+ * Parameters:	dest	> the text
+ *		name	< the file name
+ *		json	< TRUE for a JSON string
+ *
+ * Returns:	the character after the text
+ *
+ * Date:	17/10/26
+ *
+ * Modified:	17/10/26: names quoted for comma-separated files
+ */
+static char *put_name(char *dest, const char *name, int json)
+{
+   unsigned char c;
+
+   if (json != TRUE) {
+      if (strpbrk(name,",\"\r\n") == NULL) {
+         while (*name != '\0')
+            *dest++ = *name++;
+         return(dest);
+      }
+      *dest++ = '"';
+      for(;*name!='\0';name++) {
+         if (*name == '"')
+            *dest++ = '"';
+         *dest++ = *name;
+      }
+      *dest++ = '"';
+      return(dest);
+   }
+
+   *dest++ = '"';
+   for(;*name!='\0';name++) {
+      c = (unsigned char) *name;
+      if (c == '"' || c == '\\') {
+         *dest++ = '\\';
+         *dest++ = (char) c;
+      }
+      else if (c < 0x20)
+         dest += sprintf(dest,"\\u%04x",c);
+      else
+         *dest++ = (char) c;
+   }
+   *dest++ = '"';
+   return(dest);
+}
+
+
+/*
+ * Routine:	put_u32
+ *
+ * Description:	A 32-bit integer, least significant byte first.
+ *
+ * Parameters:	dest	> four bytes
+ *		value	< the integer
+ *
+ * Returns:	the byte after them
+ *
+ * Date:	17/10/26
+ */
+static unsigned char *put_u32(unsigned char *dest, uint32_t value)
+{
+   dest[0] = (unsigned char) value;
+   dest[1] = (unsigned char) (value >> 8);
+   dest[2] = (unsigned char) (value >> 16);
+   dest[3] = (unsigned char) (value >> 24);
+   return(dest+4);
+}
+
+
+/*
+ * Routine:	put_f64
+ *
+ * Description:	An IEEE double, least significant byte first.
+ *
+ * Parameters:	dest	> eight bytes
+ *		value	< the double
+ *
+ * Returns:	the byte after them
+ *
+ * Date:	17/10/26
+ */
+static unsigned char *put_f64(unsigned char *dest, double value)
+{
+   uint64_t bits;
+   int i;
+
+   memcpy(&bits,&value,8);
+   for(i=0;i<8;i++) {
+      dest[i] = (unsigned char) bits;
+      bits >>= 8;
+   }
+   return(dest+8);
+}